@@ -0,0 +1,186 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "BenchmarkUtility.h"
+#include "SourcetrailDBWriter.h"
+
+// Compares the way file contents used to be read, line by line through a std::istream, with
+// SourcetrailDBWriter::recordFile, which maps the file into memory, normalizes its line endings and stores
+// it. Each recorded file is rolled back, so that the next repetition stores its content again. The time of
+// recordFile includes writing the content to the database, so it is an upper bound for reading it. Files
+// with LF and with CRLF line endings are measured separately, because only the latter need to be copied
+// while normalizing.
+
+namespace
+{
+std::istream& safeGetline(std::istream& is, std::string& t)
+{
+	t.clear();
+	std::istream::sentry se(is, true);
+	std::streambuf* sb = is.rdbuf();
+
+	while (true)
+	{
+		int c = sb->sbumpc();
+		switch (c)
+		{
+		case '\n':
+			return is;
+		case '\r':
+			if (sb->sgetc() == '\n')
+			{
+				sb->sbumpc();
+			}
+			return is;
+		case std::streambuf::traits_type::eof():
+			if (t.empty())
+			{
+				is.setstate(std::ios::eofbit);
+			}
+			return is;
+		default:
+			t += (char)c;
+		}
+	}
+}
+
+// the previous implementation of utility::getFileContent followed by utility::getLineCount
+size_t readLineByLine(const std::string& filePath, int& lineCount)
+{
+	std::vector<std::string> lines;
+	std::ifstream srcFile(filePath, std::ios::binary | std::ios::in);
+	while (!srcFile.eof())
+	{
+		std::string line;
+		safeGetline(srcFile, line);
+		lines.push_back(line + '\n');
+	}
+
+	if (!lines.empty())
+	{
+		std::string last = lines.back().substr(0, lines.back().size() - 1);
+		lines.pop_back();
+		if (!last.empty())
+		{
+			lines.push_back(last);
+		}
+	}
+
+	std::string content;
+	for (const std::string& line: lines)
+	{
+		content += line;
+	}
+
+	lineCount = 0;
+	for (char c: content)
+	{
+		lineCount += c == '\n';
+	}
+	return content.size();
+}
+
+void writeSourceFile(const std::string& filePath, size_t megabytes, const std::string& lineEnding)
+{
+	std::ofstream file(filePath, std::ios::binary);
+	const size_t targetSize = megabytes * 1024 * 1024;
+	size_t size = 0;
+	for (size_t i = 0; size < targetSize; i++)
+	{
+		const std::string line = "\tconst int generated_value_" + std::to_string(i) + " = compute(" + std::to_string(i % 97) + ");" + lineEnding;
+		file << line;
+		size += line.size();
+	}
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	if (argc < 2 || argc > 4)
+	{
+		std::cout << "usage: bench_file_content <file_directory> <optional:megabytes> <optional:repetitions>" << std::endl;
+		return 1;
+	}
+
+	const std::string fileDirectory = argv[1];
+	const size_t megabytes = argc >= 3 ? std::atoi(argv[2]) : 64;
+	const int repetitions = argc >= 4 ? std::atoi(argv[3]) : 5;
+
+	const std::string databasePath = fileDirectory + "/bench_file_content.srctrldb";
+	const std::string projectPath = fileDirectory + "/bench_file_content.srctrlprj";
+	sourcetrail::SourcetrailDBWriter writer;
+	if (!writer.open(databasePath) || !writer.clear())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	std::cout << "Workload: " << megabytes << " MiB per file, " << repetitions << " repetitions" << std::endl;
+	std::cout << std::endl;
+	std::cout << std::left << std::setw(10) << "endings" << std::setw(16) << "path" << std::right << std::setw(12) << "seconds"
+			  << std::setw(12) << "MiB/s" << std::endl;
+
+	const std::vector<std::pair<std::string, std::string>> lineEndings = {{"lf", "\n"}, {"crlf", "\r\n"}};
+	for (const std::pair<std::string, std::string>& lineEnding: lineEndings)
+	{
+		const std::string filePath = fileDirectory + "/bench_file_content_" + lineEnding.first + ".cpp";
+		writeSourceFile(filePath, megabytes, lineEnding.second);
+
+		const std::vector<std::pair<std::string, std::function<bool()>>> paths = {
+			{"line-by-line",
+			 [&]() {
+				 int lineCount = 0;
+				 return readLineByLine(filePath, lineCount) > 0;
+			 }},
+			{"recordFile", [&]() {
+				 return writer.beginTransaction() && writer.recordFile(filePath) != 0 && writer.rollbackTransaction();
+			 }}};
+		for (const std::pair<std::string, std::function<bool()>>& path: paths)
+		{
+			const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+			for (int i = 0; i < repetitions; i++)
+			{
+				if (!path.second())
+				{
+					std::cerr << "error: " << writer.getLastError() << std::endl;
+					return 1;
+				}
+			}
+			const double seconds = secondsSince(start);
+
+			std::cout << std::left << std::setw(10) << lineEnding.first << std::setw(16) << path.first << std::right
+					  << std::setw(12) << std::fixed << std::setprecision(3) << seconds << std::setw(12) << std::setprecision(0)
+					  << megabytes * repetitions / seconds << std::endl;
+		}
+
+		std::remove(filePath.c_str());
+	}
+
+	writer.close();
+	std::remove(databasePath.c_str());
+	std::remove(projectPath.c_str());
+	return 0;
+}
@@ -0,0 +1,276 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+#include "BenchmarkUtility.h"
+#include "DatabaseGenerator.h"
+#include "SourcetrailDBReader.h"
+
+// Runs every query of SourcetrailDBReader on generated databases of increasing size, so that it shows how the
+// queries scale with the size of a project. Queries that take an argument are run with a sample of symbols and
+// files spread over the whole database. For every query the latency distribution, the number of returned rows and
+// the peak resident memory of the process after the query are reported. Generated databases are kept in the
+// database directory and reused by later runs if they have been completed, because the large ones take long to
+// write. The results are printed to stdout as JSON, progress goes to stderr.
+
+namespace
+{
+const size_t SAMPLE_COUNT = 100;
+
+double getPercentile(std::vector<double> values, double percentile)
+{
+	if (values.empty())
+	{
+		return 0.0;
+	}
+	const size_t index = std::min(values.size() - 1, static_cast<size_t>(percentile * values.size()));
+	std::nth_element(values.begin(), values.begin() + index, values.end());
+	return values[index];
+}
+
+// runs a query once per argument, the query returns the number of rows it has found
+template <typename Argument>
+nlohmann::json measureQuery(
+	const std::string& name, const std::vector<Argument>& arguments, const std::function<size_t(const Argument&)>& query)
+{
+	std::cerr << "  " << name << std::endl;
+
+	std::vector<double> milliseconds;
+	size_t rowCount = 0;
+	for (const Argument& argument: arguments)
+	{
+		const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+		rowCount += query(argument);
+		milliseconds.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+	}
+
+	return {
+		{"query", name},
+		{"runs", milliseconds.size()},
+		{"rows", rowCount},
+		{"latency_ms",
+		 {{"p50", getPercentile(milliseconds, 0.5)},
+		  {"p99", getPercentile(milliseconds, 0.99)},
+		  {"max", milliseconds.empty() ? 0.0 : *std::max_element(milliseconds.begin(), milliseconds.end())}}},
+		{"peak_rss_bytes", getPeakResidentBytes()}};
+}
+
+std::string getQualifiedName(const sourcetrail::NameHierarchy& nameHierarchy, size_t elementCount)
+{
+	std::string qualifiedName;
+	const size_t firstElement = nameHierarchy.nameElements.size() - std::min(elementCount, nameHierarchy.nameElements.size());
+	for (size_t i = firstElement; i < nameHierarchy.nameElements.size(); i++)
+	{
+		if (!qualifiedName.empty())
+		{
+			qualifiedName += nameHierarchy.nameDelimiter;
+		}
+		qualifiedName += nameHierarchy.nameElements[i].name;
+	}
+	return qualifiedName;
+}
+
+template <typename T>
+std::vector<T> takeSample(const std::vector<T>& values, size_t sampleCount)
+{
+	std::vector<T> sample;
+	const size_t step = std::max<size_t>(values.size() / sampleCount, 1);
+	for (size_t i = 0; i < values.size() && sample.size() < sampleCount; i += step)
+	{
+		sample.push_back(values[i]);
+	}
+	return sample;
+}
+
+bool benchmarkDatabase(const std::string& databasePath, nlohmann::json& queries)
+{
+	sourcetrail::SourcetrailDBReader reader;
+	if (!reader.open(databasePath))
+	{
+		std::cerr << "error: " << reader.getLastError() << std::endl;
+		return false;
+	}
+
+	typedef sourcetrail::SourcetrailDBReader Reader;
+	const std::vector<int> repetitions = {0, 1, 2};
+
+	queries.push_back(measureQuery<int>("getAllSymbols", repetitions, [&](const int&) { return reader.getAllSymbols().size(); }));
+
+	queries.push_back(measureQuery<int>("getAllSymbolViews", repetitions, [&](const int&) { return reader.getAllSymbolViews().size(); }));
+	queries.push_back(measureQuery<int>("forEachSymbol", repetitions, [&](const int&) {
+		size_t rowCount = 0;
+		reader.forEachSymbol([&rowCount](const Reader::Symbol&) { return ++rowCount > 0; });
+		return rowCount;
+	}));
+	queries.push_back(measureQuery<int>("forEachEdge", repetitions, [&](const int&) {
+		size_t rowCount = 0;
+		reader.forEachEdge([&rowCount](const Reader::Reference&) { return ++rowCount > 0; });
+		return rowCount;
+	}));
+
+	std::vector<Reader::SymbolBrief> symbolBriefs;
+	queries.push_back(measureQuery<int>("getAllSymbolsBrief", repetitions, [&](const int&) {
+		symbolBriefs = reader.getAllSymbolsBrief();
+		return symbolBriefs.size();
+	}));
+
+	// names and ids of a sample of methods are the arguments of the symbol and reference queries
+	std::vector<int> symbolIds;
+	std::vector<sourcetrail::NameHierarchy> symbolNames;
+	for (const Reader::SymbolBrief& symbolBrief: takeSample(symbolBriefs, SAMPLE_COUNT * 4))
+	{
+		const Reader::Symbol symbol = reader.getSymbolById(symbolBrief.id);
+		if (symbol.symbolKind == sourcetrail::SymbolKind::METHOD && symbolIds.size() < SAMPLE_COUNT)
+		{
+			symbolIds.push_back(symbol.id);
+			symbolNames.push_back(symbol.nameHierarchy);
+		}
+	}
+	symbolBriefs.clear();
+	symbolBriefs.shrink_to_fit();
+
+	std::vector<std::string> names;
+	std::vector<std::string> nameSubstrings;
+	std::vector<std::string> namePrefixes;
+	std::vector<std::string> qualifiedNames;
+	std::vector<std::string> qualifiedNameSuffixes;
+	for (const sourcetrail::NameHierarchy& symbolName: symbolNames)
+	{
+		const std::string& name = symbolName.nameElements.back().name;
+		names.push_back(name);
+		nameSubstrings.push_back(name.substr(2, name.size() - 3));
+		namePrefixes.push_back(name.substr(0, name.size() - 1));
+		qualifiedNames.push_back(getQualifiedName(symbolName, symbolName.nameElements.size()));
+		qualifiedNameSuffixes.push_back(getQualifiedName(symbolName, 2));
+	}
+
+	queries.push_back(measureQuery<std::string>("findSymbolsByName(exact)", names, [&](const std::string& name) {
+		return reader.findSymbolsByName(name, true).size();
+	}));
+	queries.push_back(measureQuery<std::string>("findSymbolsByName(substring)", nameSubstrings, [&](const std::string& name) {
+		return reader.findSymbolsByName(name, false).size();
+	}));
+	queries.push_back(measureQuery<std::string>("findSymbolsByNamePrefix", namePrefixes, [&](const std::string& prefix) {
+		return reader.findSymbolsByNamePrefix(prefix, true).size();
+	}));
+	queries.push_back(measureQuery<std::string>("findSymbolsByQualifiedName(exact)", qualifiedNames, [&](const std::string& name) {
+		return reader.findSymbolsByQualifiedName(name, true).size();
+	}));
+	queries.push_back(measureQuery<std::string>("findSymbolsByQualifiedName(suffix)", qualifiedNameSuffixes, [&](const std::string& name) {
+		return reader.findSymbolsByQualifiedName(name, false).size();
+	}));
+	queries.push_back(measureQuery<int>("getReferencesToSymbol", symbolIds, [&](const int& symbolId) {
+		return reader.getReferencesToSymbol(symbolId).size();
+	}));
+	queries.push_back(measureQuery<int>("getReferencesFromSymbol", symbolIds, [&](const int& symbolId) {
+		return reader.getReferencesFromSymbol(symbolId).size();
+	}));
+
+	const std::vector<sourcetrail::EdgeKind> edgeKinds = {
+		sourcetrail::EdgeKind::CALL, sourcetrail::EdgeKind::USAGE, sourcetrail::EdgeKind::INHERITANCE, sourcetrail::EdgeKind::IMPORT};
+	queries.push_back(measureQuery<sourcetrail::EdgeKind>("getReferencesByType", edgeKinds, [&](const sourcetrail::EdgeKind& edgeKind) {
+		return reader.getReferencesByType(edgeKind).size();
+	}));
+
+	std::vector<int> fileIds;
+	for (const Reader::File& file: takeSample(reader.getAllFiles(), SAMPLE_COUNT))
+	{
+		fileIds.push_back(file.id);
+	}
+	queries.push_back(measureQuery<int>("getFileById", fileIds, [&](const int& fileId) {
+		return reader.getFileById(fileId).id != 0 ? 1 : 0;
+	}));
+
+	queries.push_back(measureQuery<int>("getDatabaseStats", repetitions, [&](const int&) {
+		return reader.getDatabaseStats().empty() ? 0 : 1;
+	}));
+
+	if (!reader.getLastError().empty())
+	{
+		std::cerr << "error: " << reader.getLastError() << std::endl;
+		return false;
+	}
+	return reader.close();
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	if (argc < 2)
+	{
+		std::cout << "usage: bench_reader <database_directory> <optional:symbol_counts...>" << std::endl;
+		return 1;
+	}
+
+	const std::string databaseDirectory = argv[1];
+	std::vector<long long> symbolCounts;
+	for (int i = 2; i < argc; i++)
+	{
+		symbolCounts.push_back(std::atoll(argv[i]));
+	}
+	if (symbolCounts.empty())
+	{
+		symbolCounts = {10000, 100000, 1000000};
+	}
+
+	nlohmann::json results = nlohmann::json::array();
+	for (long long symbolCount: symbolCounts)
+	{
+		GeneratorOptions options = DEFAULT_GENERATOR_OPTIONS;
+		options.symbolCount = symbolCount;
+		options.referenceCount = symbolCount * 10;
+		options.fileCount = static_cast<int>(std::max(symbolCount / 100, 1LL));
+
+		const std::string databasePath = databaseDirectory + "/bench_reader_" + std::to_string(symbolCount) + ".srctrldb";
+		// databases of interrupted or differently configured runs are written again
+		const bool generated = !isGeneratedDatabase(databasePath, options);
+		if (generated)
+		{
+			std::cerr << "generating " << databasePath << std::endl;
+			if (!generateDatabase(databasePath, options, std::cerr))
+			{
+				return 1;
+			}
+		}
+
+		std::cerr << "querying " << databasePath << std::endl;
+		nlohmann::json queries = nlohmann::json::array();
+		if (!benchmarkDatabase(databasePath, queries))
+		{
+			return 1;
+		}
+
+		results.push_back(
+			{{"symbols", options.symbolCount},
+			 {"references", options.referenceCount},
+			 {"files", options.fileCount},
+			 {"database_bytes", getFileSize(databasePath)},
+			 {"generated", generated}, // the peak memory includes writing the database
+			 {"queries", queries}});
+	}
+
+	std::cout << nlohmann::json {{"benchmark", "bench_reader"}, {"results", results}}.dump(4) << std::endl;
+	return 0;
+}
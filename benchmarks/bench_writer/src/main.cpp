@@ -0,0 +1,405 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "json.hpp"
+
+#include "BenchmarkUtility.h"
+#include "SourcetrailDBWriter.h"
+#include "StorageOptions.h"
+
+// Measures the ingestion throughput of SourcetrailDBWriter. Every scenario writes a fresh database once per
+// storage profile and transaction mode and reports the record calls per second, the 50th and 99th percentile of
+// the latency of a single record call, the peak resident memory of the process so far and the size of the written
+// database. Records that a scenario needs as input, e.g. the symbols that references point to, are written
+// before the measurement starts. The results are printed to stdout as JSON, progress goes to stderr.
+
+namespace
+{
+const size_t RECORDS_PER_TRANSACTION = 1000;
+const size_t RECORDS_PER_AUTO_COMMIT = 10000;
+
+enum class TransactionMode
+{
+	NONE,		 // every record call is committed on its own
+	TRANSACTION, // beginTransaction() and commitTransaction() around RECORDS_PER_TRANSACTION record calls
+	AUTO_COMMIT	 // enableAutoCommit() with a limit of RECORDS_PER_AUTO_COMMIT record calls
+};
+
+std::string transactionModeToString(TransactionMode mode)
+{
+	switch (mode)
+	{
+	case TransactionMode::NONE:
+		return "none";
+	case TransactionMode::TRANSACTION:
+		return "transaction";
+	case TransactionMode::AUTO_COMMIT:
+		return "auto-commit";
+	}
+	return "";
+}
+
+sourcetrail::NameHierarchy getSymbolName(size_t index, size_t depth)
+{
+	// 16 symbols share their innermost scope, 16 scopes their parent scope and so on
+	sourcetrail::NameHierarchy name = {"::", {}};
+	size_t scopeIndex = index;
+	std::vector<std::string> scopes;
+	for (size_t level = 1; level < depth; level++)
+	{
+		scopeIndex /= 16;
+		scopes.push_back("scope_" + std::to_string(level) + "_" + std::to_string(scopeIndex));
+	}
+	for (std::vector<std::string>::const_reverse_iterator it = scopes.rbegin(); it != scopes.rend(); it++)
+	{
+		name.nameElements.push_back({"", *it, ""});
+	}
+	name.nameElements.push_back({"void", "symbol_" + std::to_string(index), "()"});
+	return name;
+}
+
+// times single record calls and commits in the way the transaction mode demands
+class Measurement
+{
+public:
+	Measurement(sourcetrail::SourcetrailDBWriter& writer, TransactionMode mode): m_writer(writer), m_mode(mode) {}
+
+	void start()
+	{
+		if (m_mode == TransactionMode::AUTO_COMMIT)
+		{
+			m_writer.enableAutoCommit({RECORDS_PER_AUTO_COMMIT, 0, 0});
+		}
+		else if (m_mode == TransactionMode::TRANSACTION)
+		{
+			m_writer.beginTransaction();
+		}
+		m_startTime = std::chrono::steady_clock::now();
+	}
+
+	template <typename RecordFunction>
+	void record(RecordFunction recordFunction)
+	{
+		const std::chrono::steady_clock::time_point callStart = std::chrono::steady_clock::now();
+		recordFunction();
+		m_latencies.push_back(std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - callStart).count());
+
+		if (m_mode == TransactionMode::TRANSACTION && m_latencies.size() % RECORDS_PER_TRANSACTION == 0)
+		{
+			m_writer.commitTransaction();
+			m_writer.beginTransaction();
+		}
+	}
+
+	void stop()
+	{
+		if (m_mode == TransactionMode::AUTO_COMMIT)
+		{
+			m_writer.disableAutoCommit();
+		}
+		else if (m_mode == TransactionMode::TRANSACTION)
+		{
+			m_writer.commitTransaction();
+		}
+		m_seconds = secondsSince(m_startTime);
+	}
+
+	size_t getRecordCount() const
+	{
+		return m_latencies.size();
+	}
+
+	double getSeconds() const
+	{
+		return m_seconds;
+	}
+
+	double getLatencyPercentile(double percentile)
+	{
+		if (m_latencies.empty())
+		{
+			return 0.0;
+		}
+		const size_t index = std::min(m_latencies.size() - 1, static_cast<size_t>(percentile * m_latencies.size()));
+		std::nth_element(m_latencies.begin(), m_latencies.begin() + index, m_latencies.end());
+		return m_latencies[index];
+	}
+
+private:
+	sourcetrail::SourcetrailDBWriter& m_writer;
+	TransactionMode m_mode;
+	std::vector<double> m_latencies;
+	std::chrono::steady_clock::time_point m_startTime;
+	double m_seconds = 0.0;
+};
+
+struct Scenario
+{
+	std::string name;
+	size_t recordCount;
+	// prepares the input of the scenario, called within a transaction before the measurement
+	std::function<void(sourcetrail::SourcetrailDBWriter&, size_t)> setup;
+	std::function<void(sourcetrail::SourcetrailDBWriter&, Measurement&, size_t)> run;
+};
+
+Scenario symbolScenario(size_t depth, size_t recordCount)
+{
+	return {
+		"symbols_depth_" + std::to_string(depth),
+		recordCount,
+		[](sourcetrail::SourcetrailDBWriter&, size_t) {},
+		[depth](sourcetrail::SourcetrailDBWriter& writer, Measurement& measurement, size_t count) {
+			for (size_t i = 0; i < count; i++)
+			{
+				const sourcetrail::NameHierarchy name = getSymbolName(i, depth);
+				measurement.record([&] { writer.recordSymbol(name); });
+			}
+		}};
+}
+
+Scenario fileScenario(const std::string& directory, size_t fileBytes, size_t recordCount)
+{
+	const std::string name = "files_" + std::to_string(fileBytes / 1024) + "kb";
+	const std::string filePrefix = directory + "/bench_writer_" + name + "_";
+	return {
+		name,
+		recordCount,
+		[filePrefix, fileBytes](sourcetrail::SourcetrailDBWriter&, size_t count) {
+			for (size_t i = 0; i < count; i++)
+			{
+				// every file has a distinct content, so that contents are not deduplicated by the storage
+				std::ofstream file(filePrefix + std::to_string(i) + ".cpp", std::ios::binary);
+				const std::string line = "int value_" + std::to_string(i) + " = 0; // padding padding padding padding\n";
+				for (size_t written = 0; written < fileBytes; written += line.size())
+				{
+					file << line;
+				}
+			}
+		},
+		[filePrefix](sourcetrail::SourcetrailDBWriter& writer, Measurement& measurement, size_t count) {
+			for (size_t i = 0; i < count; i++)
+			{
+				const std::string filePath = filePrefix + std::to_string(i) + ".cpp";
+				measurement.record([&] { writer.recordFile(filePath); });
+			}
+			for (size_t i = 0; i < count; i++)
+			{
+				std::remove((filePrefix + std::to_string(i) + ".cpp").c_str());
+			}
+		}};
+}
+
+std::vector<int> recordTargetSymbols(sourcetrail::SourcetrailDBWriter& writer, size_t count)
+{
+	std::vector<int> symbolIds;
+	for (size_t i = 0; i < count; i++)
+	{
+		symbolIds.push_back(writer.recordSymbol(getSymbolName(i, 3)));
+	}
+	return symbolIds;
+}
+
+std::vector<Scenario> getScenarios(const std::string& directory, size_t scale)
+{
+	std::shared_ptr<std::vector<int>> symbolIds = std::make_shared<std::vector<int>>();
+	std::shared_ptr<int> fileId = std::make_shared<int>(0);
+
+	return {
+		symbolScenario(1, scale),
+		symbolScenario(4, scale),
+		symbolScenario(8, scale),
+		{"references",
+		 scale,
+		 [symbolIds](sourcetrail::SourcetrailDBWriter& writer, size_t count) {
+			 *symbolIds = recordTargetSymbols(writer, std::max<size_t>(count / 10, 2));
+		 },
+		 [symbolIds](sourcetrail::SourcetrailDBWriter& writer, Measurement& measurement, size_t count) {
+			 const size_t symbolCount = symbolIds->size();
+			 for (size_t i = 0; i < count; i++)
+			 {
+				 const int contextId = (*symbolIds)[i % symbolCount];
+				 const int referencedId = (*symbolIds)[(i * 7 + 1 + i / symbolCount) % symbolCount];
+				 measurement.record([&] { writer.recordReference(contextId, referencedId, sourcetrail::ReferenceKind::CALL); });
+			 }
+		 }},
+		{"symbol_locations",
+		 scale,
+		 [symbolIds, fileId](sourcetrail::SourcetrailDBWriter& writer, size_t count) {
+			 *fileId = writer.recordFile("/bench/symbol_locations.cpp");
+			 *symbolIds = recordTargetSymbols(writer, std::max<size_t>(count / 10, 1));
+		 },
+		 [symbolIds, fileId](sourcetrail::SourcetrailDBWriter& writer, Measurement& measurement, size_t count) {
+			 for (size_t i = 0; i < count; i++)
+			 {
+				 const int symbolId = (*symbolIds)[i % symbolIds->size()];
+				 const int line = static_cast<int>(i + 1);
+				 measurement.record([&] { writer.recordSymbolLocation(symbolId, {*fileId, line, 5, line, 12}); });
+			 }
+		 }},
+		fileScenario(directory, 1024, std::max<size_t>(scale / 20, 1)),
+		fileScenario(directory, 64 * 1024, std::max<size_t>(scale / 100, 1)),
+		{"mixed",
+		 scale,
+		 [](sourcetrail::SourcetrailDBWriter&, size_t) {},
+		 [](sourcetrail::SourcetrailDBWriter& writer, Measurement& measurement, size_t count) {
+			 // files with a class and methods that call each other, as an indexer would record them
+			 const size_t symbolsPerFile = 50;
+			 for (size_t f = 0; measurement.getRecordCount() < count; f++)
+			 {
+				 const std::string className = "Class_" + std::to_string(f);
+				 int fileId = 0;
+				 measurement.record([&] { fileId = writer.recordFile("/bench/file_" + std::to_string(f) + ".cpp"); });
+				 measurement.record([&] { writer.recordFileLanguage(fileId, "cpp"); });
+
+				 int classId = 0;
+				 measurement.record([&] { classId = writer.recordSymbol({"::", {{"", "bench", ""}, {"", className, ""}}}); });
+				 measurement.record([&] { writer.recordSymbolKind(classId, sourcetrail::SymbolKind::CLASS); });
+				 measurement.record([&] { writer.recordSymbolLocation(classId, {fileId, 1, 7, 1, 12}); });
+
+				 int previousMethodId = 0;
+				 for (size_t s = 0; s < symbolsPerFile && measurement.getRecordCount() < count; s++)
+				 {
+					 const int line = static_cast<int>(s + 2);
+					 int methodId = 0;
+					 measurement.record([&] {
+						 methodId = writer.recordSymbol(
+							 {"::", {{"", "bench", ""}, {"", className, ""}, {"void", "method_" + std::to_string(s), "()"}}});
+					 });
+					 measurement.record([&] { writer.recordSymbolKind(methodId, sourcetrail::SymbolKind::METHOD); });
+					 measurement.record([&] { writer.recordSymbolDefinitionKind(methodId, sourcetrail::DefinitionKind::EXPLICIT); });
+					 measurement.record([&] { writer.recordSymbolLocation(methodId, {fileId, line, 6, line, 14}); });
+					 measurement.record([&] { writer.recordSymbolScopeLocation(methodId, {fileId, line, 1, line, 40}); });
+
+					 if (previousMethodId != 0)
+					 {
+						 int referenceId = 0;
+						 measurement.record([&] {
+							 referenceId = writer.recordReference(methodId, previousMethodId, sourcetrail::ReferenceKind::CALL);
+						 });
+						 measurement.record([&] { writer.recordReferenceLocation(referenceId, {fileId, line, 20, line, 28}); });
+					 }
+					 previousMethodId = methodId;
+				 }
+			 }
+		 }}};
+}
+
+bool runScenario(
+	const Scenario& scenario,
+	const std::string& databasePath,
+	sourcetrail::StorageProfile profile,
+	TransactionMode mode,
+	nlohmann::json& result)
+{
+	removeDatabase(databasePath);
+
+	sourcetrail::SourcetrailDBWriter writer;
+	if (!writer.open(databasePath, sourcetrail::getStorageOptions(profile)) || !writer.clear())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+
+	// committing every call on its own is slow, a smaller number of calls suffices for a stable result
+	const size_t recordCount = mode == TransactionMode::NONE ? std::max<size_t>(scenario.recordCount / 20, 1) : scenario.recordCount;
+
+	writer.beginTransaction();
+	scenario.setup(writer, recordCount);
+	writer.commitTransaction();
+
+	Measurement measurement(writer, mode);
+	measurement.start();
+	scenario.run(writer, measurement, recordCount);
+	measurement.stop();
+
+	if (!writer.getLastError().empty())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+	if (!writer.close())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+
+	result = {
+		{"scenario", scenario.name},
+		{"profile", sourcetrail::storageProfileToString(profile)},
+		{"transaction_mode", transactionModeToString(mode)},
+		{"records", measurement.getRecordCount()},
+		{"seconds", measurement.getSeconds()},
+		{"records_per_second", measurement.getRecordCount() / std::max(measurement.getSeconds(), 1e-9)},
+		{"latency_ns", {{"p50", measurement.getLatencyPercentile(0.5)}, {"p99", measurement.getLatencyPercentile(0.99)}}},
+		{"peak_rss_bytes", getPeakResidentBytes()},
+		{"database_bytes", getFileSize(databasePath) + getFileSize(databasePath + "-wal")}};
+
+	removeDatabase(databasePath);
+	return true;
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	if (argc < 2 || argc > 3)
+	{
+		std::cout << "usage: bench_writer <database_directory> <optional:records_per_scenario>" << std::endl;
+		return 1;
+	}
+
+	const std::string databaseDirectory = argv[1];
+	const size_t scale = argc >= 3 ? static_cast<size_t>(std::atoll(argv[2])) : 20000;
+
+	const std::vector<sourcetrail::StorageProfile> profiles = {sourcetrail::StorageProfile::DEFAULT, sourcetrail::StorageProfile::BULK_INGEST};
+	const std::vector<TransactionMode> modes = {TransactionMode::NONE, TransactionMode::TRANSACTION, TransactionMode::AUTO_COMMIT};
+
+	nlohmann::json results = nlohmann::json::array();
+	for (const Scenario& scenario: getScenarios(databaseDirectory, scale))
+	{
+		for (sourcetrail::StorageProfile profile: profiles)
+		{
+			for (TransactionMode mode: modes)
+			{
+				std::cerr << scenario.name << " " << sourcetrail::storageProfileToString(profile) << " "
+						  << transactionModeToString(mode) << std::endl;
+
+				nlohmann::json result;
+				if (!runScenario(scenario, databaseDirectory + "/bench_writer.srctrldb", profile, mode, result))
+				{
+					return 1;
+				}
+				results.push_back(result);
+			}
+		}
+	}
+
+	std::remove((databaseDirectory + "/bench_writer.srctrlprj").c_str());
+
+	std::cout << nlohmann::json {{"benchmark", "bench_writer"}, {"records_per_scenario", scale}, {"results", results}}.dump(4)
+			  << std::endl;
+	return 0;
+}
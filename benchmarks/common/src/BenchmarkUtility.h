@@ -0,0 +1,36 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_BENCHMARK_UTILITY_H
+#define SOURCETRAIL_BENCHMARK_UTILITY_H
+
+#include <chrono>
+#include <string>
+
+// Helpers shared by the benchmarks and the database generator
+
+double secondsSince(const std::chrono::steady_clock::time_point& start);
+
+// returns 0 if the file does not exist
+long long getFileSize(const std::string& filePath);
+
+// returns the peak resident memory of the process so far, 0 if it cannot be determined
+long long getPeakResidentBytes();
+
+// removes a database file together with its write-ahead log
+void removeDatabase(const std::string& databasePath);
+
+#endif	  // SOURCETRAIL_BENCHMARK_UTILITY_H
@@ -0,0 +1,429 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "DatabaseGenerator.h"
+
+#include "CppSQLite3.h"
+
+#include "BenchmarkUtility.h"
+#include "SourcetrailDBWriter.h"
+#include "StorageOptions.h"
+#include "StorageStatistics.h"
+
+namespace
+{
+const int SYMBOLS_PER_CLASS = 64;
+const size_t REFERENCES_PER_TRANSACTION = 1 << 16;
+
+struct WeightedReferenceKind
+{
+	sourcetrail::ReferenceKind kind;
+	double weight;
+};
+
+const std::vector<WeightedReferenceKind> REFERENCE_KINDS = {
+	{sourcetrail::ReferenceKind::CALL, 35},
+	{sourcetrail::ReferenceKind::USAGE, 20},
+	{sourcetrail::ReferenceKind::TYPE_USAGE, 20},
+	{sourcetrail::ReferenceKind::TYPE_ARGUMENT, 8},
+	{sourcetrail::ReferenceKind::INHERITANCE, 4},
+	{sourcetrail::ReferenceKind::OVERRIDE, 4},
+	{sourcetrail::ReferenceKind::TEMPLATE_SPECIALIZATION, 3},
+	{sourcetrail::ReferenceKind::MACRO_USAGE, 3},
+	{sourcetrail::ReferenceKind::ANNOTATION_USAGE, 2},
+	{sourcetrail::ReferenceKind::IMPORT, 1}};
+
+class SplitMix64
+{
+public:
+	explicit SplitMix64(uint64_t seed): m_state(seed) {}
+
+	uint64_t next()
+	{
+		uint64_t z = (m_state += 0x9E3779B97F4A7C15ULL);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+		return z ^ (z >> 31);
+	}
+
+	// uniform in [0, 1)
+	double nextDouble()
+	{
+		return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	// uniform in [0, bound)
+	long long nextIndex(long long bound)
+	{
+		return static_cast<long long>(next() % static_cast<uint64_t>(bound));
+	}
+
+private:
+	uint64_t m_state;
+};
+
+// meta value that marks a database as completely generated
+const char* GENERATOR_OPTIONS_META_KEY = "generator_options";
+
+std::string generatorOptionsToString(const GeneratorOptions& options)
+{
+	return "seed=" + std::to_string(options.seed) + " symbols=" + std::to_string(options.symbolCount) +
+		" references=" + std::to_string(options.referenceCount) + " namespace-depth=" +
+		std::to_string(options.namespaceDepth) + " files=" + std::to_string(options.fileCount) +
+		" locations-per-symbol=" + std::to_string(options.locationsPerSymbol) +
+		" test-ratio=" + std::to_string(options.testRatio) + " exponent=" + std::to_string(options.exponent);
+}
+
+long long greatestCommonDivisor(long long a, long long b)
+{
+	while (b != 0)
+	{
+		const long long t = a % b;
+		a = b;
+		b = t;
+	}
+	return a;
+}
+
+// draws the popularity rank of a reference target, rank 0 being the most popular one
+long long drawPowerLawRank(SplitMix64& random, long long rankCount, double exponent)
+{
+	// inverse transform sampling of the continuous power-law on [1, rankCount + 1)
+	const double u = random.nextDouble();
+	double x = 0.0;
+	if (std::fabs(exponent - 1.0) < 1e-9)
+	{
+		x = std::pow(static_cast<double>(rankCount + 1), u);
+	}
+	else
+	{
+		const double oneMinusExponent = 1.0 - exponent;
+		x = std::pow(1.0 + u * (std::pow(static_cast<double>(rankCount + 1), oneMinusExponent) - 1.0), 1.0 / oneMinusExponent);
+	}
+	const long long rank = static_cast<long long>(x) - 1;
+	return rank < 0 ? 0 : (rank >= rankCount ? rankCount - 1 : rank);
+}
+
+sourcetrail::ReferenceKind drawReferenceKind(SplitMix64& random, size_t& kindIndex)
+{
+	static const double totalWeight = [] {
+		double weight = 0.0;
+		for (const WeightedReferenceKind& referenceKind: REFERENCE_KINDS)
+		{
+			weight += referenceKind.weight;
+		}
+		return weight;
+	}();
+
+	double value = random.nextDouble() * totalWeight;
+	for (kindIndex = 0; kindIndex + 1 < REFERENCE_KINDS.size(); kindIndex++)
+	{
+		value -= REFERENCE_KINDS[kindIndex].weight;
+		if (value < 0.0)
+		{
+			break;
+		}
+	}
+	return REFERENCE_KINDS[kindIndex].kind;
+}
+
+class NameGenerator
+{
+public:
+	NameGenerator(long long classCount, int namespaceDepth, double testRatio, uint64_t seed)
+		: m_namespaceDepth(namespaceDepth), m_namespaceFanOut(2)
+	{
+		if (namespaceDepth > 0)
+		{
+			m_namespaceFanOut = std::max(2LL, static_cast<long long>(std::ceil(std::pow(static_cast<double>(classCount), 1.0 / namespaceDepth))));
+		}
+
+		SplitMix64 random(seed ^ 0x5F3759DFULL);
+		m_isTestClass.reserve(static_cast<size_t>(classCount));
+		for (long long c = 0; c < classCount; c++)
+		{
+			m_isTestClass.push_back(random.nextDouble() < testRatio);
+		}
+	}
+
+	// the namespaces and the class that contain the methods of the class, outermost first
+	sourcetrail::NameHierarchy getClassName(long long classIndex) const
+	{
+		sourcetrail::NameHierarchy name;
+		name.nameDelimiter = "::";
+		if (m_isTestClass[static_cast<size_t>(classIndex)])
+		{
+			name.nameElements.push_back({"", "tests", ""});
+		}
+
+		long long divisor = 1;
+		for (int level = 1; level < m_namespaceDepth; level++)
+		{
+			divisor *= m_namespaceFanOut;
+		}
+		for (int level = 0; level < m_namespaceDepth; level++)
+		{
+			name.nameElements.push_back({"", "ns_" + std::to_string(level) + "_" + std::to_string((classIndex / divisor) % m_namespaceFanOut), ""});
+			divisor /= m_namespaceFanOut;
+		}
+
+		name.nameElements.push_back({"", "Class_" + std::to_string(classIndex), ""});
+		return name;
+	}
+
+private:
+	int m_namespaceDepth;
+	long long m_namespaceFanOut;
+	std::vector<bool> m_isTestClass;
+};
+
+bool checkWriter(const sourcetrail::SourcetrailDBWriter& writer, std::ostream& log)
+{
+	if (!writer.getLastError().empty())
+	{
+		log << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool recordSymbols(
+	sourcetrail::SourcetrailDBWriter& writer, const GeneratorOptions& options, std::vector<int>& symbolIds, std::ostream& log)
+{
+	const long long classCount = (options.symbolCount + SYMBOLS_PER_CLASS - 1) / SYMBOLS_PER_CLASS;
+	const NameGenerator nameGenerator(classCount, options.namespaceDepth, options.testRatio, options.seed);
+	const long long symbolsPerFile = (options.symbolCount + options.fileCount - 1) / options.fileCount;
+
+	symbolIds.reserve(static_cast<size_t>(options.symbolCount));
+
+	sourcetrail::NameHierarchy className;
+	std::vector<sourcetrail::NameHierarchy> methodNames;
+	std::vector<sourcetrail::SourcetrailDBWriter::LocationRecord> locations;
+
+	for (int f = 0; f < options.fileCount; f++)
+	{
+		const long long firstSymbol = f * symbolsPerFile;
+		const long long endSymbol = std::min(firstSymbol + symbolsPerFile, options.symbolCount);
+		if (firstSymbol >= endSymbol)
+		{
+			break;
+		}
+
+		writer.beginTransaction();
+
+		const int fileId = writer.recordFile("/generated/file_" + std::to_string(f) + ".cpp");
+		writer.recordFileLanguage(fileId, "cpp");
+
+		methodNames.clear();
+		locations.clear();
+		int line = 1;
+		for (long long s = firstSymbol; s < endSymbol; s++)
+		{
+			const long long classIndex = s / SYMBOLS_PER_CLASS;
+			if (s == firstSymbol || s % SYMBOLS_PER_CLASS == 0)
+			{
+				className = nameGenerator.getClassName(classIndex);
+
+				// the enclosing namespaces are recorded once per class, the writer knows them already after the first one
+				sourcetrail::NameHierarchy namespaceName = {"::", {}};
+				for (size_t i = 0; i + 1 < className.nameElements.size(); i++)
+				{
+					namespaceName.nameElements.push_back(className.nameElements[i]);
+					writer.recordSymbolKind(writer.recordSymbol(namespaceName), sourcetrail::SymbolKind::NAMESPACE);
+				}
+
+				const int classId = writer.recordSymbol(className);
+				writer.recordSymbolKind(classId, sourcetrail::SymbolKind::CLASS);
+				writer.recordSymbolDefinitionKind(classId, sourcetrail::DefinitionKind::EXPLICIT);
+				writer.recordSymbolLocation(classId, {fileId, line, 7, line, 12});
+				line++;
+			}
+
+			sourcetrail::NameHierarchy methodName = className;
+			methodName.nameElements.push_back({"void", "method_" + std::to_string(s), "()"});
+			methodNames.push_back(std::move(methodName));
+
+			for (int l = 0; l < options.locationsPerSymbol; l++)
+			{
+				const sourcetrail::LocationKind kind = l == 1 ? sourcetrail::LocationKind::SCOPE : sourcetrail::LocationKind::TOKEN;
+				locations.push_back({0, {fileId, line, 6, kind == sourcetrail::LocationKind::SCOPE ? line + 2 : line, 14}, kind});
+				line++;
+			}
+		}
+
+		const std::vector<int> methodIds = writer.recordSymbols(methodNames);
+		for (size_t i = 0; i < methodIds.size(); i++)
+		{
+			writer.recordSymbolKind(methodIds[i], sourcetrail::SymbolKind::METHOD);
+			writer.recordSymbolDefinitionKind(methodIds[i], sourcetrail::DefinitionKind::EXPLICIT);
+			for (int l = 0; l < options.locationsPerSymbol; l++)
+			{
+				locations[i * options.locationsPerSymbol + l].elementId = methodIds[i];
+			}
+		}
+		symbolIds.insert(symbolIds.end(), methodIds.begin(), methodIds.end());
+		writer.recordLocations(locations);
+
+		writer.commitTransaction();
+		if (!checkWriter(writer, log))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+bool recordReferences(
+	sourcetrail::SourcetrailDBWriter& writer, const GeneratorOptions& options, const std::vector<int>& symbolIds, std::ostream& log)
+{
+	const long long symbolCount = static_cast<long long>(symbolIds.size());
+	if (symbolCount < 2)
+	{
+		return true;
+	}
+
+	// maps popularity ranks to symbols, spreading the popular symbols of each reference kind over the whole project
+	long long stride = symbolCount / 2 + 1;
+	while (greatestCommonDivisor(stride, symbolCount) != 1)
+	{
+		stride++;
+	}
+
+	SplitMix64 random(options.seed);
+	std::vector<sourcetrail::SourcetrailDBWriter::ReferenceRecord> references;
+	references.reserve(static_cast<size_t>(std::min<long long>(options.referenceCount, REFERENCES_PER_TRANSACTION)));
+
+	for (long long r = 0; r < options.referenceCount; r++)
+	{
+		size_t kindIndex = 0;
+		const sourcetrail::ReferenceKind kind = drawReferenceKind(random, kindIndex);
+		const long long source = random.nextIndex(symbolCount);
+		const long long rank = drawPowerLawRank(random, symbolCount, options.exponent);
+		long long target = static_cast<long long>((static_cast<unsigned long long>(rank) * stride + kindIndex * 7919) % symbolCount);
+		if (target == source)
+		{
+			target = (target + 1) % symbolCount;
+		}
+		references.push_back({symbolIds[static_cast<size_t>(source)], symbolIds[static_cast<size_t>(target)], kind});
+
+		if (references.size() == REFERENCES_PER_TRANSACTION || r + 1 == options.referenceCount)
+		{
+			writer.beginTransaction();
+			writer.recordReferences(references);
+			writer.commitTransaction();
+			references.clear();
+			if (!checkWriter(writer, log))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+}	 // namespace
+
+bool generateDatabase(const std::string& databasePath, const GeneratorOptions& options, std::ostream& log)
+{
+	removeDatabase(databasePath);
+
+	sourcetrail::SourcetrailDBWriter writer;
+	if (!writer.open(databasePath, sourcetrail::getStorageOptions(sourcetrail::StorageProfile::BULK_INGEST)) || !writer.clear())
+	{
+		log << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+	writer.enableStatistics();
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+	std::vector<int> symbolIds;
+	if (!recordSymbols(writer, options, symbolIds, log))
+	{
+		return false;
+	}
+	log << "recorded " << symbolIds.size() << " symbols in " << secondsSince(start) << " s" << std::endl;
+
+	if (!recordReferences(writer, options, symbolIds, log))
+	{
+		return false;
+	}
+	log << "recorded " << options.referenceCount << " references in " << secondsSince(start) << " s" << std::endl;
+
+	// references with equal source, target and kind are merged into one edge
+	const sourcetrail::StorageStatistics statistics = writer.getStatistics();
+	log << "database contains " << statistics.nodes.rows << " nodes, " << statistics.edges.rows << " edges and "
+		<< statistics.sourceLocations.rows << " source locations" << std::endl;
+
+	if (!writer.close())
+	{
+		log << "error: " << writer.getLastError() << std::endl;
+		return false;
+	}
+
+	try
+	{
+		CppSQLite3DB database;
+		database.open(databasePath.c_str());
+		CppSQLite3Statement statement =
+			database.compileStatement("INSERT INTO meta(id, key, value) VALUES(NULL, ?, ?);");
+		statement.bind(1, GENERATOR_OPTIONS_META_KEY);
+		statement.bind(2, generatorOptionsToString(options).c_str());
+		statement.execDML();
+		statement.finalize();
+		database.close();
+	}
+	catch (CppSQLite3Exception e)
+	{
+		log << "error: " << e.errorMessage() << std::endl;
+		return false;
+	}
+	return true;
+}
+
+bool isGeneratedDatabase(const std::string& databasePath, const GeneratorOptions& options)
+{
+	if (getFileSize(databasePath) == 0)
+	{
+		return false;
+	}
+
+	try
+	{
+		CppSQLite3DB database;
+		database.open(databasePath.c_str());
+		CppSQLite3Statement statement = database.compileStatement("SELECT value FROM meta WHERE key = ?;");
+		statement.bind(1, GENERATOR_OPTIONS_META_KEY);
+		CppSQLite3Query query = statement.execQuery();
+		const bool generated = !query.eof() && query.getStringField(0, "") == generatorOptionsToString(options);
+		query.finalize();
+		statement.finalize();
+		database.close();
+		return generated;
+	}
+	catch (CppSQLite3Exception e)
+	{
+		return false;
+	}
+}
@@ -0,0 +1,52 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_DATABASE_GENERATOR_H
+#define SOURCETRAIL_DATABASE_GENERATOR_H
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+
+// Generates a synthetic Sourcetrail database of configurable size and shape as input for benchmarks and
+// regression tests. Symbols are methods grouped into classes that live in nested namespaces, a part of the classes
+// is placed in a "tests" namespace. References point to targets drawn from a power-law distribution, so that few
+// symbols are referenced very often, like in real code bases. Each reference kind has its own set of popular
+// targets. The output only depends on the options: all random numbers come from a seeded SplitMix64 generator and
+// are converted without the implementation defined distributions of <random>.
+
+struct GeneratorOptions
+{
+	uint64_t seed;
+	long long symbolCount;
+	long long referenceCount;
+	int namespaceDepth;
+	int fileCount;
+	int locationsPerSymbol;
+	double testRatio;
+	double exponent; // exponent of the power-law that the reference targets are drawn from
+};
+
+const GeneratorOptions DEFAULT_GENERATOR_OPTIONS = {1, 100000, 1000000, 3, 1000, 2, 0.1, 1.5};
+
+// writes a new database to databasePath, progress and errors are written to log. The options are stored in the
+// meta table once the database is complete.
+bool generateDatabase(const std::string& databasePath, const GeneratorOptions& options, std::ostream& log);
+
+// returns whether generateDatabase() has completed writing databasePath with the same options
+bool isGeneratedDatabase(const std::string& databasePath, const GeneratorOptions& options);
+
+#endif	  // SOURCETRAIL_DATABASE_GENERATOR_H
@@ -0,0 +1,115 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+#include "DatabaseGenerator.h"
+
+// Command line interface of the database generator, see DatabaseGenerator.h
+
+namespace
+{
+bool parseOption(const std::string& argument, const std::string& name, std::string& value)
+{
+	const std::string prefix = "--" + name + "=";
+	if (argument.compare(0, prefix.size(), prefix) != 0)
+	{
+		return false;
+	}
+	value = argument.substr(prefix.size());
+	return true;
+}
+
+void printUsage()
+{
+	std::cout << "usage: generate_database <database_path> [options]" << std::endl
+			  << "  --seed=<n>                    seed of the random numbers (default 1)" << std::endl
+			  << "  --symbols=<n>                 number of method symbols (default 100000)" << std::endl
+			  << "  --references=<n>              number of recorded references (default 1000000)" << std::endl
+			  << "  --namespace-depth=<n>         namespaces around each class (default 3)" << std::endl
+			  << "  --files=<n>                   number of files the symbols are spread over (default 1000)" << std::endl
+			  << "  --locations-per-symbol=<n>    source locations of each method (default 2)" << std::endl
+			  << "  --test-ratio=<x>              share of classes in the tests namespace (default 0.1)" << std::endl
+			  << "  --exponent=<x>                power-law exponent of the reference targets (default 1.5)" << std::endl;
+}
+}	 // namespace
+
+int main(int argc, const char* argv[])
+{
+	if (argc < 2)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const std::string databasePath = argv[1];
+	GeneratorOptions options = DEFAULT_GENERATOR_OPTIONS;
+	for (int i = 2; i < argc; i++)
+	{
+		const std::string argument = argv[i];
+		std::string value;
+		if (parseOption(argument, "seed", value))
+		{
+			options.seed = std::strtoull(value.c_str(), nullptr, 10);
+		}
+		else if (parseOption(argument, "symbols", value))
+		{
+			options.symbolCount = std::atoll(value.c_str());
+		}
+		else if (parseOption(argument, "references", value))
+		{
+			options.referenceCount = std::atoll(value.c_str());
+		}
+		else if (parseOption(argument, "namespace-depth", value))
+		{
+			options.namespaceDepth = std::atoi(value.c_str());
+		}
+		else if (parseOption(argument, "files", value))
+		{
+			options.fileCount = std::atoi(value.c_str());
+		}
+		else if (parseOption(argument, "locations-per-symbol", value))
+		{
+			options.locationsPerSymbol = std::atoi(value.c_str());
+		}
+		else if (parseOption(argument, "test-ratio", value))
+		{
+			options.testRatio = std::atof(value.c_str());
+		}
+		else if (parseOption(argument, "exponent", value))
+		{
+			options.exponent = std::atof(value.c_str());
+		}
+		else
+		{
+			std::cerr << "error: unknown option " << argument << std::endl;
+			printUsage();
+			return 1;
+		}
+	}
+
+	if (options.symbolCount < 1 || options.referenceCount < 0 || options.namespaceDepth < 0 || options.fileCount < 1 ||
+		options.locationsPerSymbol < 0 || options.exponent <= 0.0)
+	{
+		std::cerr << "error: invalid option value" << std::endl;
+		printUsage();
+		return 1;
+	}
+
+	return generateDatabase(databasePath, options, std::cout) ? 0 : 1;
+}
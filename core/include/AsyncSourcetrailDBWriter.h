@@ -0,0 +1,156 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_ASYNC_SRCTRLDB_WRITER_H
+#define SOURCETRAIL_ASYNC_SRCTRLDB_WRITER_H
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "BoundedMpscQueue.h"
+#include "SourcetrailDBWriter.h"
+
+namespace sourcetrail
+{
+/**
+ * AsyncSourcetrailDBWriter
+ *
+ * This class allows many threads to record data to a Sourcetrail database at the same time. Record
+ * calls only put the request into a bounded lock-free queue and return immediately. A background
+ * thread takes the requests out of the queue and writes them with a SourcetrailDBWriter, grouping
+ * them into transactions of up to recordsPerTransaction requests. When the queue is full, record
+ * calls wait until the background thread has made room.
+ *
+ * Record calls that provide an id return a std::future for it. The futures hold 0 if the request
+ * failed. Record calls that only report success do not return anything, their errors are provided
+ * by getLastError() once flush() or close() returned. Requests of one thread are written in the
+ * order they have been made.
+ *
+ * The following code snippet illustrates a basic usage of the AsyncSourcetrailDBWriter class:
+ *
+ *   sourcetrail::AsyncSourcetrailDBWriter writer;
+ *   writer.open("MyProject.srctrldb");
+ *   std::future<int> symbolId = writer.recordSymbol({ "::", { { "void", "foo", "()" } } });
+ *   writer.recordSymbolKind(symbolId.get(), sourcetrail::SymbolKind::FUNCTION);
+ *   writer.close();
+ *
+ *  note: open() and close() must not be called concurrently with any other method.
+ */
+class AsyncSourcetrailDBWriter
+{
+public:
+	explicit AsyncSourcetrailDBWriter(size_t queueCapacity = 1 << 16, size_t recordsPerTransaction = 10000);
+	~AsyncSourcetrailDBWriter();
+
+	/**
+	 * Opens a Sourcetrail database and starts the background thread
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: SourcetrailDBWriter::open(const std::string& databaseFilePath, const StorageOptions& storageOptions)
+	 */
+	bool open(const std::string& databaseFilePath);
+	bool open(const std::string& databaseFilePath, const StorageOptions& storageOptions);
+
+	/**
+	 * Writes all queued requests, stops the background thread and closes the database
+	 *
+	 *  return: true if no error occurred since the error has last been cleared. false otherwise.
+	 *    getLastError() provides the error message.
+	 */
+	bool close();
+
+	/**
+	 * Waits until all requests queued before this call have been written and committed
+	 *
+	 *  return: true if no error occurred since the error has last been cleared. false otherwise.
+	 *    getLastError() provides the error message.
+	 */
+	bool flush();
+
+	/**
+	 * Provides the error message of the first request that failed since the error has last been cleared
+	 *
+	 *  note: Errors are detected by the background thread, so call flush() before checking.
+	 */
+	std::string getLastError() const;
+
+	/**
+	 * Clears the stored error message
+	 */
+	void clearLastError();
+
+	// Record methods, see SourcetrailDBWriter for the documentation of each of them.
+
+	std::future<int> recordSymbol(const NameHierarchy& nameHierarchy);
+	void recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind);
+	void recordSymbolKind(int symbolId, SymbolKind symbolKind);
+	void recordSymbolLocation(int symbolId, const SourceRange& location);
+	void recordSymbolScopeLocation(int symbolId, const SourceRange& location);
+	void recordSymbolSignatureLocation(int symbolId, const SourceRange& location);
+	std::future<int> recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind);
+	void recordReferenceLocation(int referenceId, const SourceRange& location);
+	void recordReferenceIsAmbiguous(int referenceId);
+	std::future<int> recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location);
+	void recordQualifierLocation(int referencedSymbolId, const SourceRange& location);
+	std::future<int> recordFile(const std::string& filePath);
+	void recordFileLanguage(int fileId, const std::string& languageIdentifier);
+	std::future<int> recordLocalSymbol(const std::string& name);
+	void recordLocalSymbolLocation(int localSymbolId, const SourceRange& location);
+	void recordAtomicSourceRange(const SourceRange& sourceRange);
+	void recordError(const std::string& message, bool fatal, const SourceRange& location);
+	void recordTestMapping(int symbolId, int testSymbolId);
+
+private:
+	typedef std::function<void()> Request;
+
+	bool enqueue(Request& request);
+	std::future<int> enqueueWithId(std::function<int(SourcetrailDBWriter&)> record);
+	void enqueueWithoutId(std::function<bool(SourcetrailDBWriter&)> record);
+
+	void runConsumer();
+	void execute(Request& request);
+	void commitPendingTransaction();
+	void takeWriterError();
+	void setLastError(const std::string& error);
+
+	BoundedMpscQueue<Request> m_queue;
+	const size_t m_recordsPerTransaction;
+
+	SourcetrailDBWriter m_writer;
+	std::thread m_consumerThread;
+	std::atomic<bool> m_stopRequested;
+
+	// the background thread sleeps on this condition while the queue is empty
+	std::mutex m_idleMutex;
+	std::condition_variable m_idleCondition;
+	std::atomic<bool> m_consumerIdle;
+
+	// only accessed by the background thread while it is running
+	bool m_transactionOpen;
+	size_t m_recordsInTransaction;
+
+	mutable std::mutex m_errorMutex;
+	std::string m_lastError;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_ASYNC_SRCTRLDB_WRITER_H
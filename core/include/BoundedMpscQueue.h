@@ -0,0 +1,144 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_BOUNDED_MPSC_QUEUE_H
+#define SOURCETRAIL_BOUNDED_MPSC_QUEUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace sourcetrail
+{
+/**
+ * Lock-free queue of fixed capacity for many producer threads and a single consumer thread.
+ *
+ * Each slot carries a sequence number that tells producers and the consumer whose turn it is, so
+ * producers only contend on one atomic position counter and the consumer does not need any atomic
+ * read-modify-write operation at all. tryPush() fails instead of blocking when the queue is full,
+ * which leaves the backpressure policy to the caller.
+ */
+template <typename T>
+class BoundedMpscQueue
+{
+public:
+	// the capacity is rounded up to the next power of two
+	explicit BoundedMpscQueue(size_t capacity);
+
+	BoundedMpscQueue(const BoundedMpscQueue&) = delete;
+	BoundedMpscQueue& operator=(const BoundedMpscQueue&) = delete;
+
+	size_t getCapacity() const;
+
+	// may be called from any thread. value is only moved from if true is returned.
+	bool tryPush(T& value);
+
+	// may only be called from the consumer thread
+	bool tryPop(T& value);
+
+private:
+	struct Slot
+	{
+		std::atomic<size_t> sequence;
+		T value;
+	};
+
+	static size_t roundUpToPowerOfTwo(size_t value);
+
+	const size_t m_mask;
+	std::unique_ptr<Slot[]> m_slots;
+
+	// kept on separate cache lines, since producers and consumer update them concurrently
+	alignas(64) std::atomic<size_t> m_pushPosition;
+	alignas(64) size_t m_popPosition;
+};
+
+template <typename T>
+BoundedMpscQueue<T>::BoundedMpscQueue(size_t capacity)
+	: m_mask(roundUpToPowerOfTwo(capacity) - 1), m_slots(new Slot[m_mask + 1]), m_pushPosition(0), m_popPosition(0)
+{
+	for (size_t i = 0; i <= m_mask; i++)
+	{
+		m_slots[i].sequence.store(i, std::memory_order_relaxed);
+	}
+}
+
+template <typename T>
+size_t BoundedMpscQueue<T>::getCapacity() const
+{
+	return m_mask + 1;
+}
+
+template <typename T>
+bool BoundedMpscQueue<T>::tryPush(T& value)
+{
+	size_t position = m_pushPosition.load(std::memory_order_relaxed);
+	for (;;)
+	{
+		Slot& slot = m_slots[position & m_mask];
+		const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+
+		if (sequence == position)
+		{
+			// the slot is free, try to claim it
+			if (m_pushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+			{
+				slot.value = std::move(value);
+				slot.sequence.store(position + 1, std::memory_order_release);
+				return true;
+			}
+		}
+		else if (sequence < position)
+		{
+			// the slot still holds a value from the previous round, so the queue is full
+			return false;
+		}
+		else
+		{
+			position = m_pushPosition.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+template <typename T>
+bool BoundedMpscQueue<T>::tryPop(T& value)
+{
+	Slot& slot = m_slots[m_popPosition & m_mask];
+	if (slot.sequence.load(std::memory_order_acquire) != m_popPosition + 1)
+	{
+		return false;
+	}
+
+	value = std::move(slot.value);
+	slot.value = T();
+	slot.sequence.store(m_popPosition + m_mask + 1, std::memory_order_release);
+	m_popPosition++;
+	return true;
+}
+
+template <typename T>
+size_t BoundedMpscQueue<T>::roundUpToPowerOfTwo(size_t value)
+{
+	size_t result = 1;
+	while (result < value)
+	{
+		result <<= 1;
+	}
+	return result;
+}
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_BOUNDED_MPSC_QUEUE_H
@@ -17,8 +17,12 @@
 #ifndef SOURCETRAIL_DATABASE_STORAGE_H
 #define SOURCETRAIL_DATABASE_STORAGE_H
 
+#include <cstdint>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include "CppSQLite3.h"
@@ -30,7 +34,9 @@
 #include "StorageLocalSymbol.h"
 #include "StorageNode.h"
 #include "StorageOccurrence.h"
+#include "StorageOptions.h"
 #include "StorageSourceLocation.h"
+#include "StorageStatistics.h"
 #include "StorageSymbol.h"
 
 namespace sourcetrail
@@ -47,6 +53,7 @@ class DatabaseStorage
 public:
 	static int getSupportedDatabaseVersion();
 	static std::unique_ptr<DatabaseStorage> openDatabase(const std::string& dbFilePath);
+	static std::unique_ptr<DatabaseStorage> openDatabase(const std::string& dbFilePath, const StorageOptions& storageOptions);
 	~DatabaseStorage();
 
 	void setupDatabase();
@@ -57,20 +64,86 @@ public:
 	bool isEmpty() const;
 	bool isCompatible() const;
 	int getLoadedDatabaseVersion() const;
+	std::string getLoadedStorageProfile() const; // profile the database has last been set up with
+	bool isInTransaction() const;
 	void beginTransaction();
 	void commitTransaction();
 	void rollbackTransaction();
+	void beginSavepoint(const std::string& name);
+	void releaseSavepoint(const std::string& name);
+	void rollbackToSavepoint(const std::string& name);
 	void optimizeDatabaseMemory();
+	// The journal mode WAL is stored in the database file, so every later connection would need to create side files
+	// and the file could not be opened from read-only media. Switches a database that these storage options have put
+	// into WAL mode back to a rollback journal. Needs to be called outside of a transaction.
+	void restoreJournalMode();
+
+	// Bulk loading defers foreign key enforcement and all indices that the deduplicating add methods do not need.
+	// Both calls need to happen outside of a transaction. endBulkLoad() builds the deferred indices, checks the
+	// foreign keys of all rows written in the meantime and updates the query planner statistics.
+	void beginBulkLoad();
+	void endBulkLoad();
+	bool isBulkLoading() const;
+
+	// Copies all data of another Sourcetrail database into this one, reusing existing elements and source locations
+	// with the same key and assigning new ids to all others. The merge runs in SQL, using temporary id mapping tables
+	// instead of memory. Needs to be called outside of a transaction.
+	void mergeDatabase(const std::string& dbFilePath, int unknownNodeKind);
+
+	// Copies a database file into this storage with SQLite's online backup API, e.g. to stage it in memory. Needs to be
+	// called before the database has been set up.
+	void loadDatabase(const std::string& dbFilePath);
+	// Copies this storage to a database file, replacing its content. progress is called after every copied block of
+	// pages with the number of copied and total pages. Needs to be called outside of a transaction.
+	void saveDatabase(const std::string& dbFilePath, const std::function<void(int, int)>& progress);
+	int getChangeCount() const; // rows inserted, updated or deleted since the storage has been opened
+
+	// Counters and timings of the add methods, collected only while enabled. The writer adds its own timings.
+	void setStatisticsEnabled(bool enabled);
+	bool isStatisticsEnabled() const;
+	StorageStatistics& getStatistics();
+	void resetStatistics();
+
+	// While enabled, addFile() and mergeDatabase() store a content that equals the content of a file stored before
+	// only as a reference to that file in the filecontent_ref table, instead of another filecontent row. Sourcetrail
+	// itself does not resolve these references, getFileContent() does. Not stored in the database.
+	void setFileContentDeduplicationEnabled(bool enabled);
+	bool isFileContentDeduplicationEnabled() const;
+
+	// Records that an element has been recorded for a file, so that it can be removed together with the file's data.
+	void addElementFile(int elementId, int fileId);
+
+	// Removes the source locations of a file and all elements that were only recorded for that file. Nodes are kept
+	// while other elements still refer to them. The file node itself is kept if keepFileNode is set or if edges of
+	// other files refer to it, only its file row (keepFileNode) or its content (otherwise) is removed.
+	// Cannot be used during a bulk load, because it relies on the cascading foreign keys.
+	// returns false without changing anything if fileId does not refer to a row of the file table
+	bool removeFile(int fileId, int memberEdgeKind, bool keepFileNode);
 
 	int addElementComponent(const StorageElementComponentData& storageElementComponentData);
 	int addNode(const StorageNodeData& storageNodeData);
+	int addNode(int nodeKind, const std::string& serializedName);
+	// Looks up the id cache of the deduplicating add methods only, without statistics or a query. Returns 0 unless the
+	// node has been added or found by this instance since the last rollback.
+	int findCachedNodeId(const std::string& serializedName) const;
 	void addSymbol(const StorageSymbol& storageSymbol);
-	void addFile(const StorageFile& storageFile);
+	size_t addFile(const StorageFile& storageFile); // returns the number of newly stored file content bytes
+	// Whether the file is recorded with its current content. Size and modification time are compared first, the
+	// content hash only if the modification time changed while the size did not or if it is too recent to be reliable.
+	bool isFileUpToDate(const std::string& filePath);
 	int addEdge(const StorageEdgeData& storageEdgeData);
 	int addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData);
+	int addLocalSymbol(const std::string& name);
 	int addSourceLocation(const StorageSourceLocationData& storageSourceLocationData);
 	void addOccurrence(const StorageOccurrence& storageOccurrence);
 	int addError(const StorageErrorData& storageErrorData);
+	int addError(const std::string& message, const std::string& translationUnit, bool fatal, bool indexed);
+
+	// Batch variants of the add methods above. New rows are written with multi-row INSERT statements.
+	std::vector<int> addNodes(const std::vector<StorageNodeData>& storageNodeData);
+	std::vector<int> addEdges(const std::vector<StorageEdgeData>& storageEdgeData);
+	std::vector<int> addSourceLocations(const std::vector<StorageSourceLocationData>& storageSourceLocationData);
+	void addOccurrences(const std::vector<StorageOccurrence>& storageOccurrences);
 
 	// Tests mapping table (symbol -> test symbol)
 	int addTestMapping(int symbolId, int testSymbolId);
@@ -82,15 +155,40 @@ public:
 	std::vector<StorageNode> getNodesBySerializedNameExact(const std::string& serializedName) const;
 	std::vector<StorageNode> getNodesBySerializedNameLike(const std::string& pattern) const; // SQL LIKE pattern
 	StorageNode getNodeById(int nodeId) const; // id==0 if not found
+	std::string getFileContent(int fileId) const; // resolves filecontent_ref, "" if the file has no content
 	int getDefinitionKindForSymbol(int symbolId) const; // -1 if not a symbol
 	std::vector<StorageEdge> getEdgesFromNode(int sourceNodeId) const;
 	std::vector<StorageEdge> getEdgesToNode(int targetNodeId) const;
 	std::vector<StorageEdge> getEdgesByType(int edgeKind) const;
 	std::vector<StorageEdge> getEdgesFromNodeOfKinds(int sourceNodeId, const std::vector<int>& kinds) const;
 
-	// Symbol specific helpers
-	std::vector<StorageNode> getAllSymbolNodes() const; // nodes that have an entry in symbol table
-	std::vector<StorageNode> findSymbolNodesBySerializedNameLike(const std::string& pattern) const; // pattern: SQL LIKE
+	// Symbol specific helpers, each one runs a single prepared query that joins node and symbol table
+	std::vector<StorageSymbolNode> getAllSymbolNodes() const; // nodes that have an entry in symbol table
+	std::vector<StorageSymbolNode> getSymbolNodesBySerializedNameExact(const std::string& serializedName) const;
+	std::vector<StorageSymbolNode> findSymbolNodesBySerializedNameLike(const std::string& pattern) const; // pattern: SQL LIKE
+	StorageSymbolNode getSymbolNodeById(int nodeId) const; // id==0 if not found, definitionKind==-1 if not a symbol
+
+	// Lookups by the last element of the name via the node_name table, they find symbols with an index seek instead
+	// of a scan of all serialized names. Only use them if hasNodeNames() returns true, because databases written by
+	// earlier versions lack the table or some of its rows. hasNodeNames() compares the largest node id with the one
+	// that this version has stored in the meta table after making sure that every node has its row.
+	bool hasNodeNames() const;
+	std::vector<StorageSymbolNode> getSymbolNodesByName(const std::string& name) const;
+	std::vector<StorageSymbolNode> getSymbolNodesByNameAndParentName(const std::string& name, const std::string& parentName) const;
+	std::vector<StorageSymbolNode> findSymbolNodesByNamePrefix(const std::string& prefix, bool ignoreCase) const;
+	std::vector<StorageSymbolNode> findSymbolNodesByNameSubstring(const std::string& substring) const;
+
+	// Streaming variants of the helpers above. Rows with an id greater than afterId are passed to the visitor in the
+	// order of their ids until the visitor returns false or limit rows have been visited (0 for no limit). Every call
+	// compiles a statement of its own, so the visitor may run other queries on this storage.
+	void forEachSymbolNode(
+		const std::function<bool(const StorageSymbolNode&)>& visitor,
+		bool withSerializedNames,
+		int afterId = 0,
+		size_t limit = 0) const;
+	void forEachEdge(const std::function<bool(const StorageEdge&)>& visitor, int afterId = 0, size_t limit = 0) const;
+	void forEachEdgeOfType(
+		int edgeKind, const std::function<bool(const StorageEdge&)>& visitor, int afterId = 0, size_t limit = 0) const;
 
 	template <typename ResultType>
 	std::vector<ResultType> getAll() const
@@ -101,15 +199,54 @@ public:
 private:
 	DatabaseStorage() = default;
 
+	void applyStorageOptions(const StorageOptions& storageOptions);
+
 	void setupTables();
 	void clearTables();
 	void setupIndices();
+	void setupFileRemovalIndices();
 	void setupPrecompiledStatements();
 	void clearPrecompiledStatements();
 
+	void removeFileElements(int fileId, int memberEdgeKind);
+
+	// returns the number of newly stored content bytes, 0 if the content is stored as a reference to an equal one
+	size_t addFileContent(int fileId, const std::string& hash, const char* content, size_t contentSize);
+	// hands the content of a file over to one of the files that refer to it, before the file's content is removed
+	void moveReferencedFileContent(int fileId);
+
+	StorageNodeName getNodeName(int nodeId, const std::string& serializedName);
+	void addNodeNames(const std::vector<StorageNode>& nodes);
+	void addMissingNodeNames();
+	void updateNodeNamesMarker(); // stores that all nodes up to the largest node id have their node_name rows
+
+	int findNodeId(const std::string& serializedName, bool recordStatistics = true);
+	int findEdgeId(const StorageEdgeData& storageEdgeData);
+	int findSourceLocationId(const StorageSourceLocationData& storageSourceLocationData);
+
 	int insertElement();
+	void reserveElementIds();
+	void releaseElementIds();
+
+	template <typename RowType, typename BindRowFunction, typename RowsInsertedFunction>
+	void insertRows(
+		const std::vector<RowType>& rows,
+		CppSQLite3Statement& multiRowStatement,
+		CppSQLite3Statement& singleRowStatement,
+		BindRowFunction bindRow,
+		RowsInsertedFunction rowsInserted);
 	void insertOrUpdateMetaValue(const std::string& key, const std::string& value);
+	std::string getSchemaObjectType(const std::string& name) const; // "table", "view", ... or "" if it does not exist
 	CppSQLite3Statement compileStatement(const std::string& statement) const;
+	CppSQLite3Statement& getReadStatement(const std::string& query) const;
+	std::vector<StorageNode> queryNodes(CppSQLite3Statement& statement) const;
+	std::vector<StorageSymbolNode> querySymbolNodes(CppSQLite3Statement& statement, bool withSerializedNames) const;
+	std::vector<StorageEdge> queryEdges(CppSQLite3Statement& statement) const;
+	void visitSymbolNodes(
+		CppSQLite3Statement& statement,
+		bool withSerializedNames,
+		const std::function<bool(const StorageSymbolNode&)>& visitor) const;
+	void visitEdges(CppSQLite3Statement& statement, const std::function<bool(const StorageEdge&)>& visitor) const;
 	void executeStatement(const std::string& statement) const;
 	void executeStatement(CppSQLite3Statement& statement) const;
 	CppSQLite3Query executeQuery(const std::string& query) const;
@@ -118,18 +255,102 @@ private:
 	template <typename ResultType>
 	std::vector<ResultType> doGetAll(const std::string& query) const;
 
+	void mergeAttachedDatabase(int unknownNodeKind);
+	void countOperation(OperationStatistics& operation, size_t rows);
+	void countLookup(LookupStatistics& lookup, size_t LookupStatistics::*outcome);
+	bool hasCachedTableContent() const;
+	void clearCaches(bool cachesComplete);
+
+	struct EdgeKey
+	{
+		EdgeKey(const StorageEdgeData& storageEdgeData);
+
+		int sourceNodeId;
+		int targetNodeId;
+		int edgeKind;
+
+		bool operator==(const EdgeKey& other) const;
+	};
+
+	struct EdgeKeyHash
+	{
+		size_t operator()(const EdgeKey& key) const;
+	};
+
+	struct SourceLocationKey
+	{
+		SourceLocationKey(const StorageSourceLocationData& storageSourceLocationData);
+
+		int fileNodeId;
+		int startLineNumber;
+		int startColumnNumber;
+		int endLineNumber;
+		int endColumnNumber;
+		int locationKind;
+
+		bool operator==(const SourceLocationKey& other) const;
+	};
+
+	struct SourceLocationKeyHash
+	{
+		size_t operator()(const SourceLocationKey& key) const;
+	};
+
 	mutable CppSQLite3DB m_database;
 
+	StorageProfile m_storageProfile = StorageProfile::DEFAULT;
+	bool m_walJournalMode = false; // whether applyStorageOptions() has switched the database to WAL mode
+
+	bool m_bulkLoading = false;
+
+	bool m_statisticsEnabled = false;
+	mutable StorageStatistics m_statistics = StorageStatistics();
+
+	bool m_fileContentDeduplicationEnabled = false;
+
+	// In-memory lookup caches for the deduplicating add methods. Every id handed out or found by this instance is
+	// remembered here, so repeated lookups never reach SQLite. While m_cachesComplete is set, all rows of the cached
+	// tables were written through this instance, which makes a cache miss authoritative and skips the SELECT as well.
+	bool m_cachesComplete = false;
+	std::unordered_map<std::string, int> m_nodeIdCache;
+	std::unordered_map<EdgeKey, int, EdgeKeyHash> m_edgeIdCache;
+	std::unordered_map<std::string, int> m_localSymbolIdCache;
+	std::unordered_map<SourceLocationKey, int, SourceLocationKeyHash> m_sourceLocationIdCache;
+	std::unordered_set<uint64_t> m_elementFileCache; // element id in the upper, file id in the lower 32 bits
+
+	// Inside a transaction element ids are handed out from a block of element rows that has been inserted up front.
+	// The ids in [m_nextElementId, m_endElementId) are reserved but unused, their rows are deleted again before the
+	// transaction ends. Each savepoint remembers the reservation, because rolling back to it restores those rows.
+	struct ElementIdReservation
+	{
+		std::string savepointName;
+		bool startsTransaction;
+		int nextElementId;
+		int endElementId;
+	};
+
+	int m_nextElementId = 0;
+	int m_endElementId = 0;
+	int m_elementIdBlockSize = 0;
+	std::vector<ElementIdReservation> m_savepointElementIdReservations;
+
 	CppSQLite3Statement m_insertElementStatement;
+	CppSQLite3Statement m_insertElementRangeStatement;
+	CppSQLite3Statement m_deleteElementRangeStatement;
 	CppSQLite3Statement m_insertElementComponentStatement;
 	CppSQLite3Statement m_findNodeStatement;
 	CppSQLite3Statement m_insertNodeStatement;
+	CppSQLite3Statement m_insertNodeNameStatement;
 	CppSQLite3Statement m_setNodeTypeStmt;
 	CppSQLite3Statement m_insertSymbolStatement;
 	CppSQLite3Statement m_findFileStatement;
 	CppSQLite3Statement m_insertFileStatement;
 	CppSQLite3Statement m_setFileLanguageStmt;
 	CppSQLite3Statement m_insertFileContentStatement;
+	CppSQLite3Statement m_findFileContentStatement;
+	CppSQLite3Statement m_insertFileContentRefStatement;
+	CppSQLite3Statement m_insertFileStateStatement;
+	CppSQLite3Statement m_findFileStateStatement;
 	CppSQLite3Statement m_findEdgeStatement;
 	CppSQLite3Statement m_insertEdgeStatement;
 	CppSQLite3Statement m_findLocalSymbolStmt;
@@ -143,6 +364,22 @@ private:
 
 	// Prepared statement for tests mapping table
 	CppSQLite3Statement m_insertTestMappingStmt;
+	CppSQLite3Statement m_insertElementFileStmt;
+
+	// Multi-row variants of the insert statements above, used by the batch add methods
+	CppSQLite3Statement m_insertNodesStatement;
+	CppSQLite3Statement m_insertNodeNamesStatement;
+	CppSQLite3Statement m_insertEdgesStatement;
+	CppSQLite3Statement m_insertSourceLocationsStmt;
+	CppSQLite3Statement m_insertOccurrencesStmt;
+
+	// Statements of the read helpers keyed by their SQL, compiled on first use because readers never call
+	// setupDatabase(). Queries with IN-lists get one entry per list length.
+	mutable std::unordered_map<std::string, CppSQLite3Statement> m_readStatements;
+
+	// result of hasNodeNames(), -1 until it has been checked
+	mutable int m_hasNodeNames = -1;
+	bool m_nodeNamesMarkerOutdated = false; // nodes have been added since updateNodeNamesMarker()
 };
 
 template <>
@@ -0,0 +1,62 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_MEMORY_MAPPED_FILE_H
+#define SOURCETRAIL_MEMORY_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+namespace sourcetrail
+{
+/**
+ * Read-only view of a file's bytes that are mapped into memory instead of being copied.
+ *
+ * The bytes stay valid for the lifetime of the object. Empty files are not mapped at all and
+ * provide a null data pointer. Files smaller than MIN_MAPPED_SIZE are read into a buffer instead,
+ * because mapping them costs more than copying them.
+ *
+ * On POSIX systems a mapped file must not be truncated while the object exists. Accessing the pages
+ * that have been cut off raises SIGBUS, which cannot be turned into an exception. Windows does not
+ * let other processes write to the file while it is mapped.
+ */
+class MemoryMappedFile
+{
+public:
+	static const size_t MIN_MAPPED_SIZE = 256 * 1024;
+
+	// throws a SourcetrailException "Exception thrown while reading file ..." if the file cannot be opened, read or mapped
+	explicit MemoryMappedFile(const std::string& filePath);
+	~MemoryMappedFile();
+
+	MemoryMappedFile(const MemoryMappedFile&) = delete;
+	MemoryMappedFile& operator=(const MemoryMappedFile&) = delete;
+
+	const char* getData() const;
+	size_t getSize() const;
+
+private:
+	const char* m_data;
+	size_t m_size;
+	std::string m_buffer; // content of files that are read instead of mapped
+#ifdef _WIN32
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_MEMORY_MAPPED_FILE_H
@@ -93,6 +93,21 @@ NameHierarchy deserializeNameHierarchyFromJson(const std::string& serializedName
  * INTERNAL: Converts a NameHierarchy to a string in Sourcetrail database format
  */
 std::string serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy);
+
+/**
+ * INTERNAL: Starts a string in Sourcetrail database format that does not contain any NameElement yet
+ *
+ *  see: appendNameElementToDatabaseString()
+ */
+void beginNameHierarchyDatabaseString(std::string& serialized, const std::string& nameDelimiter);
+
+/**
+ * INTERNAL: Appends a NameElement to a string in Sourcetrail database format
+ *
+ * Appending the elements of a NameHierarchy one by one yields the serialized name of each prefix of that hierarchy
+ * without serializing any element twice.
+ */
+void appendNameElementToDatabaseString(std::string& serialized, const NameElement& nameElement, bool isFirstElement);
 }	 // namespace sourcetrail
 
 #endif	  // SOURCETRAIL_NAME_HIERARCHY_H
@@ -0,0 +1,176 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
+#define SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
+
+#include <memory>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "NameHierarchy.h"
+
+namespace sourcetrail
+{
+/**
+ * NameHierarchyBuilder
+ *
+ * Builds the name of a symbol like a NameHierarchy does, but without allocating memory for every symbol. All strings
+ * passed to the builder are interned in an arena owned by the builder, so names of namespaces and classes that occur
+ * in many symbols are stored once. Calling clear() keeps the arena and the capacity of the builder. Reusing one builder
+ * for all symbols of a SourcetrailDBWriter therefore does not allocate anymore once the names are known.
+ *
+ *  note: The intern pool belongs to a single builder and is neither shared with other builders nor thread safe. It
+ *    only grows, so it holds every distinct string passed to the builder until the builder is destroyed. Use one
+ *    builder per thread and destroy it when the names it has seen are not needed anymore.
+ *
+ *  see: SourcetrailDBWriter::recordSymbol(const NameHierarchyBuilder& nameHierarchy)
+ */
+class NameHierarchyBuilder
+{
+public:
+	/**
+	 * Reference to a string interned by the builder. It stays valid as long as the builder exists.
+	 */
+	struct StringRef
+	{
+		const char* data;
+		size_t size;
+	};
+
+	/**
+	 * Name element whose strings are interned by the builder
+	 *
+	 *  see: NameElement
+	 */
+	struct Element
+	{
+		StringRef prefix;
+		StringRef name;
+		StringRef postfix;
+	};
+
+	explicit NameHierarchyBuilder(const std::string& nameDelimiter = "::");
+
+	NameHierarchyBuilder(const NameHierarchyBuilder&) = delete;
+	NameHierarchyBuilder& operator=(const NameHierarchyBuilder&) = delete;
+	NameHierarchyBuilder(NameHierarchyBuilder&&) = default;
+	NameHierarchyBuilder& operator=(NameHierarchyBuilder&&) = default;
+
+	/**
+	 * Removes all name elements to start building the next name
+	 *
+	 * The name delimiter and all interned strings are kept.
+	 */
+	void clear();
+
+	/**
+	 * Sets the delimiter added between name elements
+	 *
+	 *  param: nameDelimiter - the delimiter, e.g. "::" or "."
+	 */
+	void setNameDelimiter(const std::string& nameDelimiter);
+
+	/**
+	 * Appends a name element without prefix and postfix
+	 *
+	 *  param: name - name represented by the element
+	 */
+	void pushNameElement(const std::string& name);
+
+	/**
+	 * Appends a name element without prefix and postfix
+	 *
+	 * Allows to pass names from buffers of a parser without creating a std::string first.
+	 *
+	 *  param: name - name represented by the element, does not need to be null terminated
+	 *  param: nameSize - number of characters of the name
+	 */
+	void pushNameElement(const char* name, size_t nameSize);
+
+	/**
+	 * Appends a name element
+	 *
+	 *  param: prefix - optional prefix used for unique identification and shown in tooltips
+	 *  param: name - name represented by the element
+	 *  param: postfix - optional postfix used for unique identification and shown in tooltips
+	 *
+	 *  see: NameElement
+	 */
+	void pushNameElement(const std::string& prefix, const std::string& name, const std::string& postfix);
+
+	/**
+	 * Removes the last name element, e.g. when leaving a scope
+	 */
+	void popNameElement();
+
+	StringRef getNameDelimiter() const;
+	size_t getNameElementCount() const;
+	const Element& getNameElement(size_t index) const;
+
+	/**
+	 * Converts the current name to a NameHierarchy
+	 *
+	 *  return: NameHierarchy with copies of the name delimiter and all name elements
+	 */
+	NameHierarchy toNameHierarchy() const;
+
+	/**
+	 * Returns the number of distinct strings interned by the builder
+	 */
+	size_t getInternedStringCount() const;
+
+private:
+	struct StringRefHash
+	{
+		size_t operator()(const StringRef& stringRef) const;
+	};
+
+	struct StringRefEqual
+	{
+		bool operator()(const StringRef& a, const StringRef& b) const;
+	};
+
+	StringRef intern(const std::string& str);
+	StringRef intern(const char* data, size_t size);
+
+	std::vector<std::unique_ptr<char[]>> m_arenaBlocks;
+	size_t m_arenaBlockSize = 0;
+	size_t m_arenaBlockUsed = 0;
+	std::unordered_set<StringRef, StringRefHash, StringRefEqual> m_internedStrings;
+
+	StringRef m_nameDelimiter;
+	std::vector<Element> m_nameElements;
+};
+
+/**
+ * INTERNAL: Starts a string in Sourcetrail database format that does not contain any NameElement yet
+ *
+ *  see: beginNameHierarchyDatabaseString(std::string& serialized, const std::string& nameDelimiter)
+ */
+void beginNameHierarchyDatabaseString(std::string& serialized, const NameHierarchyBuilder::StringRef& nameDelimiter);
+
+/**
+ * INTERNAL: Appends a name element of a NameHierarchyBuilder to a string in Sourcetrail database format
+ *
+ *  see: appendNameElementToDatabaseString(std::string& serialized, const NameElement& nameElement, bool isFirstElement)
+ */
+void appendNameElementToDatabaseString(
+	std::string& serialized, const NameHierarchyBuilder::Element& nameElement, bool isFirstElement);
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_NAME_HIERARCHY_BUILDER_H
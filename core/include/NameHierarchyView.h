@@ -0,0 +1,108 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_NAME_HIERARCHY_VIEW_H
+#define SOURCETRAIL_NAME_HIERARCHY_VIEW_H
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "NameHierarchy.h"
+#include "NameHierarchyBuilder.h"
+
+namespace sourcetrail
+{
+/**
+ * NameHierarchyView
+ *
+ * Read-only name of a symbol that refers to the name in Sourcetrail database format instead of copying its parts. The
+ * serialized name lives in a buffer that can be shared by the views of many symbols. Its name elements are located
+ * on first access and the returned StringRefs point into that buffer, so reading a name does not allocate memory for
+ * every name, prefix and postfix. A view keeps its buffer alive. Like the SourcetrailDBReader, a view must not be used
+ * by several threads at once.
+ *
+ *  see: SourcetrailDBReader::getAllSymbolViews()
+ */
+class NameHierarchyView
+{
+public:
+	typedef NameHierarchyBuilder::StringRef StringRef;
+	typedef NameHierarchyBuilder::Element Element;
+
+	NameHierarchyView();
+
+	/**
+	 * Creates a view that owns a copy of the serialized name
+	 *
+	 *  param: serializedName - name in Sourcetrail database format
+	 */
+	explicit NameHierarchyView(const std::string& serializedName);
+
+	/**
+	 * Creates a view of a serialized name that is stored in a shared buffer
+	 *
+	 *  param: buffer - buffer that contains the serialized name, its characters must not change anymore
+	 *  param: offset - position of the first character of the serialized name in the buffer
+	 *  param: size - length of the serialized name
+	 */
+	NameHierarchyView(std::shared_ptr<const std::string> buffer, size_t offset, size_t size);
+
+	StringRef getSerializedName() const;
+	StringRef getNameDelimiter() const;
+	size_t getNameElementCount() const;
+	Element getNameElement(size_t index) const;
+
+	/**
+	 * Joins the names of all elements with the name delimiter, e.g. "ns::Class::method"
+	 */
+	std::string getQualifiedName() const;
+
+	/**
+	 * Converts the view to a NameHierarchy
+	 *
+	 *  return: NameHierarchy with copies of the name delimiter and all name elements
+	 */
+	NameHierarchy toNameHierarchy() const;
+
+private:
+	struct Range
+	{
+		size_t offset;
+		size_t size;
+	};
+
+	struct ElementRanges
+	{
+		Range prefix;
+		Range name;
+		Range postfix;
+	};
+
+	void decode() const;
+	StringRef toStringRef(const Range& range) const;
+
+	std::shared_ptr<const std::string> m_buffer;
+	Range m_serializedName;
+
+	mutable bool m_decoded;
+	mutable bool m_hasNameDelimiter;
+	mutable Range m_nameDelimiter;
+	mutable std::vector<ElementRanges> m_nameElements;
+};
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_NAME_HIERARCHY_VIEW_H
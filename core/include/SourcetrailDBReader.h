@@ -17,6 +17,7 @@
 #ifndef SOURCETRAIL_SRCTRLDB_READER_H
 #define SOURCETRAIL_SRCTRLDB_READER_H
 
+#include <functional>
 #include <memory>
 #include <string>
 #include <vector>
@@ -26,8 +27,10 @@
 #include "ElementComponentKind.h"
 #include "LocationKind.h"
 #include "NameHierarchy.h"
+#include "NameHierarchyView.h"
 #include "ReferenceKind.h" // kept for writer-side API elsewhere; reader now uses EdgeKind directly
 #include "SourceRange.h"
+#include "StorageOptions.h"
 #include "SymbolKind.h"
 
 namespace sourcetrail
@@ -77,6 +80,15 @@ public:
         std::vector<SourceRange> locations;
     };
 
+    // Symbol whose name is decoded on first access, see NameHierarchyView
+    struct SymbolView
+    {
+        int id;
+        NameHierarchyView name;
+        SymbolKind symbolKind;
+        DefinitionKind definitionKind;
+    };
+
     // Structure to represent a reference/edge between symbols
     struct Reference
     {
@@ -148,6 +160,18 @@ public:
      */
     bool open(const std::string& databaseFilePath);
 
+    /**
+     * Opens a Sourcetrail database for reading with specific connection settings
+     *
+     *  param: databaseFilePath - absolute file path of the database file, including file extension
+     *  param: storageOptions - connection settings, e.g. getStorageOptions(StorageProfile::READ_MOSTLY)
+     *
+     *  return: true if successful. false on failure. getLastError() provides the error message.
+     *
+     *  see: StorageOptions
+     */
+    bool open(const std::string& databaseFilePath, const StorageOptions& storageOptions);
+
     /**
      * Closes the currently open Sourcetrail database
      *
@@ -174,6 +198,16 @@ public:
     // Only integer ids and enum kinds; no strings or locations.
     std::vector<SymbolBrief> getAllSymbolsBrief() const;
 
+    /**
+     * Get all symbols from the database without decoding their names
+     *
+     * The serialized names of all symbols are stored in a few shared buffers. Their parts are located when they are
+     * accessed for the first time. Prefer this over getAllSymbols() when loading many symbols.
+     *
+     *  return: vector of all symbols in the database, their locations are not loaded
+     */
+    std::vector<SymbolView> getAllSymbolViews() const;
+
     /**
      * Get a symbol by its ID
      *
@@ -193,6 +227,19 @@ public:
      */
     std::vector<Symbol> findSymbolsByName(const std::string& name, bool exactMatch = false) const;
 
+    /**
+     * Find symbols whose name starts with a prefix, e.g. for completion
+     *
+     *  param: prefix - the start of the name of the last name element, an empty prefix matches all symbols
+     *  param: ignoreCase - if true, the case of ASCII letters is ignored
+     *
+     *  return: vector of symbols whose name starts with the prefix
+     *
+     *  note: Like findSymbolsByName() and findSymbolsByQualifiedName() the search is an index seek in databases that
+     *        have been written by this version. Older databases are scanned until a writer opens them.
+     */
+    std::vector<Symbol> findSymbolsByNamePrefix(const std::string& prefix, bool ignoreCase = false) const;
+
     /**
      * Find symbols by qualified name pattern (e.g., "MyNamespace::MyClass::myFunction")
      *
@@ -244,6 +291,66 @@ public:
      */
     std::vector<Reference> getReferencesByType(EdgeKind edgeKind) const; // Updated to EdgeKind
 
+    // Visitors of the streaming queries below, a visitor returns false to stop the iteration
+    typedef std::function<bool(const Symbol&)> SymbolVisitor;
+    typedef std::function<bool(const SymbolView&)> SymbolViewVisitor;
+    typedef std::function<bool(const Reference&)> ReferenceVisitor;
+
+    /**
+     * Visit symbols one at a time, in the order of their ids
+     *
+     * Rows are decoded straight from the database cursor, so a full scan runs in constant memory. The locations of
+     * the visited symbols are left empty. The visitor may run other queries on this reader.
+     *
+     *  param: visitor - called for every symbol, returns false to stop the iteration
+     *  param: afterId - only symbols with a greater id are visited, pass the id of the last visited symbol to continue
+     *  param: limit - maximum number of visited symbols, 0 visits all of them
+     *
+     *  return: true if successful, also when the visitor stopped the iteration. false on failure. getLastError()
+     *    provides the error message.
+     */
+    bool forEachSymbol(const SymbolVisitor& visitor, int afterId = 0, size_t limit = 0) const;
+
+    /**
+     * Visit symbols one at a time without decoding their names
+     *
+     *  param: visitor - called for every symbol, returns false to stop the iteration. It may keep copies of the views.
+     *  param: afterId - only symbols with a greater id are visited
+     *  param: limit - maximum number of visited symbols, 0 visits all of them
+     *
+     *  return: true if successful, also when the visitor stopped the iteration. false on failure.
+     *
+     *  see: forEachSymbol, getAllSymbolViews
+     */
+    bool forEachSymbolView(const SymbolViewVisitor& visitor, int afterId = 0, size_t limit = 0) const;
+
+    /**
+     * Visit references one at a time, in the order of their ids
+     *
+     *  param: visitor - called for every reference, returns false to stop the iteration
+     *  param: afterId - only references with a greater id are visited
+     *  param: limit - maximum number of visited references, 0 visits all of them
+     *
+     *  return: true if successful, also when the visitor stopped the iteration. false on failure.
+     *
+     *  see: forEachSymbol
+     */
+    bool forEachEdge(const ReferenceVisitor& visitor, int afterId = 0, size_t limit = 0) const;
+
+    /**
+     * Visit references of a specific type one at a time, in the order of their ids
+     *
+     *  param: edgeKind - the type of reference to filter by
+     *  param: visitor - called for every reference, returns false to stop the iteration
+     *  param: afterId - only references with a greater id are visited
+     *  param: limit - maximum number of visited references, 0 visits all of them
+     *
+     *  return: true if successful, also when the visitor stopped the iteration. false on failure.
+     *
+     *  see: forEachSymbol
+     */
+    bool forEachEdgeOfType(EdgeKind edgeKind, const ReferenceVisitor& visitor, int afterId = 0, size_t limit = 0) const;
+
     /**
      * Get all files from the database
      *
@@ -260,6 +367,18 @@ public:
      */
     File getFileById(int fileId) const;
 
+    /**
+     * Get the stored content of a file
+     *
+     *  param: fileId - the ID of the file
+     *
+     *  return: the content with normalized line endings, empty if no content is stored for the file
+     *
+     *  note: Contents that a writer has stored as a reference to an equal content while file content
+     *        deduplication was enabled are resolved.
+     */
+    std::string getFileContent(int fileId) const;
+
     /**
      * Find files by path (supports partial matching)
      *
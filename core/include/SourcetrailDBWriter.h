@@ -17,16 +17,23 @@
 #ifndef SOURCETRAIL_SRCTRLDB_WRITER_H
 #define SOURCETRAIL_SRCTRLDB_WRITER_H
 
+#include <chrono>
+#include <functional>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include "DefinitionKind.h"
 #include "EdgeKind.h"
 #include "ElementComponentKind.h"
 #include "LocationKind.h"
 #include "NameHierarchy.h"
+#include "NameHierarchyBuilder.h"
 #include "ReferenceKind.h"
 #include "SourceRange.h"
+#include "StorageOptions.h"
+#include "StorageStatistics.h"
 #include "SymbolKind.h"
 
 namespace sourcetrail
@@ -49,6 +56,63 @@ class DatabaseStorage;
 class SourcetrailDBWriter
 {
 public:
+	/**
+	 * A reference between two symbols, as recorded by recordReferences()
+	 */
+	struct ReferenceRecord
+	{
+		int contextSymbolId;
+		int referencedSymbolId;
+		ReferenceKind referenceKind;
+	};
+
+	/**
+	 * A location of a symbol or reference, as recorded by recordLocations()
+	 */
+	struct LocationRecord
+	{
+		int elementId;
+		SourceRange location;
+		LocationKind locationKind;
+	};
+
+	/**
+	 * Limits for the transactions opened by enableAutoCommit(). A transaction is committed as soon
+	 * as one of the limits is reached. 0 disables the respective limit.
+	 */
+	struct AutoCommitOptions
+	{
+		size_t maxRecords;		// number of successful record calls
+		size_t maxBytes;		// approximate size of the recorded data, including file contents
+		size_t maxMilliseconds; // time since the transaction has been started, checked on every record call
+	};
+
+	/**
+	 * Durations of the commits performed by commitTransaction() and by the auto commit mode
+	 */
+	struct CommitStatistics
+	{
+		size_t commitCount;
+		size_t committedRecords; // records committed by the auto commit mode
+		double totalMilliseconds;
+		double maxMilliseconds;
+		double lastMilliseconds;
+	};
+
+	/**
+	 * Settings for building a database in memory with openStaged()
+	 */
+	struct StagingOptions
+	{
+		long long memoryBudgetBytes; // memory the staged database may use, 0 for no limit
+		long long expectedBytes;	 // estimated growth of the database while staged, e.g. from a previous run
+	};
+
+	/**
+	 * Called by persist() after every copied block of database pages
+	 */
+	typedef std::function<void(int copiedPages, int totalPages)> PersistProgressCallback;
+
 	SourcetrailDBWriter();
 	~SourcetrailDBWriter();
 
@@ -117,9 +181,71 @@ public:
 	 */
 	bool open(const std::string& databaseFilePath);
 
+	/**
+	 * Opens a Sourcetrail database with specific connection settings
+	 *
+	 * Behaves like open(const std::string& databaseFilePath), but configures the database connection
+	 * according to the provided options. The name of the used StorageProfile is stored in the
+	 * database's meta table.
+	 *
+	 *  param: databaseFilePath - absolute file path of the database file, including file extension
+	 *  param: storageOptions - connection settings, e.g. getStorageOptions(StorageProfile::BULK_INGEST).
+	 *    Query-only settings cannot be used for writing.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: StorageOptions
+	 */
+	bool open(const std::string& databaseFilePath, const StorageOptions& storageOptions);
+
+	/**
+	 * Opens a Sourcetrail database that is built in memory and written to disk at once
+	 *
+	 * The database is staged in an in-memory SQLite database, so recording causes no journal or disk traffic at all.
+	 * An existing database file is loaded into memory first. Call persist() to write the staged database to
+	 * databaseFilePath. close() persists all changes that have not been persisted yet.
+	 *
+	 *  note: Opening fails without loading anything if the size of the existing database file plus the expected
+	 *    growth exceeds the memory budget.
+	 *
+	 *  param: databaseFilePath - absolute file path of the database file, including file extension
+	 *  param: stagingOptions - memory budget and expected growth of the database
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: persist()
+	 */
+	bool openStaged(const std::string& databaseFilePath, const StagingOptions& stagingOptions);
+
+	/**
+	 * Writes the database staged in memory to its database file with SQLite's online backup API
+	 *
+	 * Pending records of the auto commit mode are committed first. The database stays open and can be persisted
+	 * again later.
+	 *
+	 *  note: Cannot be called within a transaction, a savepoint or a bulk load.
+	 *
+	 *  param: progressCallback - optional callback receiving the number of copied and total database pages
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: openStaged()
+	 */
+	bool persist(const PersistProgressCallback& progressCallback = PersistProgressCallback());
+
+	/**
+	 * Checks whether the database has been opened with openStaged()
+	 *
+	 *  return: true if the database is staged in memory
+	 */
+	bool isStaged() const;
+
 	/**
 	 * Closes the currently open Sourcetrail database
 	 *
+	 * A database opened with openStaged() is persisted first. If that fails, the database stays open, so
+	 * that no recorded data is lost and close() can be called again.
+	 *
 	 *  return: Returns true if the operation was successful. Otherwise false is returned and getLastError()
 	 *    can be checked for more detailed information.
 	 *
@@ -189,6 +315,141 @@ public:
 	 */
 	bool rollbackTransaction();
 
+	/**
+	 * Starts recording in transactions that are committed automatically
+	 *
+	 * In auto commit mode the SourcetrailDBWriter keeps a transaction open at all times and
+	 * commits it whenever one of the configured limits is reached. This avoids both, the cost
+	 * of committing every single record and the cost of one huge transaction. While a savepoint
+	 * is open, committing is postponed until the outermost savepoint has been released or
+	 * rolled back.
+	 *
+	 *  note: Explicit transactions cannot be used in auto commit mode. Call this method outside of
+	 *    a transaction.
+	 *
+	 *  param: options - the limits that trigger a commit.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: disableAutoCommit()
+	 *  see: beginSavepoint(const std::string& name)
+	 */
+	bool enableAutoCommit(const AutoCommitOptions& options);
+
+	/**
+	 * Commits the pending records and leaves the auto commit mode
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool disableAutoCommit();
+
+	/**
+	 * Provides the durations of all commits since the database has been opened
+	 *
+	 *  return: statistics of the performed commits
+	 */
+	const CommitStatistics& getCommitStatistics() const;
+
+	/**
+	 * Starts collecting statistics about the recorded data
+	 *
+	 * Counts the calls and inserted rows per kind of data, the outcomes of the lookups that
+	 * deduplicate nodes, edges and source locations, the time spent in SQLite and in the library
+	 * and the commit latencies. Collecting statistics only costs a few counter increments and
+	 * clock reads per record call.
+	 *
+	 *  note: Statistics are reset when the database is closed.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: getStatistics()
+	 */
+	bool enableStatistics();
+
+	/**
+	 * Stops collecting statistics. The statistics collected so far are kept.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool disableStatistics();
+
+	/**
+	 * Provides the statistics collected since enableStatistics() or resetStatistics()
+	 *
+	 *  return: the collected statistics, all zero if no database is open.
+	 *
+	 *  see: storageStatisticsToJson(const StorageStatistics& statistics)
+	 */
+	StorageStatistics getStatistics() const;
+
+	/**
+	 * Sets all collected statistics back to zero
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool resetStatistics();
+
+	/**
+	 * Starts storing each distinct file content only once
+	 *
+	 * A file whose content equals the content of a file recorded before gets no filecontent row of
+	 * its own but a row in the filecontent_ref table that refers to that file. Contents are compared
+	 * by their bytes, the hashes recorded for isFileUpToDate() only narrow the search. The schema
+	 * and version of the database stay the same, databases are never converted.
+	 *
+	 *  note: Sourcetrail does not resolve the filecontent_ref table and shows no content for files
+	 *    stored as a reference. SourcetrailDBReader::getFileContent() resolves them.
+	 *  note: The setting is not stored in the database and is reset when the database is closed.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool enableFileContentDeduplication();
+
+	/**
+	 * Stops deduplicating file contents. Contents stored as references so far stay references.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool disableFileContentDeduplication();
+
+	/**
+	 * Marks a point within the current transaction that can be restored later on
+	 *
+	 * Savepoints allow to revert the records of a single unit of work, e.g. of one file that
+	 * failed to index, without losing the other records of the surrounding transaction.
+	 * Savepoints can be nested. When called outside of a transaction, the savepoint starts one.
+	 *
+	 *  param: name - the name of the savepoint.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: releaseSavepoint(const std::string& name)
+	 *  see: rollbackToSavepoint(const std::string& name)
+	 */
+	bool beginSavepoint(const std::string& name);
+
+	/**
+	 * Keeps all records since the savepoint has been started and removes the savepoint
+	 *
+	 * Savepoints nested in the released savepoint are released as well.
+	 *
+	 *  param: name - the name of the savepoint.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool releaseSavepoint(const std::string& name);
+
+	/**
+	 * Reverts all records since the savepoint has been started and removes the savepoint
+	 *
+	 * Savepoints nested in the reverted savepoint are removed as well.
+	 *
+	 *  param: name - the name of the savepoint.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool rollbackToSavepoint(const std::string& name);
+
 	/**
 	 * Reduces the on disk memory consumption of the open database to a minimum
 	 *
@@ -196,6 +457,57 @@ public:
 	 */
 	bool optimizeDatabaseMemory();
 
+	/**
+	 * Starts a bulk load session on the currently open database
+	 *
+	 * During a bulk load session foreign keys are not enforced and only the indices needed to
+	 * deduplicate recorded data are maintained. When indexing into a new or cleared database, no
+	 * index is maintained at all. This makes writing large amounts of data significantly faster.
+	 * Use transactions as usual within the session.
+	 *
+	 *  note: This method needs to be called outside of a transaction.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: endBulkLoad()
+	 */
+	bool beginBulkLoad();
+
+	/**
+	 * Ends the current bulk load session
+	 *
+	 * Builds all indices that have been deferred, checks that all data recorded during the session
+	 * only references existing elements and updates the statistics used to plan database queries.
+	 * Closing the database ends a running bulk load session as well.
+	 *
+	 *  note: This method needs to be called outside of a transaction.
+	 *
+	 *  return: true if successful. false on failure, e.g. if recorded data references elements that
+	 *    do not exist. getLastError() provides the error message.
+	 *
+	 *  see: beginBulkLoad()
+	 */
+	bool endBulkLoad();
+
+	/**
+	 * Copies all data of another Sourcetrail database into the currently open database
+	 *
+	 * This method allows to index disjoint sets of files into separate databases in parallel and to
+	 * combine them afterwards. Symbols are matched by name hierarchy, references by their context
+	 * symbol, referenced symbol and kind and locations by their file and range, so data that has
+	 * been recorded to both databases is stored only once. All other data is stored with new ids.
+	 * The merge is performed within the database files, so it does not need to hold the merged
+	 * data in memory.
+	 *
+	 *  note: This method needs to be called outside of a transaction. Ids returned while recording
+	 *    the merged database are not valid for the currently open database.
+	 *
+	 *  param: databaseFilePath - file path of the database that shall be merged into the open one.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool mergeDatabase(const std::string& databaseFilePath);
+
 	/**
 	 * Stores a symbol to the database
 	 *
@@ -211,6 +523,22 @@ public:
 	 */
 	int recordSymbol(const NameHierarchy& nameHierarchy);
 
+	/**
+	 * Stores a symbol to the database
+	 *
+	 *  note: Recording a symbol whose name elements are all known to this writer does not allocate memory, if the
+	 *    same builder is reused for all symbols.
+	 *
+	 *  param: nameHierarchy - the name of the symbol to store.
+	 *
+	 *  return: symbolId - integer id of the stored symbol. 0 on failure. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: recordSymbol(const NameHierarchy& nameHierarchy)
+	 *  see: NameHierarchyBuilder
+	 */
+	int recordSymbol(const NameHierarchyBuilder& nameHierarchy);
+
 	/**
 	 * Stores a definition kind for a specific symbol to the database
 	 *
@@ -411,6 +739,8 @@ public:
 	 *
 	 *  note: Calling this method multiple times with the same input on the same Sourcetrail database
 	 *    will always return the same id.
+	 *  note: Files of 256 KiB or more are memory mapped while their content is stored. On POSIX
+	 *    systems, truncating such a file at that time terminates the process with SIGBUS.
 	 *
 	 *  param: filePath - the absolute path to the file to store.
 	 *
@@ -434,6 +764,70 @@ public:
 	 */
 	bool recordFileLanguage(int fileId, const std::string& languageIdentifier);
 
+	/**
+	 * Starts re-recording the data of a single file
+	 *
+	 * This method allows to update the database incrementally after a file has changed. It records the
+	 * file, re-reads its content and removes everything that has been recorded for it before: all source
+	 * locations within the file and all symbols, references, local symbols and errors that have not been
+	 * recorded for any other file. Symbols that are still used elsewhere are kept. Until endFileUpdate()
+	 * is called, all recorded symbols, references, local symbols and errors are attributed to this file,
+	 * even if they are recorded without a location in it.
+	 *
+	 *  note: Elements are only attributed to files while a file update is in progress, so writers that
+	 *    never update or remove files do not pay for it. Within a file update, elements are attributed
+	 *    to the files of their recorded locations as well, including elements without locations, e.g.
+	 *    the parent namespaces of a symbol. File updates cannot be used during a bulk load.
+	 *
+	 *  param: filePath - the absolute path to the file that shall be updated.
+	 *
+	 *  return: fileId - integer id of the updated file. 0 on failure. getLastError() provides the
+	 *    error message.
+	 *
+	 *  see: endFileUpdate()
+	 *  see: removeFile(int fileId)
+	 */
+	int beginFileUpdate(const std::string& filePath);
+
+	/**
+	 * Checks whether a file has changed since it has been recorded
+	 *
+	 * Indexers can use this method to skip parsing unchanged files. The file's size and modification
+	 * time are compared to the recorded ones. If only the modification time differs, the file's
+	 * content is compared by hash, so touched but otherwise unchanged files are up to date as well.
+	 *
+	 *  param: filePath - the absolute path to the file, as passed to recordFile().
+	 *
+	 *  return: true if the file is recorded with its current content. false if it has changed, has not
+	 *    been recorded or on failure. getLastError() provides the error message.
+	 *
+	 *  see: beginFileUpdate(const std::string& filePath)
+	 */
+	bool isFileUpToDate(const std::string& filePath) const;
+
+	/**
+	 * Stops attributing recorded data to the file passed to beginFileUpdate()
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 */
+	bool endFileUpdate();
+
+	/**
+	 * Removes a file and all data that has only been recorded for that file
+	 *
+	 * The file node remains as a non-indexed file while references of other files point to it. The
+	 * source locations within the file are always removed, the elements only if they have been recorded
+	 * within a file update.
+	 *
+	 *  param: fileId - the id of the file that shall be removed.
+	 *
+	 *  return: true if successful. false if fileId does not refer to a file or on failure. getLastError()
+	 *    provides the error message.
+	 *
+	 *  see: beginFileUpdate(const std::string& filePath)
+	 */
+	bool removeFile(int fileId);
+
 	/**
 	 * Stores a local symbol to the database
 	 *
@@ -512,23 +906,123 @@ public:
 	 */
 	bool recordTestMapping(int symbolId, int testSymbolId);
 
+	/**
+	 * Stores multiple symbols to the database
+	 *
+	 * This method behaves like calling recordSymbol() for each of the provided name hierarchies,
+	 * but writes all new nodes and edges with a few multi-row statements. If one of the symbols
+	 * cannot be recorded, none of them is stored.
+	 *
+	 *  param: nameHierarchies - the names of the symbols to store.
+	 *
+	 *  return: symbolIds - the ids of the stored symbols in the order of the provided name
+	 *    hierarchies. Empty on failure. getLastError() provides the error message.
+	 *
+	 *  see: recordSymbol(const NameHierarchy& nameHierarchy)
+	 */
+	std::vector<int> recordSymbols(const std::vector<NameHierarchy>& nameHierarchies);
+
+	/**
+	 * Stores multiple references between symbols to the database
+	 *
+	 * This method behaves like calling recordReference() for each of the provided references,
+	 * but writes all new edges with a few multi-row statements. If one of the references cannot
+	 * be recorded, none of them is stored.
+	 *
+	 *  param: references - the references to store.
+	 *
+	 *  return: referenceIds - the ids of the stored references in the order of the provided
+	 *    references. Empty on failure. getLastError() provides the error message.
+	 *
+	 *  see: recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+	 */
+	std::vector<int> recordReferences(const std::vector<ReferenceRecord>& references);
+
+	/**
+	 * Stores multiple locations of symbols or references to the database
+	 *
+	 * This method behaves like calling the matching location recording method (e.g.
+	 * recordSymbolLocation(), recordReferenceLocation()) for each of the provided locations, but
+	 * writes all new source locations and occurrences with a few multi-row statements. If one of
+	 * the locations cannot be recorded, none of them is stored.
+	 *
+	 *  param: locations - the locations to store. Each one holds the id of the symbol, reference
+	 *    or local symbol it belongs to and the LocationKind it shall be recorded with.
+	 *
+	 *  return: true if successful. false on failure. getLastError() provides the error message.
+	 *
+	 *  see: LocationKind
+	 */
+	bool recordLocations(const std::vector<LocationRecord>& locations);
+
 private:
+	struct SavepointState
+	{
+		std::string name;
+		size_t pendingRecords; // pending records of the auto commit transaction when the savepoint has been started
+		size_t pendingBytes;
+	};
+
+	// adds the time spent in the outermost record call outside of SQLite to the statistics
+	class RecordTimer
+	{
+	public:
+		explicit RecordTimer(SourcetrailDBWriter& writer);
+		~RecordTimer();
+
+	private:
+		SourcetrailDBWriter& m_writer;
+		StorageStatistics* m_statistics;
+		double m_startSqliteMilliseconds;
+		std::chrono::steady_clock::time_point m_startTime;
+	};
+
+	bool openProject(const std::string& databaseFilePath, const StorageOptions& storageOptions);
 	void openDatabase();
 	void closeDatabase();
 	void setupDatabaseTables();
 	void clearDatabaseTables();
 	void createOrResetProjectFile();
 	void updateProjectSettingsText();
-	int addNodeHierarchy(const NameHierarchy& nameHierarchy);
-	int addFile(const std::string& filePath);
+	template <typename NameHierarchyType>
+	int addNodeHierarchy(const NameHierarchyType& nameHierarchy);
+	std::vector<int> addNodeHierarchies(const std::vector<NameHierarchy>& nameHierarchies);
+	void rollbackBatch();
+	void addElementFile(int elementId);
+	template <typename NameHierarchyType>
+	void addElementFile(const NameHierarchyType& nameHierarchy);
+	void onRecorded(size_t recordCount, size_t recordBytes);
+	void beginAutoCommitTransaction();
+	void commitAutoCommitTransaction();
+	void commitMeasured();
+	int addFile(const std::string& filePath, size_t& recordedBytes);
 	int addEdge(int sourceId, int targetId, EdgeKind edgeKind);
 	void addSourceLocation(int elementId, const SourceRange& location, LocationKind kind);
 	void addElementComponent(int elementId, ElementComponentKind kind, const std::string& data);
 
 	std::string m_projectFilePath;
 	std::string m_databaseFilePath;
+	StorageOptions m_storageOptions;
 	std::unique_ptr<DatabaseStorage> m_storage;
 	mutable std::string m_lastError;
+
+	bool m_autoCommitEnabled;
+	AutoCommitOptions m_autoCommitOptions;
+	size_t m_pendingRecords;
+	size_t m_pendingBytes;
+	std::chrono::steady_clock::time_point m_transactionStartTime;
+	CommitStatistics m_commitStatistics;
+	std::vector<SavepointState> m_savepoints;
+
+	int m_updatedFileId; // file that recorded elements are attributed to, 0 outside of beginFileUpdate()
+
+	bool m_staged;
+	int m_persistedChangeCount; // change count of the staged storage when it has last been persisted
+
+	size_t m_recordDepth; // number of nested record calls, only the outermost one is timed
+
+	std::string m_serializedName; // reused while looking up the prefixes of a name hierarchy
+	std::vector<size_t> m_serializedNamePrefixEnds; // end of each prefix within m_serializedName
 };
 }	 // namespace sourcetrail
 
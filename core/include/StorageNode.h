@@ -41,6 +41,17 @@ struct StorageNode: public StorageNodeData
 
 	int id;
 };
+
+// Row of the node_name table, which makes nodes searchable by the last element of their name
+struct StorageNodeName
+{
+	StorageNodeName(): id(0), parentId(0) {}
+
+	int id;
+	std::string name;
+	std::string nameLower;
+	int parentId;
+};
 }	 // namespace sourcetrail
 
 #endif	  // SOURCETRAIL_STORAGE_NODE_H
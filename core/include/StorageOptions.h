@@ -0,0 +1,64 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_STORAGE_OPTIONS_H
+#define SOURCETRAIL_STORAGE_OPTIONS_H
+
+#include <string>
+
+namespace sourcetrail
+{
+/**
+ * Enum providing the named performance profiles for opening a Sourcetrail database.
+ *
+ *  - DEFAULT: SQLite's default connection settings. Safe for every kind of use.
+ *  - BULK_INGEST: for writing large amounts of data. Uses a write-ahead log while the writer is
+ *    open, does not wait for data to reach the disk and keeps a large page cache and all temporary
+ *    data in memory. A crash of the operating system while writing may corrupt the database.
+ *  - READ_MOSTLY: for querying an existing database. Maps the database file into memory and
+ *    rejects all writes.
+ */
+enum class StorageProfile : int
+{
+	DEFAULT = 0,
+	BULK_INGEST = 1,
+	READ_MOSTLY = 2
+};
+
+std::string storageProfileToString(StorageProfile profile);
+StorageProfile stringToStorageProfile(const std::string& s);
+
+/**
+ * Struct holding the connection settings used for opening a Sourcetrail database.
+ *
+ * Use getStorageOptions() to get the settings of a named profile and adjust single values if
+ * needed. Empty strings and zero values keep SQLite's default for the respective setting.
+ */
+struct StorageOptions
+{
+	StorageProfile profile;
+	std::string journalMode;	// PRAGMA journal_mode, e.g. "WAL" or "MEMORY"
+	std::string synchronous;	// PRAGMA synchronous, e.g. "OFF" or "NORMAL"
+	int cacheSizeKiB;			// PRAGMA cache_size in KiB
+	long long mmapSizeBytes;	// PRAGMA mmap_size in bytes
+	bool tempStoreInMemory;		// PRAGMA temp_store=MEMORY
+	bool queryOnly;				// PRAGMA query_only=ON
+};
+
+StorageOptions getStorageOptions(StorageProfile profile);
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_STORAGE_OPTIONS_H
@@ -0,0 +1,104 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef SOURCETRAIL_STORAGE_STATISTICS_H
+#define SOURCETRAIL_STORAGE_STATISTICS_H
+
+#include <array>
+#include <cstddef>
+#include <string>
+
+namespace sourcetrail
+{
+/**
+ * Struct counting the calls of one kind of add operation and the rows these calls have inserted.
+ */
+struct OperationStatistics
+{
+	size_t calls;
+	size_t rows;
+};
+
+/**
+ * Struct counting the outcomes of one kind of deduplicating lookup.
+ *
+ *  cacheHits: lookups answered by the in-memory id caches
+ *  databaseHits: lookups answered by a SELECT statement
+ *  misses: lookups that did not find anything, so that a new row has been inserted
+ */
+struct LookupStatistics
+{
+	size_t cacheHits;
+	size_t databaseHits;
+	size_t misses;
+};
+
+/**
+ * Upper bounds in milliseconds of the commit latency buckets. The last bucket counts all commits that took longer
+ * than the last bound.
+ */
+const size_t COMMIT_LATENCY_BUCKET_COUNT = 8;
+const double COMMIT_LATENCY_BUCKET_UPPER_BOUNDS[COMMIT_LATENCY_BUCKET_COUNT - 1] = {1, 5, 10, 50, 100, 500, 1000};
+
+/**
+ * Struct holding the statistics collected while writing to a Sourcetrail database.
+ *
+ *  sqliteMilliseconds: time spent executing SQLite statements, including commits
+ *  libraryMilliseconds: time spent in the record methods of SourcetrailDBWriter outside of SQLite
+ *  commitLatencyBuckets: number of commits per latency range, see COMMIT_LATENCY_BUCKET_UPPER_BOUNDS
+ *  fileContentBytes: bytes of file content that have been stored
+ */
+struct StorageStatistics
+{
+	OperationStatistics nodes;
+	OperationStatistics edges;
+	OperationStatistics sourceLocations;
+	OperationStatistics occurrences;
+	OperationStatistics files;
+	OperationStatistics localSymbols;
+	OperationStatistics errors;
+
+	LookupStatistics nodeLookups;
+	LookupStatistics edgeLookups;
+	LookupStatistics sourceLocationLookups;
+	LookupStatistics localSymbolLookups;
+	LookupStatistics errorLookups;
+	LookupStatistics fileContentLookups;
+
+	double sqliteMilliseconds;
+	double libraryMilliseconds;
+	std::array<size_t, COMMIT_LATENCY_BUCKET_COUNT> commitLatencyBuckets;
+	size_t fileContentBytes;
+};
+
+/**
+ * Converts StorageStatistics to a JSON string
+ *
+ *  param: statistics - the statistics to convert
+ *
+ *  return: a JSON object with one member per field of StorageStatistics, e.g.
+ *    {
+ *      "nodes": { "calls": 10, "rows": 8 },
+ *      "node_lookups": { "cache_hits": 1, "database_hits": 1, "misses": 8, "hit_ratio": 0.2 },
+ *      ...
+ *      "commit_latency_ms": [ { "max": 1, "count": 3 }, ..., { "max": null, "count": 0 } ],
+ *      "file_content_bytes": 1024
+ *    }
+ */
+std::string storageStatisticsToJson(const StorageStatistics& statistics);
+}	 // namespace sourcetrail
+
+#endif	  // SOURCETRAIL_STORAGE_STATISTICS_H
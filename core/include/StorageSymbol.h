@@ -17,7 +17,10 @@
 #ifndef SOURCETRAIL_STORAGE_SYMBOL_H
 #define SOURCETRAIL_STORAGE_SYMBOL_H
 
+#include <string>
+
 #include "DefinitionKind.h"
+#include "StorageNode.h"
 
 namespace sourcetrail
 {
@@ -30,6 +33,19 @@ struct StorageSymbol
 	int id;
 	int definitionKind;
 };
+
+// node together with the definition kind of its symbol row, definitionKind is -1 if the node is no symbol
+struct StorageSymbolNode: public StorageNode
+{
+	StorageSymbolNode(): StorageNode(), definitionKind(-1) {}
+
+	StorageSymbolNode(int id, int nodeKind, std::string serializedName, int definitionKind)
+		: StorageNode(id, nodeKind, std::move(serializedName)), definitionKind(definitionKind)
+	{
+	}
+
+	int definitionKind;
+};
 }	 // namespace sourcetrail
 
 #endif	  // SOURCETRAIL_STORAGE_SYMBOL_H
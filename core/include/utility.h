@@ -17,6 +17,8 @@
 #ifndef SOURCETRAIL_UTILITY_H
 #define SOURCETRAIL_UTILITY_H
 
+#include <cstddef>
+#include <functional>
 #include <string>
 #include <time.h>
 
@@ -24,10 +26,28 @@ namespace sourcetrail
 {
 namespace utility
 {
+struct FileStatus
+{
+	bool exists;
+	long long size;
+	long long modificationTime; // seconds since the epoch
+};
+
 bool getFileExists(const std::string& filePath);
+FileStatus getFileStatus(const std::string& filePath);
 std::string getFileContent(const std::string& filePath);
+std::string getNormalizedFileContent(const char* data, size_t size); // converts "\r\n" and "\r" to "\n" and terminates the last line
+void countLineBreaks(const char* data, size_t size, size_t& newlineCount, size_t& carriageReturnCount);
+std::string getContentHash(const char* data, size_t size); // 128 bit MurmurHash3 as 16 raw bytes
 std::string getDateTimeString(const time_t& time);
 int getLineCount(const std::string s);
+std::string toLowerCase(const std::string& s); // ASCII letters only, the bytes of other UTF-8 characters are kept
+
+template <typename T>
+void hashCombine(size_t& seed, const T& value)
+{
+	seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+}
 }	 // namespace utility
 }	 // namespace sourcetrail
 
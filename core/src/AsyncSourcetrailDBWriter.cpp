@@ -0,0 +1,353 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "AsyncSourcetrailDBWriter.h"
+
+#include <chrono>
+#include <memory>
+
+namespace sourcetrail
+{
+namespace
+{
+// upper bound for the time a request waits in an idle queue and for the delay of committing it
+const std::chrono::milliseconds IDLE_WAIT_TIME(10);
+}	 // namespace
+
+AsyncSourcetrailDBWriter::AsyncSourcetrailDBWriter(size_t queueCapacity, size_t recordsPerTransaction)
+	: m_queue(queueCapacity)
+	, m_recordsPerTransaction(recordsPerTransaction > 0 ? recordsPerTransaction : 1)
+	, m_stopRequested(false)
+	, m_consumerIdle(false)
+	, m_transactionOpen(false)
+	, m_recordsInTransaction(0)
+{
+}
+
+AsyncSourcetrailDBWriter::~AsyncSourcetrailDBWriter()
+{
+	if (m_consumerThread.joinable())
+	{
+		close();
+	}
+}
+
+bool AsyncSourcetrailDBWriter::open(const std::string& databaseFilePath)
+{
+	return open(databaseFilePath, getStorageOptions(StorageProfile::DEFAULT));
+}
+
+bool AsyncSourcetrailDBWriter::open(const std::string& databaseFilePath, const StorageOptions& storageOptions)
+{
+	if (m_consumerThread.joinable())
+	{
+		setLastError("Unable to open database, because a database is already open.");
+		return false;
+	}
+
+	if (!m_writer.open(databaseFilePath, storageOptions))
+	{
+		takeWriterError();
+		return false;
+	}
+
+	m_stopRequested.store(false);
+	m_consumerThread = std::thread(&AsyncSourcetrailDBWriter::runConsumer, this);
+	return true;
+}
+
+bool AsyncSourcetrailDBWriter::close()
+{
+	if (!m_consumerThread.joinable())
+	{
+		setLastError("Unable to close database, because no database is currently open.");
+		return false;
+	}
+
+	m_stopRequested.store(true, std::memory_order_release);
+	{
+		std::lock_guard<std::mutex> lock(m_idleMutex);
+		m_idleCondition.notify_one();
+	}
+	m_consumerThread.join();
+
+	m_writer.close();
+	takeWriterError();
+
+	return getLastError().empty();
+}
+
+bool AsyncSourcetrailDBWriter::flush()
+{
+	std::shared_ptr<std::promise<void>> flushed = std::make_shared<std::promise<void>>();
+	Request request = [this, flushed]() {
+		commitPendingTransaction();
+		flushed->set_value();
+	};
+
+	if (!enqueue(request))
+	{
+		return false;
+	}
+	flushed->get_future().wait();
+
+	return getLastError().empty();
+}
+
+std::string AsyncSourcetrailDBWriter::getLastError() const
+{
+	std::lock_guard<std::mutex> lock(m_errorMutex);
+	return m_lastError;
+}
+
+void AsyncSourcetrailDBWriter::clearLastError()
+{
+	std::lock_guard<std::mutex> lock(m_errorMutex);
+	m_lastError.clear();
+}
+
+std::future<int> AsyncSourcetrailDBWriter::recordSymbol(const NameHierarchy& nameHierarchy)
+{
+	return enqueueWithId([nameHierarchy](SourcetrailDBWriter& writer) { return writer.recordSymbol(nameHierarchy); });
+}
+
+void AsyncSourcetrailDBWriter::recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind)
+{
+	enqueueWithoutId(
+		[symbolId, definitionKind](SourcetrailDBWriter& writer) { return writer.recordSymbolDefinitionKind(symbolId, definitionKind); });
+}
+
+void AsyncSourcetrailDBWriter::recordSymbolKind(int symbolId, SymbolKind symbolKind)
+{
+	enqueueWithoutId([symbolId, symbolKind](SourcetrailDBWriter& writer) { return writer.recordSymbolKind(symbolId, symbolKind); });
+}
+
+void AsyncSourcetrailDBWriter::recordSymbolLocation(int symbolId, const SourceRange& location)
+{
+	enqueueWithoutId([symbolId, location](SourcetrailDBWriter& writer) { return writer.recordSymbolLocation(symbolId, location); });
+}
+
+void AsyncSourcetrailDBWriter::recordSymbolScopeLocation(int symbolId, const SourceRange& location)
+{
+	enqueueWithoutId([symbolId, location](SourcetrailDBWriter& writer) { return writer.recordSymbolScopeLocation(symbolId, location); });
+}
+
+void AsyncSourcetrailDBWriter::recordSymbolSignatureLocation(int symbolId, const SourceRange& location)
+{
+	enqueueWithoutId(
+		[symbolId, location](SourcetrailDBWriter& writer) { return writer.recordSymbolSignatureLocation(symbolId, location); });
+}
+
+std::future<int> AsyncSourcetrailDBWriter::recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+{
+	return enqueueWithId([contextSymbolId, referencedSymbolId, referenceKind](SourcetrailDBWriter& writer) {
+		return writer.recordReference(contextSymbolId, referencedSymbolId, referenceKind);
+	});
+}
+
+void AsyncSourcetrailDBWriter::recordReferenceLocation(int referenceId, const SourceRange& location)
+{
+	enqueueWithoutId([referenceId, location](SourcetrailDBWriter& writer) { return writer.recordReferenceLocation(referenceId, location); });
+}
+
+void AsyncSourcetrailDBWriter::recordReferenceIsAmbiguous(int referenceId)
+{
+	enqueueWithoutId([referenceId](SourcetrailDBWriter& writer) { return writer.recordReferenceIsAmbiguous(referenceId); });
+}
+
+std::future<int> AsyncSourcetrailDBWriter::recordReferenceToUnsolvedSymhol(
+	int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location)
+{
+	return enqueueWithId([contextSymbolId, referenceKind, location](SourcetrailDBWriter& writer) {
+		return writer.recordReferenceToUnsolvedSymhol(contextSymbolId, referenceKind, location);
+	});
+}
+
+void AsyncSourcetrailDBWriter::recordQualifierLocation(int referencedSymbolId, const SourceRange& location)
+{
+	enqueueWithoutId(
+		[referencedSymbolId, location](SourcetrailDBWriter& writer) { return writer.recordQualifierLocation(referencedSymbolId, location); });
+}
+
+std::future<int> AsyncSourcetrailDBWriter::recordFile(const std::string& filePath)
+{
+	return enqueueWithId([filePath](SourcetrailDBWriter& writer) { return writer.recordFile(filePath); });
+}
+
+void AsyncSourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& languageIdentifier)
+{
+	enqueueWithoutId(
+		[fileId, languageIdentifier](SourcetrailDBWriter& writer) { return writer.recordFileLanguage(fileId, languageIdentifier); });
+}
+
+std::future<int> AsyncSourcetrailDBWriter::recordLocalSymbol(const std::string& name)
+{
+	return enqueueWithId([name](SourcetrailDBWriter& writer) { return writer.recordLocalSymbol(name); });
+}
+
+void AsyncSourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const SourceRange& location)
+{
+	enqueueWithoutId(
+		[localSymbolId, location](SourcetrailDBWriter& writer) { return writer.recordLocalSymbolLocation(localSymbolId, location); });
+}
+
+void AsyncSourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange)
+{
+	enqueueWithoutId([sourceRange](SourcetrailDBWriter& writer) { return writer.recordAtomicSourceRange(sourceRange); });
+}
+
+void AsyncSourcetrailDBWriter::recordError(const std::string& message, bool fatal, const SourceRange& location)
+{
+	enqueueWithoutId([message, fatal, location](SourcetrailDBWriter& writer) { return writer.recordError(message, fatal, location); });
+}
+
+void AsyncSourcetrailDBWriter::recordTestMapping(int symbolId, int testSymbolId)
+{
+	enqueueWithoutId([symbolId, testSymbolId](SourcetrailDBWriter& writer) { return writer.recordTestMapping(symbolId, testSymbolId); });
+}
+
+bool AsyncSourcetrailDBWriter::enqueue(Request& request)
+{
+	if (!m_consumerThread.joinable())
+	{
+		setLastError("Unable to record data, because no database is currently open.");
+		return false;
+	}
+
+	// apply backpressure by waiting for the background thread while the queue is full
+	while (!m_queue.tryPush(request))
+	{
+		std::this_thread::yield();
+	}
+
+	if (m_consumerIdle.load(std::memory_order_acquire))
+	{
+		std::lock_guard<std::mutex> lock(m_idleMutex);
+		m_idleCondition.notify_one();
+	}
+	return true;
+}
+
+std::future<int> AsyncSourcetrailDBWriter::enqueueWithId(std::function<int(SourcetrailDBWriter&)> record)
+{
+	std::shared_ptr<std::promise<int>> id = std::make_shared<std::promise<int>>();
+	std::future<int> future = id->get_future();
+
+	Request request = [this, id, record]() { id->set_value(record(m_writer)); };
+	if (!enqueue(request))
+	{
+		id->set_value(0);
+	}
+	return future;
+}
+
+void AsyncSourcetrailDBWriter::enqueueWithoutId(std::function<bool(SourcetrailDBWriter&)> record)
+{
+	Request request = [this, record]() { record(m_writer); };
+	enqueue(request);
+}
+
+void AsyncSourcetrailDBWriter::runConsumer()
+{
+	Request request;
+	for (;;)
+	{
+		if (m_queue.tryPop(request))
+		{
+			execute(request);
+			continue;
+		}
+
+		if (m_stopRequested.load(std::memory_order_acquire))
+		{
+			// requests queued before the stop request are visible by now
+			if (m_queue.tryPop(request))
+			{
+				execute(request);
+				continue;
+			}
+			break;
+		}
+
+		{
+			std::unique_lock<std::mutex> lock(m_idleMutex);
+			m_consumerIdle.store(true, std::memory_order_release);
+			m_idleCondition.wait_for(lock, IDLE_WAIT_TIME);
+			m_consumerIdle.store(false, std::memory_order_release);
+		}
+
+		// commit once the producers pause, so that recorded data does not stay uncommitted
+		if (m_queue.tryPop(request))
+		{
+			execute(request);
+		}
+		else
+		{
+			commitPendingTransaction();
+		}
+	}
+
+	commitPendingTransaction();
+}
+
+void AsyncSourcetrailDBWriter::execute(Request& request)
+{
+	if (!m_transactionOpen)
+	{
+		m_writer.beginTransaction();
+		takeWriterError();
+		m_transactionOpen = true;
+		m_recordsInTransaction = 0;
+	}
+
+	request();
+	request = Request();
+	takeWriterError();
+
+	if (++m_recordsInTransaction >= m_recordsPerTransaction)
+	{
+		commitPendingTransaction();
+	}
+}
+
+void AsyncSourcetrailDBWriter::commitPendingTransaction()
+{
+	if (m_transactionOpen)
+	{
+		m_writer.commitTransaction();
+		takeWriterError();
+		m_transactionOpen = false;
+	}
+}
+
+void AsyncSourcetrailDBWriter::takeWriterError()
+{
+	if (!m_writer.getLastError().empty())
+	{
+		setLastError(m_writer.getLastError());
+		m_writer.clearLastError();
+	}
+}
+
+void AsyncSourcetrailDBWriter::setLastError(const std::string& error)
+{
+	std::lock_guard<std::mutex> lock(m_errorMutex);
+	if (m_lastError.empty())
+	{
+		m_lastError = error;
+	}
+}
+}	 // namespace sourcetrail
@@ -16,9 +16,14 @@
 
 #include "DatabaseStorage.h"
 
+#include <algorithm>
+#include <chrono>
+#include <iterator>
 #include <vector>
 #include <iostream>
+#include <limits>
 
+#include "MemoryMappedFile.h"
 #include "NodeKind.h"
 #include "SourcetrailException.h"
 #include "StorageFile.h"
@@ -27,6 +32,178 @@
 #include "utility.h"
 #include "version.h"
 
+namespace
+{
+// rows written by one multi-row INSERT statement, kept well below SQLite's default limit of 999 bound parameters
+const size_t MULTI_ROW_INSERT_SIZE = 64;
+
+// element ids reserved at once inside a transaction, the block size doubles with every reservation of a transaction
+const int MIN_ELEMENT_ID_BLOCK_SIZE = 16;
+const int MAX_ELEMENT_ID_BLOCK_SIZE = 4096;
+
+struct IndexDefinition
+{
+	const char* name;
+	const char* tableAndColumns;
+	// whether one of the find statements of the deduplicating add methods relies on this index
+	bool usedForDeduplication;
+	// whether that find statement is skipped while the id caches of DatabaseStorage are complete
+	bool coveredByIdCache;
+	// whether the index is only created by removeFile(), so that databases without removed files do not maintain it
+	bool createdForFileRemoval;
+};
+
+const IndexDefinition INDEX_DEFINITIONS[] = {
+	{"node_serialized_name_index", "node(serialized_name)", true, true, false},
+	{"edge_source_target_type_index", "edge(source_node_id, target_node_id, type)", true, true, false},
+	{"local_symbol_name_index", "local_symbol(name)", true, true, false},
+	{"source_location_all_data_index",
+	 "source_location(file_node_id, start_line, start_column, end_line, end_column, type)",
+	 true,
+	 true,
+	 false},
+	{"error_all_data_index", "error(message, fatal)", true, false, false},
+	// Indices for the content lookup of addFile() while file content deduplication is enabled
+	{"file_state_content_hash_index", "file_state(content_hash)", true, false, false},
+	{"filecontent_id_index", "filecontent(id)", true, false, false},
+	// Indices for the cascading deletes of removeFile()
+	{"filecontent_ref_content_file_id_index", "filecontent_ref(content_file_id)", false, false, false},
+	{"element_file_file_id_index", "element_file(file_id)", false, false, false},
+	{"element_component_element_id_index", "element_component(element_id)", false, false, false},
+	{"edge_target_node_index", "edge(target_node_id)", false, false, true},
+	{"occurrence_source_location_index", "occurrence(source_location_id)", false, false, true},
+	// Index for the file state lookup of isFileUpToDate()
+	{"file_path_index", "file(path)", false, false, false},
+	// Indices for tests mapping
+	{"tests_symbol_index", "tests(symbol_id)", false, false, false},
+	{"tests_test_symbol_index", "tests(test_symbol_id)", false, false, false},
+	// Indices for the symbol lookups by name of the reader
+	{"node_name_name_index", "node_name(name)", false, false, false},
+	{"node_name_name_lower_index", "node_name(name_lower)", false, false, false},
+};
+
+bool isIndexNeededForBulkLoad(const IndexDefinition& index, bool idCachesComplete)
+{
+	return index.usedForDeduplication && !(index.coveredByIdCache && idCachesComplete);
+}
+
+// Binds the string without copying it. The string has to stay alive until the statement has been executed and
+// reset, which holds for all arguments and members bound within one add or find method.
+void bindText(CppSQLite3Statement& statement, int parameterIndex, const std::string& text)
+{
+	statement.bindStatic(parameterIndex, text.c_str(), static_cast<int>(text.size()));
+}
+
+// adds the lifetime of the stopwatch to a millisecond counter, does nothing without a counter
+class ScopedStopwatch
+{
+public:
+	explicit ScopedStopwatch(double* milliseconds): m_milliseconds(milliseconds)
+	{
+		if (m_milliseconds)
+		{
+			m_startTime = std::chrono::steady_clock::now();
+		}
+	}
+
+	~ScopedStopwatch()
+	{
+		if (m_milliseconds)
+		{
+			*m_milliseconds +=
+				std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+		}
+	}
+
+private:
+	double* m_milliseconds;
+	std::chrono::steady_clock::time_point m_startTime;
+};
+
+// pages copied by one step of an online backup, the progress is reported after every step
+const int BACKUP_PAGES_PER_STEP = 1024;
+
+void reportBackupProgress(int remainingPages, int totalPages, void* progress)
+{
+	const std::function<void(int, int)>& callback = *static_cast<const std::function<void(int, int)>*>(progress);
+	callback(totalPages - remainingPages, totalPages);
+}
+
+// Meta key of the largest node id at the time every node has been known to have its node_name row
+const char* const NODE_NAMES_MARKER_KEY = "node_names_max_node_id";
+
+// Content of a file with normalized line endings. The mapped file is used as it is if its line endings are
+// normalized already. Only other files are copied.
+struct NormalizedFileContent
+{
+	std::unique_ptr<sourcetrail::MemoryMappedFile> mappedFile;
+	std::string normalizedContent;
+	const char* data = nullptr;
+	size_t size = 0;
+	int lineCount = 0;
+};
+
+void readNormalizedFileContent(const std::string& filePath, NormalizedFileContent& content)
+{
+	content.mappedFile.reset(new sourcetrail::MemoryMappedFile(filePath));
+	content.data = content.mappedFile->getData();
+	content.size = content.mappedFile->getSize();
+
+	size_t newlineCount = 0;
+	size_t carriageReturnCount = 0;
+	sourcetrail::utility::countLineBreaks(content.data, content.size, newlineCount, carriageReturnCount);
+	if (carriageReturnCount == 0 && (content.size == 0 || content.data[content.size - 1] == '\n'))
+	{
+		content.lineCount = static_cast<int>(newlineCount);
+	}
+	else
+	{
+		content.normalizedContent = sourcetrail::utility::getNormalizedFileContent(content.data, content.size);
+		content.data = content.normalizedContent.data();
+		content.size = content.normalizedContent.size();
+		content.lineCount = sourcetrail::utility::getLineCount(content.normalizedContent);
+	}
+
+	if (content.size > static_cast<size_t>(std::numeric_limits<int>::max()))
+	{
+		throw sourcetrail::SourcetrailException("Unable to store content of file \"" + filePath + "\", because it is too large.");
+	}
+}
+
+std::string getQuotedIdentifier(const std::string& identifier)
+{
+	std::string quoted = "\"";
+	for (char c: identifier)
+	{
+		quoted += c;
+		if (c == '"')
+		{
+			quoted += c;
+		}
+	}
+	return quoted + "\"";
+}
+
+std::string getMultiRowInsertStatement(const std::string& insertInto, const std::string& rowValues)
+{
+	std::string statement = insertInto;
+	for (size_t i = 0; i < MULTI_ROW_INSERT_SIZE; i++)
+	{
+		statement += (i == 0 ? " " : ", ") + rowValues;
+	}
+	return statement + ";";
+}
+
+int bindNodeName(CppSQLite3Statement& statement, int parameterIndex, const sourcetrail::StorageNodeName& nodeName)
+{
+	statement.bind(parameterIndex++, nodeName.id);
+	bindText(statement, parameterIndex++, nodeName.name);
+	bindText(statement, parameterIndex++, nodeName.nameLower);
+	statement.bind(parameterIndex++, nodeName.parentId);
+	return parameterIndex;
+}
+}	 // namespace
+
 namespace sourcetrail
 {
 // --- Public Interface ---
@@ -37,12 +214,18 @@ int DatabaseStorage::getSupportedDatabaseVersion()
 }
 
 std::unique_ptr<DatabaseStorage> DatabaseStorage::openDatabase(const std::string& dbFilePath)
+{
+	return openDatabase(dbFilePath, getStorageOptions(StorageProfile::DEFAULT));
+}
+
+std::unique_ptr<DatabaseStorage> DatabaseStorage::openDatabase(const std::string& dbFilePath, const StorageOptions& storageOptions)
 {
 	try
 	{
 		std::unique_ptr<DatabaseStorage> storage = std::unique_ptr<DatabaseStorage>(new DatabaseStorage());
 		storage->m_database.open(dbFilePath.c_str());
 		storage->executeStatement("PRAGMA foreign_keys=ON;");
+		storage->applyStorageOptions(storageOptions);
 		return std::move(storage);
 	}
 	catch (CppSQLite3Exception e)
@@ -53,6 +236,18 @@ std::unique_ptr<DatabaseStorage> DatabaseStorage::openDatabase(const std::string
 
 DatabaseStorage::~DatabaseStorage()
 {
+	if (m_nodeNamesMarkerOutdated && !isInTransaction())
+	{
+		try
+		{
+			updateNodeNamesMarker();
+		}
+		catch (...)
+		{
+			// without the marker the next connection checks the node names again
+		}
+	}
+
 	clearPrecompiledStatements();
 
 	m_database.close();
@@ -60,26 +255,40 @@ DatabaseStorage::~DatabaseStorage()
 
 void DatabaseStorage::setupDatabase()
 {
-	executeStatement("PRAGMA foreign_keys=ON;");
+	executeStatement(m_bulkLoading ? "PRAGMA foreign_keys=OFF;" : "PRAGMA foreign_keys=ON;");
 
 	if (!isCompatible())
 	{
 		throw SourcetrailException("Unable to setup database tables because database is not compatible.");
 	}
 
+	clearCaches(!hasCachedTableContent());
+
+	// a node_name table that setupTables() creates lacks the rows of all existing nodes, whatever the marker says
+	const bool hasNodeNameTable = getSchemaObjectType("node_name") == "table";
+
 	setupTables();
 
 	setupIndices();
 
 	setupPrecompiledStatements();
 
+	// databases of earlier versions lack the node_name table or the rows of nodes added by those versions
+	m_hasNodeNames = hasNodeNameTable ? -1 : 0;
+	addMissingNodeNames();
+
 	insertOrUpdateMetaValue("storage_version", std::to_string(getSupportedDatabaseVersion()));
+	insertOrUpdateMetaValue("storage_profile", storageProfileToString(m_storageProfile));
 }
 
 void DatabaseStorage::clearDatabase()
 {
 	executeStatement("PRAGMA foreign_keys=OFF;");
 
+	m_nextElementId = 0;
+	m_endElementId = 0;
+	m_elementIdBlockSize = 0;
+
 	clearPrecompiledStatements();
 
 	clearTables();
@@ -112,7 +321,8 @@ bool DatabaseStorage::isCompatible() const
 		return true;
 	}
 
-	return getLoadedDatabaseVersion() == getSupportedDatabaseVersion();
+	const int loadedDatabaseVersion = getLoadedDatabaseVersion();
+	return loadedDatabaseVersion == getSupportedDatabaseVersion();
 }
 
 int DatabaseStorage::getLoadedDatabaseVersion() const
@@ -130,6 +340,26 @@ int DatabaseStorage::getLoadedDatabaseVersion() const
 	return 0;
 }
 
+std::string DatabaseStorage::getLoadedStorageProfile() const
+{
+	if (!m_database.tableExists("meta"))
+	{
+		return "";
+	}
+
+	CppSQLite3Query q = executeQuery("SELECT value FROM meta WHERE key = 'storage_profile';");
+	if (!q.eof())
+	{
+		return q.getStringField(0, "");
+	}
+	return "";
+}
+
+bool DatabaseStorage::isInTransaction() const
+{
+	return !m_database.IsAutoCommitOn();
+}
+
 void DatabaseStorage::beginTransaction()
 {
 	executeStatement("BEGIN TRANSACTION;");
@@ -137,12 +367,92 @@ void DatabaseStorage::beginTransaction()
 
 void DatabaseStorage::commitTransaction()
 {
+	releaseElementIds();
+	m_savepointElementIdReservations.clear();
+
+	if (m_nodeNamesMarkerOutdated)
+	{
+		updateNodeNamesMarker();
+	}
+
 	executeStatement("COMMIT TRANSACTION;");
 }
 
 void DatabaseStorage::rollbackTransaction()
 {
 	executeStatement("ROLLBACK TRANSACTION;");
+
+	// the reserved element rows are gone as well
+	m_nextElementId = 0;
+	m_endElementId = 0;
+	m_elementIdBlockSize = 0;
+	m_savepointElementIdReservations.clear();
+
+	// ids handed out during the transaction are gone now, and there is no record of which ones those were
+	clearCaches(false);
+
+	if (m_bulkLoading)
+	{
+		// the find statements are back in use
+		setupIndices();
+	}
+}
+
+void DatabaseStorage::beginSavepoint(const std::string& name)
+{
+	const bool startsTransaction = !isInTransaction();
+	executeStatement("SAVEPOINT " + getQuotedIdentifier(name) + ";");
+	m_savepointElementIdReservations.push_back(ElementIdReservation {name, startsTransaction, m_nextElementId, m_endElementId});
+}
+
+void DatabaseStorage::releaseSavepoint(const std::string& name)
+{
+	std::vector<ElementIdReservation>::reverse_iterator it = std::find_if(
+		m_savepointElementIdReservations.rbegin(),
+		m_savepointElementIdReservations.rend(),
+		[&name](const ElementIdReservation& reservation) { return reservation.savepointName == name; });
+
+	if (it != m_savepointElementIdReservations.rend())
+	{
+		if (it->startsTransaction)
+		{
+			// releasing this savepoint commits the transaction
+			releaseElementIds();
+		}
+		m_savepointElementIdReservations.erase(std::prev(it.base()), m_savepointElementIdReservations.end());
+	}
+
+	executeStatement("RELEASE SAVEPOINT " + getQuotedIdentifier(name) + ";");
+}
+
+void DatabaseStorage::rollbackToSavepoint(const std::string& name)
+{
+	executeStatement("ROLLBACK TO SAVEPOINT " + getQuotedIdentifier(name) + ";");
+
+	std::vector<ElementIdReservation>::reverse_iterator it = std::find_if(
+		m_savepointElementIdReservations.rbegin(),
+		m_savepointElementIdReservations.rend(),
+		[&name](const ElementIdReservation& reservation) { return reservation.savepointName == name; });
+
+	if (it != m_savepointElementIdReservations.rend())
+	{
+		// the element rows reserved when the savepoint began are back, all later ones are gone
+		m_nextElementId = it->nextElementId;
+		m_endElementId = it->endElementId;
+		m_savepointElementIdReservations.erase(it.base(), m_savepointElementIdReservations.end());
+	}
+	else
+	{
+		m_nextElementId = 0;
+		m_endElementId = 0;
+	}
+
+	clearCaches(false);
+
+	if (m_bulkLoading)
+	{
+		setupIndices();
+	}
 }
 
 void DatabaseStorage::optimizeDatabaseMemory()
@@ -150,11 +460,220 @@ void DatabaseStorage::optimizeDatabaseMemory()
 	executeStatement("VACUUM;");
 }
 
+void DatabaseStorage::restoreJournalMode()
+{
+	if (m_walJournalMode)
+	{
+		// leaving WAL mode needs the only connection to the database, with other connections the mode stays
+		executeQuery("PRAGMA journal_mode=DELETE;");
+		m_walJournalMode = false;
+	}
+}
+
+void DatabaseStorage::beginBulkLoad()
+{
+	if (m_bulkLoading)
+	{
+		throw SourcetrailException("Unable to begin bulk load, because a bulk load is already in progress.");
+	}
+	if (isInTransaction())
+	{
+		throw SourcetrailException("Unable to begin bulk load, because a transaction is in progress.");
+	}
+
+	m_bulkLoading = true;
+
+	executeStatement("PRAGMA foreign_keys=OFF;");
+
+	for (const IndexDefinition& index: INDEX_DEFINITIONS)
+	{
+		if (!isIndexNeededForBulkLoad(index, m_cachesComplete))
+		{
+			executeStatement(std::string("DROP INDEX IF EXISTS ") + index.name + ";");
+		}
+	}
+}
+
+void DatabaseStorage::endBulkLoad()
+{
+	if (!m_bulkLoading)
+	{
+		throw SourcetrailException("Unable to end bulk load, because no bulk load is in progress.");
+	}
+	if (isInTransaction())
+	{
+		throw SourcetrailException("Unable to end bulk load, because a transaction is in progress.");
+	}
+
+	m_bulkLoading = false;
+
+	setupIndices();
+
+	executeStatement("PRAGMA foreign_keys=ON;");
+
+	int violationCount = 0;
+	std::string firstViolationTable;
+	{
+		CppSQLite3Query q = executeQuery("PRAGMA foreign_key_check;");
+		while (!q.eof())
+		{
+			if (violationCount++ == 0)
+			{
+				firstViolationTable = q.getStringField(0, "");
+			}
+			q.nextRow();
+		}
+	}
+
+	executeStatement("ANALYZE;");
+
+	if (violationCount > 0)
+	{
+		throw SourcetrailException(
+			"Bulk load finished with " + std::to_string(violationCount) +
+			" rows referencing missing elements, the first one in table \"" + firstViolationTable + "\".");
+	}
+}
+
+bool DatabaseStorage::isBulkLoading() const
+{
+	return m_bulkLoading;
+}
+
+void DatabaseStorage::mergeDatabase(const std::string& dbFilePath, int unknownNodeKind)
+{
+	if (isInTransaction())
+	{
+		throw SourcetrailException("Unable to merge database, because a transaction is in progress.");
+	}
+
+	// existing ids stay valid, but this instance did not write the merged rows
+	clearCaches(false);
+	if (m_bulkLoading)
+	{
+		setupIndices();
+	}
+
+	{
+		CppSQLite3Statement attachStatement = compileStatement("ATTACH DATABASE ? AS merge_source;");
+		bindText(attachStatement, 1, dbFilePath);
+		executeStatement(attachStatement);
+		attachStatement.finalize();
+	}
+
+	try
+	{
+		{
+			CppSQLite3Query q = executeQuery("SELECT value FROM merge_source.meta WHERE key = 'storage_version';");
+			const int sourceDatabaseVersion = q.eof() ? 0 : std::stoi(q.getStringField(0, "0"));
+			if (sourceDatabaseVersion != getSupportedDatabaseVersion())
+			{
+				throw SourcetrailException("Unable to merge database \"" + dbFilePath + "\", because it is not compatible.");
+			}
+		}
+
+		beginTransaction();
+		try
+		{
+			mergeAttachedDatabase(unknownNodeKind);
+			commitTransaction();
+		}
+		catch (...)
+		{
+			rollbackTransaction();
+			throw;
+		}
+	}
+	catch (...)
+	{
+		executeStatement("DROP TABLE IF EXISTS temp.merge_element_map;");
+		executeStatement("DROP TABLE IF EXISTS temp.merge_source_location_map;");
+		executeStatement("DETACH DATABASE merge_source;");
+		throw;
+	}
+
+	executeStatement("DETACH DATABASE merge_source;");
+}
+
+void DatabaseStorage::loadDatabase(const std::string& dbFilePath)
+{
+	try
+	{
+		CppSQLite3DB source;
+		source.open(dbFilePath.c_str());
+		source.backup(m_database, -1, nullptr, nullptr);
+		source.close();
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException("Unable to load database \"" + dbFilePath + "\" with message \"" + e.errorMessage() + "\".");
+	}
+}
+
+void DatabaseStorage::saveDatabase(const std::string& dbFilePath, const std::function<void(int, int)>& progress)
+{
+	if (isInTransaction())
+	{
+		throw SourcetrailException("Unable to save database, because a transaction is in progress.");
+	}
+
+	try
+	{
+		CppSQLite3DB target;
+		target.open(dbFilePath.c_str());
+		m_database.backup(
+			target,
+			BACKUP_PAGES_PER_STEP,
+			progress ? &reportBackupProgress : nullptr,
+			const_cast<std::function<void(int, int)>*>(&progress));
+		target.close();
+	}
+	catch (CppSQLite3Exception e)
+	{
+		throw SourcetrailException("Unable to save database \"" + dbFilePath + "\" with message \"" + e.errorMessage() + "\".");
+	}
+}
+
+int DatabaseStorage::getChangeCount() const
+{
+	return m_database.totalChanges();
+}
+
+void DatabaseStorage::setStatisticsEnabled(bool enabled)
+{
+	m_statisticsEnabled = enabled;
+}
+
+bool DatabaseStorage::isStatisticsEnabled() const
+{
+	return m_statisticsEnabled;
+}
+
+void DatabaseStorage::setFileContentDeduplicationEnabled(bool enabled)
+{
+	m_fileContentDeduplicationEnabled = enabled;
+}
+
+bool DatabaseStorage::isFileContentDeduplicationEnabled() const
+{
+	return m_fileContentDeduplicationEnabled;
+}
+
+StorageStatistics& DatabaseStorage::getStatistics()
+{
+	return m_statistics;
+}
+
+void DatabaseStorage::resetStatistics()
+{
+	m_statistics = StorageStatistics();
+}
+
 int DatabaseStorage::addElementComponent(const StorageElementComponentData& storageElementComponentData)
 {
 	m_insertElementComponentStatement.bind(1, storageElementComponentData.elementId);
 	m_insertElementComponentStatement.bind(2, storageElementComponentData.componentKind);
-	m_insertElementComponentStatement.bind(3, storageElementComponentData.data.c_str());
+	bindText(m_insertElementComponentStatement, 3, storageElementComponentData.data);
 	executeStatement(m_insertElementComponentStatement);
 	const int id = static_cast<int>(m_database.lastRowId());
 	m_insertElementComponentStatement.reset();
@@ -163,17 +682,13 @@ int DatabaseStorage::addElementComponent(const StorageElementComponentData& stor
 
 int DatabaseStorage::addNode(const StorageNodeData& storageNodeData)
 {
-	int id = 0;
+	return addNode(storageNodeData.nodeKind, storageNodeData.serializedName);
+}
 
-	{
-		m_findNodeStatement.bind(1, storageNodeData.serializedName.c_str());
-		CppSQLite3Query q = executeQuery(m_findNodeStatement);
-		if (!q.eof())
-		{
-			id = q.getIntField(0, 0);
-		}
-		m_findNodeStatement.reset();
-	}
+int DatabaseStorage::addNode(int nodeKind, const std::string& serializedName)
+{
+	int id = findNodeId(serializedName);
+	countOperation(m_statistics.nodes, id == 0 ? 1 : 0);
 
 	// FIXME: update node nodeKind here
 
@@ -182,10 +697,18 @@ int DatabaseStorage::addNode(const StorageNodeData& storageNodeData)
 		id = insertElement();
 
 		m_insertNodeStatement.bind(1, id);
-		m_insertNodeStatement.bind(2, storageNodeData.nodeKind);
-		m_insertNodeStatement.bind(3, storageNodeData.serializedName.c_str());
+		m_insertNodeStatement.bind(2, nodeKind);
+		bindText(m_insertNodeStatement, 3, serializedName);
 		executeStatement(m_insertNodeStatement);
 		m_insertNodeStatement.reset();
+
+		m_nodeIdCache.emplace(serializedName, id);
+
+		const StorageNodeName nodeName = getNodeName(id, serializedName);
+		m_nodeNamesMarkerOutdated = true;
+		bindNodeName(m_insertNodeNameStatement, 1, nodeName);
+		executeStatement(m_insertNodeNameStatement);
+		m_insertNodeNameStatement.reset();
 	}
 	return id;
 }
@@ -198,63 +721,167 @@ void DatabaseStorage::addSymbol(const StorageSymbol& storageSymbol)
 	m_insertSymbolStatement.reset();
 }
 
-void DatabaseStorage::addFile(const StorageFile& storageFile)
+size_t DatabaseStorage::addFile(const StorageFile& storageFile)
 {
 	{
 		m_findFileStatement.bind(1, storageFile.id);
 		CppSQLite3Query q = executeQuery(m_findFileStatement);
 		bool exists = !q.eof();
 		m_findFileStatement.reset();
+		countOperation(m_statistics.files, exists ? 0 : 1);
 		if (exists)
 		{
-			return;
+			return 0;
 		}
 	}
 
-	std::string content = "";
-	if (utility::getFileExists(storageFile.filePath))
+	const utility::FileStatus fileStatus = utility::getFileStatus(storageFile.filePath);
+	NormalizedFileContent fileContent;
+	if (fileStatus.exists)
 	{
-		content = utility::getFileContent(storageFile.filePath);
+		readNormalizedFileContent(storageFile.filePath, fileContent);
 	}
-	const int lineCount = utility::getLineCount(content);
+	const char* content = fileContent.data;
+	const size_t contentSize = fileContent.size;
 
 	{
 		m_insertFileStatement.bind(1, storageFile.id);
-		m_insertFileStatement.bind(2, storageFile.filePath.c_str());
-		m_insertFileStatement.bind(3, storageFile.languageIdentifier.c_str());
-		m_insertFileStatement.bind(4, storageFile.modificationTime.c_str());
+		bindText(m_insertFileStatement, 2, storageFile.filePath);
+		bindText(m_insertFileStatement, 3, storageFile.languageIdentifier);
+		bindText(m_insertFileStatement, 4, storageFile.modificationTime);
 		m_insertFileStatement.bind(5, storageFile.indexed);
 		m_insertFileStatement.bind(6, storageFile.complete);
-		m_insertFileStatement.bind(7, lineCount);
+		m_insertFileStatement.bind(7, fileContent.lineCount);
 		executeStatement(m_insertFileStatement);
 		m_insertFileStatement.reset();
 	}
 
-	if (!content.empty())
+	const std::string hash = utility::getContentHash(content, contentSize);
+
+	if (fileStatus.exists)
+	{
+		m_insertFileStateStatement.bind(1, storageFile.id);
+		m_insertFileStateStatement.bind(2, static_cast<sqlite_int64>(fileStatus.size));
+		m_insertFileStateStatement.bind(3, static_cast<sqlite_int64>(fileStatus.modificationTime));
+		m_insertFileStateStatement.bind(4, static_cast<sqlite_int64>(time(0)));
+		m_insertFileStateStatement.bind(5, reinterpret_cast<const unsigned char*>(hash.data()), static_cast<int>(hash.size()));
+		executeStatement(m_insertFileStateStatement);
+		m_insertFileStateStatement.reset();
+	}
+
+	if (contentSize == 0)
 	{
-		m_insertFileContentStatement.bind(1, storageFile.id);
-		m_insertFileContentStatement.bind(2, content.c_str());
-		executeStatement(m_insertFileContentStatement);
-		m_insertFileContentStatement.reset();
+		return 0;
 	}
+	return addFileContent(storageFile.id, hash, content, contentSize);
 }
 
-int DatabaseStorage::addEdge(const StorageEdgeData& storageEdgeData)
+size_t DatabaseStorage::addFileContent(int fileId, const std::string& hash, const char* content, size_t contentSize)
 {
-	int id = 0;
-
+	if (m_fileContentDeduplicationEnabled)
 	{
-		m_findEdgeStatement.bind(1, storageEdgeData.sourceNodeId);
-		m_findEdgeStatement.bind(2, storageEdgeData.targetNodeId);
-		m_findEdgeStatement.bind(3, storageEdgeData.edgeKind);
-		CppSQLite3Query q = executeQuery(m_findEdgeStatement);
-		if (!q.eof())
+		// the hash only narrows the search, contents with colliding hashes are told apart by their bytes
+		int contentFileId = 0;
 		{
-			id = q.getIntField(0, 0);
+			m_findFileContentStatement.bind(1, reinterpret_cast<const unsigned char*>(hash.data()), static_cast<int>(hash.size()));
+			m_findFileContentStatement.bindStatic(2, content, static_cast<int>(contentSize));
+			CppSQLite3Query q = executeQuery(m_findFileContentStatement);
+			if (!q.eof())
+			{
+				contentFileId = q.getIntField(0, 0);
+			}
+			m_findFileContentStatement.reset();
+			m_findFileContentStatement.bindNull(2);
+		}
+		countLookup(m_statistics.fileContentLookups, contentFileId ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
+
+		if (contentFileId != 0)
+		{
+			m_insertFileContentRefStatement.bind(1, fileId);
+			m_insertFileContentRefStatement.bind(2, contentFileId);
+			executeStatement(m_insertFileContentRefStatement);
+			m_insertFileContentRefStatement.reset();
+			return 0;
 		}
-		m_findEdgeStatement.reset();
 	}
 
+	m_insertFileContentStatement.bind(1, fileId);
+	m_insertFileContentStatement.bindStatic(2, content, static_cast<int>(contentSize));
+	executeStatement(m_insertFileContentStatement);
+	m_insertFileContentStatement.reset();
+	m_insertFileContentStatement.bindNull(2);
+	if (m_statisticsEnabled)
+	{
+		m_statistics.fileContentBytes += contentSize;
+	}
+	return contentSize;
+}
+
+void DatabaseStorage::moveReferencedFileContent(int fileId)
+{
+	// the content is handed over to the first of the files that refer to it, the others then refer to that file
+	const std::string id = std::to_string(fileId);
+	int newContentFileId = 0;
+	{
+		CppSQLite3Query q = executeQuery("SELECT MIN(file_id) FROM filecontent_ref WHERE content_file_id = " + id + ";");
+		newContentFileId = q.eof() ? 0 : q.getIntField(0, 0);
+	}
+	if (newContentFileId == 0)
+	{
+		return;
+	}
+
+	const std::string newId = std::to_string(newContentFileId);
+	executeStatement("DELETE FROM filecontent_ref WHERE file_id = " + newId + ";");
+	executeStatement("UPDATE filecontent SET id = " + newId + " WHERE id = " + id + ";");
+	executeStatement("UPDATE filecontent_ref SET content_file_id = " + newId + " WHERE content_file_id = " + id + ";");
+}
+
+bool DatabaseStorage::isFileUpToDate(const std::string& filePath)
+{
+	bool recorded = false;
+	long long recordedSize = 0;
+	long long recordedModificationTime = 0;
+	long long recordingTime = 0;
+	std::string recordedHash;
+	{
+		bindText(m_findFileStateStatement, 1, filePath);
+		CppSQLite3Query q = executeQuery(m_findFileStateStatement);
+		if (!q.eof())
+		{
+			recorded = true;
+			recordedSize = q.getInt64Field(0, 0);
+			recordedModificationTime = q.getInt64Field(1, 0);
+			recordingTime = q.getInt64Field(2, 0);
+			int hashSize = 0;
+			const unsigned char* hash = q.getBlobField(3, hashSize);
+			recordedHash.assign(reinterpret_cast<const char*>(hash), hashSize);
+		}
+		m_findFileStateStatement.reset();
+	}
+
+	const utility::FileStatus fileStatus = utility::getFileStatus(filePath);
+	if (!recorded || !fileStatus.exists || fileStatus.size != recordedSize)
+	{
+		return false;
+	}
+	// A file that was modified within the second it has been recorded may have changed again without a visible
+	// change of its modification time. Like touched files, these are compared by content.
+	if (fileStatus.modificationTime == recordedModificationTime && recordedModificationTime < recordingTime)
+	{
+		return true;
+	}
+
+	NormalizedFileContent fileContent;
+	readNormalizedFileContent(filePath, fileContent);
+	return utility::getContentHash(fileContent.data, fileContent.size) == recordedHash;
+}
+
+int DatabaseStorage::addEdge(const StorageEdgeData& storageEdgeData)
+{
+	int id = findEdgeId(storageEdgeData);
+	countOperation(m_statistics.edges, id == 0 ? 1 : 0);
+
 	if (id == 0)
 	{
 		id = insertElement();
@@ -265,16 +892,32 @@ int DatabaseStorage::addEdge(const StorageEdgeData& storageEdgeData)
 		m_insertEdgeStatement.bind(4, storageEdgeData.targetNodeId);
 		executeStatement(m_insertEdgeStatement);
 		m_insertEdgeStatement.reset();
+
+		m_edgeIdCache.emplace(EdgeKey(storageEdgeData), id);
 	}
 	return id;
 }
 
 int DatabaseStorage::addLocalSymbol(const StorageLocalSymbolData& storageLocalSymbolData)
 {
+	return addLocalSymbol(storageLocalSymbolData.name);
+}
+
+int DatabaseStorage::addLocalSymbol(const std::string& name)
+{
+	std::unordered_map<std::string, int>::const_iterator it = m_localSymbolIdCache.find(name);
+	if (it != m_localSymbolIdCache.end())
+	{
+		countOperation(m_statistics.localSymbols, 0);
+		countLookup(m_statistics.localSymbolLookups, &LookupStatistics::cacheHits);
+		return it->second;
+	}
+
 	int id = 0;
 
+	if (!m_cachesComplete)
 	{
-		m_findLocalSymbolStmt.bind(1, storageLocalSymbolData.name.c_str());
+		bindText(m_findLocalSymbolStmt, 1, name);
 		CppSQLite3Query q = executeQuery(m_findLocalSymbolStmt);
 		if (!q.eof())
 		{
@@ -283,36 +926,27 @@ int DatabaseStorage::addLocalSymbol(const StorageLocalSymbolData& storageLocalSy
 		m_findLocalSymbolStmt.reset();
 	}
 
+	countOperation(m_statistics.localSymbols, id == 0 ? 1 : 0);
+	countLookup(m_statistics.localSymbolLookups, id ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
+
 	if (id == 0)
 	{
 		id = insertElement();
 
 		m_insertLocalSymbolStmt.bind(1, id);
-		m_insertLocalSymbolStmt.bind(2, storageLocalSymbolData.name.c_str());
+		bindText(m_insertLocalSymbolStmt, 2, name);
 		executeStatement(m_insertLocalSymbolStmt);
 		m_insertLocalSymbolStmt.reset();
 	}
+
+	m_localSymbolIdCache.emplace(name, id);
 	return id;
 }
 
 int DatabaseStorage::addSourceLocation(const StorageSourceLocationData& storageSourceLocationData)
 {
-	int id = 0;
-
-	{
-		m_findSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
-		m_findSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
-		m_findSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
-		m_findSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
-		m_findSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
-		m_findSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
-		CppSQLite3Query q = executeQuery(m_findSourceLocationStmt);
-		if (!q.eof())
-		{
-			id = q.getIntField(0, 0);
-		}
-		m_findSourceLocationStmt.reset();
-	}
+	int id = findSourceLocationId(storageSourceLocationData);
+	countOperation(m_statistics.sourceLocations, id == 0 ? 1 : 0);
 
 	if (id == 0)
 	{
@@ -325,12 +959,15 @@ int DatabaseStorage::addSourceLocation(const StorageSourceLocationData& storageS
 		executeStatement(m_insertSourceLocationStmt);
 		id = static_cast<int>(m_database.lastRowId());
 		m_insertSourceLocationStmt.reset();
+
+		m_sourceLocationIdCache.emplace(SourceLocationKey(storageSourceLocationData), id);
 	}
 	return id;
 }
 
 void DatabaseStorage::addOccurrence(const StorageOccurrence& storageOccurrence)
 {
+	countOperation(m_statistics.occurrences, 1);
 	m_insertOccurenceStmt.bind(1, storageOccurrence.elementId);
 	m_insertOccurenceStmt.bind(2, storageOccurrence.sourceLocationId);
 	executeStatement(m_insertOccurenceStmt);
@@ -338,11 +975,16 @@ void DatabaseStorage::addOccurrence(const StorageOccurrence& storageOccurrence)
 }
 
 int DatabaseStorage::addError(const StorageErrorData& storageErrorData)
+{
+	return addError(storageErrorData.message, storageErrorData.translationUnit, storageErrorData.fatal, storageErrorData.indexed);
+}
+
+int DatabaseStorage::addError(const std::string& message, const std::string& translationUnit, bool fatal, bool indexed)
 {
 	int id = 0;
 	{
-		m_findErrorStatement.bind(1, storageErrorData.message.c_str());
-		m_findErrorStatement.bind(2, storageErrorData.fatal);
+		bindText(m_findErrorStatement, 1, message);
+		m_findErrorStatement.bind(2, fatal);
 		CppSQLite3Query q = executeQuery(m_findErrorStatement);
 		if (!q.eof() && q.numFields() > 0)
 		{
@@ -350,16 +992,18 @@ int DatabaseStorage::addError(const StorageErrorData& storageErrorData)
 		}
 		m_findErrorStatement.reset();
 	}
+	countOperation(m_statistics.errors, id == 0 ? 1 : 0);
+	countLookup(m_statistics.errorLookups, id ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
 
 	if (id == 0)
 	{
 		id = insertElement();
 
 		m_insertErrorStatement.bind(1, id);
-		m_insertErrorStatement.bind(2, storageErrorData.message.c_str());
-		m_insertErrorStatement.bind(3, storageErrorData.fatal);
-		m_insertErrorStatement.bind(4, storageErrorData.indexed);
-		m_insertErrorStatement.bind(5, storageErrorData.translationUnit.c_str());
+		bindText(m_insertErrorStatement, 2, message);
+		m_insertErrorStatement.bind(3, fatal);
+		m_insertErrorStatement.bind(4, indexed);
+		bindText(m_insertErrorStatement, 5, translationUnit);
 		executeStatement(m_insertErrorStatement);
 		id = static_cast<int>(m_database.lastRowId());
 		m_insertErrorStatement.reset();
@@ -367,6 +1011,171 @@ int DatabaseStorage::addError(const StorageErrorData& storageErrorData)
 	return id;
 }
 
+std::vector<int> DatabaseStorage::addNodes(const std::vector<StorageNodeData>& storageNodeData)
+{
+	std::vector<int> ids(storageNodeData.size(), 0);
+	std::vector<StorageNode> newNodes;
+
+	try
+	{
+		for (size_t i = 0; i < storageNodeData.size(); i++)
+		{
+			ids[i] = findNodeId(storageNodeData[i].serializedName);
+			if (ids[i] == 0)
+			{
+				ids[i] = insertElement();
+				newNodes.emplace_back(StorageNode(ids[i], storageNodeData[i]));
+				m_nodeIdCache.emplace(storageNodeData[i].serializedName, ids[i]);
+			}
+		}
+		countOperation(m_statistics.nodes, newNodes.size());
+
+		insertRows(
+			newNodes,
+			m_insertNodesStatement,
+			m_insertNodeStatement,
+			[](CppSQLite3Statement& statement, int parameterIndex, const StorageNode& node) {
+				statement.bind(parameterIndex++, node.id);
+				statement.bind(parameterIndex++, node.nodeKind);
+				bindText(statement, parameterIndex++, node.serializedName);
+				return parameterIndex;
+			},
+			[](size_t, size_t) {});
+
+		addNodeNames(newNodes);
+		m_nodeNamesMarkerOutdated = m_nodeNamesMarkerOutdated || !newNodes.empty();
+	}
+	catch (...)
+	{
+		// the caches may already know ids of rows that have not been written
+		clearCaches(false);
+		throw;
+	}
+
+	return ids;
+}
+
+std::vector<int> DatabaseStorage::addEdges(const std::vector<StorageEdgeData>& storageEdgeData)
+{
+	std::vector<int> ids(storageEdgeData.size(), 0);
+	std::vector<StorageEdge> newEdges;
+
+	try
+	{
+		for (size_t i = 0; i < storageEdgeData.size(); i++)
+		{
+			ids[i] = findEdgeId(storageEdgeData[i]);
+			if (ids[i] == 0)
+			{
+				ids[i] = insertElement();
+				newEdges.emplace_back(StorageEdge(ids[i], storageEdgeData[i]));
+				m_edgeIdCache.emplace(EdgeKey(storageEdgeData[i]), ids[i]);
+			}
+		}
+		countOperation(m_statistics.edges, newEdges.size());
+
+		insertRows(
+			newEdges,
+			m_insertEdgesStatement,
+			m_insertEdgeStatement,
+			[](CppSQLite3Statement& statement, int parameterIndex, const StorageEdge& edge) {
+				statement.bind(parameterIndex++, edge.id);
+				statement.bind(parameterIndex++, edge.edgeKind);
+				statement.bind(parameterIndex++, edge.sourceNodeId);
+				statement.bind(parameterIndex++, edge.targetNodeId);
+				return parameterIndex;
+			},
+			[](size_t, size_t) {});
+	}
+	catch (...)
+	{
+		// the caches may already know ids of rows that have not been written
+		clearCaches(false);
+		throw;
+	}
+
+	return ids;
+}
+
+std::vector<int> DatabaseStorage::addSourceLocations(const std::vector<StorageSourceLocationData>& storageSourceLocationData)
+{
+	std::vector<int> ids(storageSourceLocationData.size(), 0);
+
+	// source location ids are assigned by SQLite, so new locations get their ids after insertion
+	std::vector<StorageSourceLocationData> newSourceLocations;
+	std::vector<size_t> newSourceLocationIndices(storageSourceLocationData.size(), 0);
+	std::unordered_map<SourceLocationKey, size_t, SourceLocationKeyHash> newSourceLocationIndicesByKey;
+
+	for (size_t i = 0; i < storageSourceLocationData.size(); i++)
+	{
+		ids[i] = findSourceLocationId(storageSourceLocationData[i]);
+		if (ids[i] == 0)
+		{
+			std::pair<std::unordered_map<SourceLocationKey, size_t, SourceLocationKeyHash>::iterator, bool> inserted =
+				newSourceLocationIndicesByKey.emplace(SourceLocationKey(storageSourceLocationData[i]), newSourceLocations.size());
+			if (inserted.second)
+			{
+				newSourceLocations.push_back(storageSourceLocationData[i]);
+			}
+			newSourceLocationIndices[i] = inserted.first->second;
+		}
+	}
+
+	countOperation(m_statistics.sourceLocations, newSourceLocations.size());
+
+	std::vector<int> newIds(newSourceLocations.size(), 0);
+
+	insertRows(
+		newSourceLocations,
+		m_insertSourceLocationsStmt,
+		m_insertSourceLocationStmt,
+		[](CppSQLite3Statement& statement, int parameterIndex, const StorageSourceLocationData& sourceLocation) {
+			statement.bind(parameterIndex++, sourceLocation.fileNodeId);
+			statement.bind(parameterIndex++, sourceLocation.startLineNumber);
+			statement.bind(parameterIndex++, sourceLocation.startColumnNumber);
+			statement.bind(parameterIndex++, sourceLocation.endLineNumber);
+			statement.bind(parameterIndex++, sourceLocation.endColumnNumber);
+			statement.bind(parameterIndex++, sourceLocation.locationKind);
+			return parameterIndex;
+		},
+		[&](size_t firstRow, size_t rowCount) {
+			// SQLite assigns one more than the largest existing rowid to each row of a multi-row insert, so the rows
+			// of one statement receive consecutive ids ending at the last inserted rowid.
+			const int lastId = static_cast<int>(m_database.lastRowId());
+			for (size_t i = 0; i < rowCount; i++)
+			{
+				newIds[firstRow + i] = lastId - static_cast<int>(rowCount - 1 - i);
+				m_sourceLocationIdCache.emplace(SourceLocationKey(newSourceLocations[firstRow + i]), newIds[firstRow + i]);
+			}
+		});
+
+	for (size_t i = 0; i < ids.size(); i++)
+	{
+		if (ids[i] == 0)
+		{
+			ids[i] = newIds[newSourceLocationIndices[i]];
+		}
+	}
+
+	return ids;
+}
+
+void DatabaseStorage::addOccurrences(const std::vector<StorageOccurrence>& storageOccurrences)
+{
+	countOperation(m_statistics.occurrences, storageOccurrences.size());
+
+	insertRows(
+		storageOccurrences,
+		m_insertOccurrencesStmt,
+		m_insertOccurenceStmt,
+		[](CppSQLite3Statement& statement, int parameterIndex, const StorageOccurrence& occurrence) {
+			statement.bind(parameterIndex++, occurrence.elementId);
+			statement.bind(parameterIndex++, occurrence.sourceLocationId);
+			return parameterIndex;
+		},
+		[](size_t, size_t) {});
+}
+
 void DatabaseStorage::setNodeType(int nodeId, int nodeType)
 {
 	m_setNodeTypeStmt.bind(1, nodeType);
@@ -377,7 +1186,7 @@ void DatabaseStorage::setNodeType(int nodeId, int nodeType)
 
 void DatabaseStorage::setFileLanguage(int fileId, const std::string& languageIdentifier)
 {
-	m_setFileLanguageStmt.bind(1, languageIdentifier.c_str());
+	bindText(m_setFileLanguageStmt, 1, languageIdentifier);
 	m_setFileLanguageStmt.bind(2, fileId);
 	executeStatement(m_setFileLanguageStmt);
 	m_setFileLanguageStmt.reset();
@@ -385,6 +1194,38 @@ void DatabaseStorage::setFileLanguage(int fileId, const std::string& languageIde
 
 // --- Private Interface ---
 
+void DatabaseStorage::applyStorageOptions(const StorageOptions& storageOptions)
+{
+	m_storageProfile = storageOptions.profile;
+
+	if (!storageOptions.journalMode.empty())
+	{
+		CppSQLite3Query q = executeQuery("PRAGMA journal_mode=" + storageOptions.journalMode + ";");
+		m_walJournalMode = utility::toLowerCase(q.getStringField(0, "")) == "wal";
+	}
+	if (!storageOptions.synchronous.empty())
+	{
+		executeStatement("PRAGMA synchronous=" + storageOptions.synchronous + ";");
+	}
+	if (storageOptions.cacheSizeKiB > 0)
+	{
+		// negative values are interpreted as KiB instead of pages
+		executeStatement("PRAGMA cache_size=-" + std::to_string(storageOptions.cacheSizeKiB) + ";");
+	}
+	if (storageOptions.mmapSizeBytes > 0)
+	{
+		executeStatement("PRAGMA mmap_size=" + std::to_string(storageOptions.mmapSizeBytes) + ";");
+	}
+	if (storageOptions.tempStoreInMemory)
+	{
+		executeStatement("PRAGMA temp_store=MEMORY;");
+	}
+	if (storageOptions.queryOnly)
+	{
+		executeStatement("PRAGMA query_only=ON;");
+	}
+}
+
 void DatabaseStorage::setupTables()
 {
 	executeStatement(
@@ -432,6 +1273,17 @@ void DatabaseStorage::setupTables()
 		"	FOREIGN KEY(id) REFERENCES element(id) ON DELETE CASCADE"
 		");");
 
+	// name of the last name element of every node, parent_id is 0 for nodes without parent
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS node_name("
+		"	id INTEGER NOT NULL, "
+		"	name TEXT NOT NULL, "
+		"	name_lower TEXT NOT NULL, "
+		"	parent_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(id), "
+		"	FOREIGN KEY(id) REFERENCES node(id) ON DELETE CASCADE"
+		");");
+
 	executeStatement(
 		"CREATE TABLE IF NOT EXISTS symbol("
 		"	id INTEGER NOT NULL, "
@@ -462,6 +1314,16 @@ void DatabaseStorage::setupTables()
 		"	ON UPDATE CASCADE"
 		");");
 
+	// While file content deduplication is enabled, a file whose content equals the one of another file refers to that
+	// file's filecontent row instead of getting a row of its own.
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS filecontent_ref("
+		"	file_id INTEGER NOT NULL, "
+		"	content_file_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(file_id), "
+		"	FOREIGN KEY(file_id) REFERENCES file(id) ON DELETE CASCADE ON UPDATE CASCADE"
+		");");
+
 	executeStatement(
 		"CREATE TABLE IF NOT EXISTS local_symbol("
 		"	id INTEGER NOT NULL, "
@@ -511,6 +1373,26 @@ void DatabaseStorage::setupTables()
 		"	FOREIGN KEY(id) REFERENCES element(id) ON DELETE CASCADE"
 		");");
 
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS file_state("
+		"	file_id INTEGER NOT NULL, "
+		"	size INTEGER NOT NULL, "
+		"	modification_time INTEGER NOT NULL, "
+		"	recording_time INTEGER NOT NULL, "
+		"	content_hash BLOB NOT NULL, "
+		"	PRIMARY KEY(file_id), "
+		"	FOREIGN KEY(file_id) REFERENCES file(id) ON DELETE CASCADE"
+		");");
+
+	executeStatement(
+		"CREATE TABLE IF NOT EXISTS element_file("
+		"	element_id INTEGER NOT NULL, "
+		"	file_id INTEGER NOT NULL, "
+		"	PRIMARY KEY(element_id, file_id), "
+		"	FOREIGN KEY(element_id) REFERENCES element(id) ON DELETE CASCADE, "
+		"	FOREIGN KEY(file_id) REFERENCES node(id) ON DELETE CASCADE"
+		");");
+
 	executeStatement(
 		"CREATE TABLE IF NOT EXISTS tests("
 		"	symbol_id INTEGER NOT NULL, "
@@ -525,14 +1407,18 @@ void DatabaseStorage::clearTables()
 {
 	const std::vector<std::string> tableNames = {
 		"meta",
+		"element_file",
+		"file_state",
 		"error",
 		"component_access",
 		"occurrence",
 		"source_location",
 		"local_symbol",
 		"filecontent",
+		"filecontent_ref",
 		"file",
 		"symbol",
+		"node_name",
 		"node",
 		"edge",
 		"element_component",
@@ -547,27 +1433,37 @@ void DatabaseStorage::clearTables()
 
 void DatabaseStorage::setupIndices()
 {
-	executeStatement("CREATE INDEX IF NOT EXISTS node_serialized_name_index ON node(serialized_name);");
-
-	executeStatement("CREATE INDEX IF NOT EXISTS edge_source_target_type_index ON edge(source_node_id, target_node_id, type);");
-
-	executeStatement("CREATE INDEX IF NOT EXISTS local_symbol_name_index ON local_symbol(name);");
-
-	executeStatement(
-		"CREATE INDEX IF NOT EXISTS source_location_all_data_index "
-		"ON source_location(file_node_id, start_line, start_column, end_line, end_column, type);");
-
-	executeStatement("CREATE INDEX IF NOT EXISTS error_all_data_index ON error(message, fatal);");
+	for (const IndexDefinition& index: INDEX_DEFINITIONS)
+	{
+		if (!index.createdForFileRemoval && (!m_bulkLoading || isIndexNeededForBulkLoad(index, m_cachesComplete)))
+		{
+			executeStatement(std::string("CREATE INDEX IF NOT EXISTS ") + index.name + " ON " + index.tableAndColumns + ";");
+		}
+	}
+}
 
-	// Indices for tests mapping
-	executeStatement("CREATE INDEX IF NOT EXISTS tests_symbol_index ON tests(symbol_id);");
-	executeStatement("CREATE INDEX IF NOT EXISTS tests_test_symbol_index ON tests(test_symbol_id);");
+void DatabaseStorage::setupFileRemovalIndices()
+{
+	for (const IndexDefinition& index: INDEX_DEFINITIONS)
+	{
+		if (index.createdForFileRemoval)
+		{
+			executeStatement(std::string("CREATE INDEX IF NOT EXISTS ") + index.name + " ON " + index.tableAndColumns + ";");
+		}
+	}
 }
 
 void DatabaseStorage::setupPrecompiledStatements()
 {
 	m_insertElementStatement = compileStatement("INSERT INTO element(id) VALUES(NULL);");
 
+	m_insertElementRangeStatement = compileStatement(
+		"INSERT INTO element(id) "
+		"WITH RECURSIVE reserved(id) AS (SELECT ? UNION ALL SELECT id + 1 FROM reserved WHERE id < ?) "
+		"SELECT id FROM reserved;");
+
+	m_deleteElementRangeStatement = compileStatement("DELETE FROM element WHERE id >= ? AND id < ?;");
+
 	m_insertElementComponentStatement = compileStatement(
 		"INSERT INTO element_component(id, element_id, type, data) VALUES(NULL, ?, ?, ?);");
 
@@ -575,6 +1471,8 @@ void DatabaseStorage::setupPrecompiledStatements()
 
 	m_insertNodeStatement = compileStatement("INSERT INTO node(id, type, serialized_name) VALUES(?, ?, ?);");
 
+	m_insertNodeNameStatement = compileStatement("INSERT INTO node_name(id, name, name_lower, parent_id) VALUES(?, ?, ?, ?);");
+
 	m_setNodeTypeStmt = compileStatement("UPDATE node SET type = ? WHERE id == ?;");
 
 	m_insertSymbolStatement = compileStatement("INSERT OR IGNORE INTO symbol(id, definition_kind) VALUES(?, ?);");
@@ -588,6 +1486,20 @@ void DatabaseStorage::setupPrecompiledStatements()
 
 	m_insertFileContentStatement = compileStatement("INSERT INTO filecontent(id, content) VALUES(?, ?);");
 
+	m_findFileContentStatement = compileStatement(
+		"SELECT filecontent.id FROM file_state INNER JOIN filecontent ON filecontent.id == file_state.file_id "
+		"WHERE file_state.content_hash == ? AND filecontent.content == ? LIMIT 1;");
+
+	m_insertFileContentRefStatement = compileStatement("INSERT OR REPLACE INTO filecontent_ref(file_id, content_file_id) VALUES(?, ?);");
+
+	m_insertFileStateStatement = compileStatement(
+		"INSERT OR REPLACE INTO file_state(file_id, size, modification_time, recording_time, content_hash) "
+		"VALUES(?, ?, ?, ?, ?);");
+
+	m_findFileStateStatement = compileStatement(
+		"SELECT file_state.size, file_state.modification_time, file_state.recording_time, file_state.content_hash FROM file "
+		"INNER JOIN file_state ON file_state.file_id = file.id WHERE file.path == ? LIMIT 1;");
+
 	m_findEdgeStatement = compileStatement("SELECT id FROM edge WHERE source_node_id == ? AND target_node_id == ? AND type == ? LIMIT 1;");
 
 	m_insertEdgeStatement = compileStatement("INSERT INTO edge(id, type, source_node_id, target_node_id) VALUES(?, ?, ?, ?);");
@@ -628,48 +1540,597 @@ void DatabaseStorage::setupPrecompiledStatements()
 		"(SELECT id FROM meta WHERE key = ?), ?, ?"
 		");");
 
-	// Prepared insert for tests mapping
-	m_insertTestMappingStmt = compileStatement("INSERT OR IGNORE INTO tests(symbol_id, test_symbol_id) VALUES(?, ?);");
+	// Prepared insert for tests mapping
+	m_insertTestMappingStmt = compileStatement("INSERT OR IGNORE INTO tests(symbol_id, test_symbol_id) VALUES(?, ?);");
+
+	m_insertElementFileStmt = compileStatement("INSERT OR IGNORE INTO element_file(element_id, file_id) VALUES(?, ?);");
+
+	m_insertNodesStatement = compileStatement(
+		getMultiRowInsertStatement("INSERT INTO node(id, type, serialized_name) VALUES", "(?, ?, ?)"));
+
+	m_insertNodeNamesStatement = compileStatement(
+		getMultiRowInsertStatement("INSERT INTO node_name(id, name, name_lower, parent_id) VALUES", "(?, ?, ?, ?)"));
+
+	m_insertEdgesStatement = compileStatement(
+		getMultiRowInsertStatement("INSERT INTO edge(id, type, source_node_id, target_node_id) VALUES", "(?, ?, ?, ?)"));
+
+	m_insertSourceLocationsStmt = compileStatement(getMultiRowInsertStatement(
+		"INSERT INTO source_location(id, file_node_id, start_line, start_column, end_line, end_column, type) VALUES",
+		"(NULL, ?, ?, ?, ?, ?, ?)"));
+
+	m_insertOccurrencesStmt = compileStatement(
+		getMultiRowInsertStatement("INSERT OR IGNORE INTO occurrence(element_id, source_location_id) VALUES", "(?, ?)"));
+}
+
+void DatabaseStorage::clearPrecompiledStatements()
+{
+	m_insertElementStatement.finalize();
+	m_insertElementRangeStatement.finalize();
+	m_deleteElementRangeStatement.finalize();
+	m_insertElementComponentStatement.finalize();
+	m_findNodeStatement.finalize();
+	m_insertNodeStatement.finalize();
+	m_insertNodeNameStatement.finalize();
+	m_setNodeTypeStmt.finalize();
+	m_insertSymbolStatement.finalize();
+	m_findFileStatement.finalize();
+	m_insertFileStatement.finalize();
+	m_setFileLanguageStmt.finalize();
+	m_insertFileContentStatement.finalize();
+	m_findFileContentStatement.finalize();
+	m_insertFileContentRefStatement.finalize();
+	m_insertFileStateStatement.finalize();
+	m_findFileStateStatement.finalize();
+	m_findEdgeStatement.finalize();
+	m_insertEdgeStatement.finalize();
+	m_findLocalSymbolStmt.finalize();
+	m_insertLocalSymbolStmt.finalize();
+	m_findSourceLocationStmt.finalize();
+	m_insertSourceLocationStmt.finalize();
+	m_insertOccurenceStmt.finalize();
+	m_findErrorStatement.finalize();
+	m_insertErrorStatement.finalize();
+	m_insertOrUpdateMetaValueStmt.finalize();
+	m_insertTestMappingStmt.finalize();
+	m_insertElementFileStmt.finalize();
+	m_insertNodesStatement.finalize();
+	m_insertNodeNamesStatement.finalize();
+	m_insertEdgesStatement.finalize();
+	m_insertSourceLocationsStmt.finalize();
+	m_insertOccurrencesStmt.finalize();
+	m_readStatements.clear();
+}
+
+StorageNodeName DatabaseStorage::getNodeName(int nodeId, const std::string& serializedName)
+{
+	// The serialized name of a node extends the one of its parent by "\tn" and its last name element. Only the name
+	// of that element is stored, the element ends with "\ts" prefix "\tp" postfix.
+	StorageNodeName nodeName;
+	nodeName.id = nodeId;
+
+	const size_t metaPos = serializedName.find("\tm");
+	if (metaPos == std::string::npos)
+	{
+		nodeName.name = serializedName;
+	}
+	else
+	{
+		const size_t namePos = serializedName.rfind("\tn");
+		const bool hasParent = namePos != std::string::npos && namePos > metaPos;
+		const size_t nameBegin = (hasParent ? namePos : metaPos) + 2;
+		const size_t nameEnd = serializedName.find("\ts", nameBegin);
+		nodeName.name = serializedName.substr(nameBegin, nameEnd == std::string::npos ? std::string::npos : nameEnd - nameBegin);
+		if (hasParent)
+		{
+			nodeName.parentId = findNodeId(serializedName.substr(0, namePos), false);
+		}
+	}
+	nodeName.nameLower = utility::toLowerCase(nodeName.name);
+	return nodeName;
+}
+
+void DatabaseStorage::addNodeNames(const std::vector<StorageNode>& nodes)
+{
+	std::vector<StorageNodeName> nodeNames;
+	nodeNames.reserve(nodes.size());
+	for (const StorageNode& node: nodes)
+	{
+		nodeNames.push_back(getNodeName(node.id, node.serializedName));
+	}
+
+	insertRows(nodeNames, m_insertNodeNamesStatement, m_insertNodeNameStatement, bindNodeName, [](size_t, size_t) {});
+}
+
+void DatabaseStorage::addMissingNodeNames()
+{
+	if (hasNodeNames())
+	{
+		return;
+	}
+
+	std::vector<StorageNode> nodes;
+	{
+		CppSQLite3Query q = executeQuery(
+			"SELECT id, type, serialized_name FROM node WHERE id NOT IN (SELECT id FROM node_name) ORDER BY id;");
+		while (!q.eof())
+		{
+			nodes.emplace_back(q.getIntField(0, 0), q.getIntField(1, 0), q.getStringField(2, ""));
+			q.nextRow();
+		}
+	}
+	addNodeNames(nodes);
+	m_hasNodeNames = 1;
+	updateNodeNamesMarker();
+}
+
+void DatabaseStorage::updateNodeNamesMarker()
+{
+	std::string maxNodeId;
+	{
+		CppSQLite3Query q = executeQuery("SELECT COALESCE(MAX(id), 0) FROM node;");
+		maxNodeId = q.getStringField(0, "0");
+	}
+	insertOrUpdateMetaValue(NODE_NAMES_MARKER_KEY, maxNodeId);
+	m_nodeNamesMarkerOutdated = false;
+}
+
+int DatabaseStorage::findCachedNodeId(const std::string& serializedName) const
+{
+	std::unordered_map<std::string, int>::const_iterator it = m_nodeIdCache.find(serializedName);
+	return it != m_nodeIdCache.end() ? it->second : 0;
+}
+
+int DatabaseStorage::findNodeId(const std::string& serializedName, bool recordStatistics)
+{
+	std::unordered_map<std::string, int>::const_iterator it = m_nodeIdCache.find(serializedName);
+	if (it != m_nodeIdCache.end())
+	{
+		if (recordStatistics)
+		{
+			countLookup(m_statistics.nodeLookups, &LookupStatistics::cacheHits);
+		}
+		return it->second;
+	}
+
+	int id = 0;
+	if (!m_cachesComplete)
+	{
+		bindText(m_findNodeStatement, 1, serializedName);
+		CppSQLite3Query q = executeQuery(m_findNodeStatement);
+		if (!q.eof())
+		{
+			id = q.getIntField(0, 0);
+		}
+		m_findNodeStatement.reset();
+
+		if (id != 0)
+		{
+			m_nodeIdCache.emplace(serializedName, id);
+		}
+	}
+	if (recordStatistics)
+	{
+		countLookup(m_statistics.nodeLookups, id ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
+	}
+	return id;
+}
+
+int DatabaseStorage::findEdgeId(const StorageEdgeData& storageEdgeData)
+{
+	const EdgeKey key(storageEdgeData);
+
+	std::unordered_map<EdgeKey, int, EdgeKeyHash>::const_iterator it = m_edgeIdCache.find(key);
+	if (it != m_edgeIdCache.end())
+	{
+		countLookup(m_statistics.edgeLookups, &LookupStatistics::cacheHits);
+		return it->second;
+	}
+
+	int id = 0;
+	if (!m_cachesComplete)
+	{
+		m_findEdgeStatement.bind(1, storageEdgeData.sourceNodeId);
+		m_findEdgeStatement.bind(2, storageEdgeData.targetNodeId);
+		m_findEdgeStatement.bind(3, storageEdgeData.edgeKind);
+		CppSQLite3Query q = executeQuery(m_findEdgeStatement);
+		if (!q.eof())
+		{
+			id = q.getIntField(0, 0);
+		}
+		m_findEdgeStatement.reset();
+
+		if (id != 0)
+		{
+			m_edgeIdCache.emplace(key, id);
+		}
+	}
+	countLookup(m_statistics.edgeLookups, id ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
+	return id;
+}
+
+int DatabaseStorage::findSourceLocationId(const StorageSourceLocationData& storageSourceLocationData)
+{
+	const SourceLocationKey key(storageSourceLocationData);
+
+	std::unordered_map<SourceLocationKey, int, SourceLocationKeyHash>::const_iterator it = m_sourceLocationIdCache.find(key);
+	if (it != m_sourceLocationIdCache.end())
+	{
+		countLookup(m_statistics.sourceLocationLookups, &LookupStatistics::cacheHits);
+		return it->second;
+	}
+
+	int id = 0;
+	if (!m_cachesComplete)
+	{
+		m_findSourceLocationStmt.bind(1, storageSourceLocationData.fileNodeId);
+		m_findSourceLocationStmt.bind(2, storageSourceLocationData.startLineNumber);
+		m_findSourceLocationStmt.bind(3, storageSourceLocationData.startColumnNumber);
+		m_findSourceLocationStmt.bind(4, storageSourceLocationData.endLineNumber);
+		m_findSourceLocationStmt.bind(5, storageSourceLocationData.endColumnNumber);
+		m_findSourceLocationStmt.bind(6, storageSourceLocationData.locationKind);
+		CppSQLite3Query q = executeQuery(m_findSourceLocationStmt);
+		if (!q.eof())
+		{
+			id = q.getIntField(0, 0);
+		}
+		m_findSourceLocationStmt.reset();
+
+		if (id != 0)
+		{
+			m_sourceLocationIdCache.emplace(key, id);
+		}
+	}
+	countLookup(m_statistics.sourceLocationLookups, id ? &LookupStatistics::databaseHits : &LookupStatistics::misses);
+	return id;
+}
+
+template <typename RowType, typename BindRowFunction, typename RowsInsertedFunction>
+void DatabaseStorage::insertRows(
+	const std::vector<RowType>& rows,
+	CppSQLite3Statement& multiRowStatement,
+	CppSQLite3Statement& singleRowStatement,
+	BindRowFunction bindRow,
+	RowsInsertedFunction rowsInserted)
+{
+	size_t firstRow = 0;
+	while (firstRow < rows.size())
+	{
+		const bool useMultiRowStatement = rows.size() - firstRow >= MULTI_ROW_INSERT_SIZE;
+		CppSQLite3Statement& statement = useMultiRowStatement ? multiRowStatement : singleRowStatement;
+		const size_t rowCount = useMultiRowStatement ? MULTI_ROW_INSERT_SIZE : 1;
+
+		int parameterIndex = 1;
+		for (size_t i = firstRow; i < firstRow + rowCount; i++)
+		{
+			parameterIndex = bindRow(statement, parameterIndex, rows[i]);
+		}
+		executeStatement(statement);
+		rowsInserted(firstRow, rowCount);
+		statement.reset();
+
+		firstRow += rowCount;
+	}
+}
+
+void DatabaseStorage::mergeAttachedDatabase(int unknownNodeKind)
+{
+	// Elements without counterpart get their source id shifted past all existing ids, so every mapped id larger than
+	// the offset belongs to a new element. The same holds for source locations, which have their own id space.
+	const std::string elementIdOffset = std::to_string(executeQuery("SELECT COALESCE(MAX(id), 0) FROM main.element;").getInt64Field(0, 0));
+	const std::string sourceLocationIdOffset =
+		std::to_string(executeQuery("SELECT COALESCE(MAX(id), 0) FROM main.source_location;").getInt64Field(0, 0));
+
+	executeStatement("CREATE TEMP TABLE merge_element_map(source_id INTEGER, id INTEGER, PRIMARY KEY(source_id));");
+	executeStatement("CREATE INDEX temp.merge_element_map_id_index ON merge_element_map(id);");
+	executeStatement("CREATE TEMP TABLE merge_source_location_map(source_id INTEGER, id INTEGER, PRIMARY KEY(source_id));");
+
+	// nodes
+	executeStatement(
+		"INSERT INTO temp.merge_element_map(source_id, id) "
+		"SELECT s.id, COALESCE((SELECT n.id FROM main.node n WHERE n.serialized_name = s.serialized_name), s.id + " +
+		elementIdOffset + ") FROM merge_source.node s;");
+	executeStatement("INSERT INTO main.element(id) SELECT id FROM temp.merge_element_map WHERE id > " + elementIdOffset + ";");
+	executeStatement(
+		"INSERT INTO main.node(id, type, serialized_name) "
+		"SELECT m.id, s.type, s.serialized_name FROM merge_source.node s JOIN temp.merge_element_map m ON m.source_id = s.id "
+		"WHERE m.id > " + elementIdOffset + ";");
+	executeStatement(
+		"UPDATE main.node SET type = (SELECT s.type FROM merge_source.node s JOIN temp.merge_element_map m ON m.source_id = s.id "
+		"WHERE m.id = main.node.id) "
+		"WHERE type = " + std::to_string(unknownNodeKind) + " AND id IN (SELECT m.id FROM temp.merge_element_map m);");
+	// the merged nodes lack their node_name rows
+	m_hasNodeNames = 0;
+	addMissingNodeNames();
+
+	// explicit definitions outrank implicit ones
+	executeStatement(
+		"INSERT OR REPLACE INTO main.symbol(id, definition_kind) "
+		"SELECT m.id, MAX(s.definition_kind, COALESCE((SELECT e.definition_kind FROM main.symbol e WHERE e.id = m.id), 0)) "
+		"FROM merge_source.symbol s JOIN temp.merge_element_map m ON m.source_id = s.id;");
+
+	executeStatement(
+		"INSERT OR IGNORE INTO main.component_access(node_id, type) "
+		"SELECT m.id, s.type FROM merge_source.component_access s JOIN temp.merge_element_map m ON m.source_id = s.node_id;");
+
+	// files, preferring the indexed version of a file that is known to both databases
+	executeStatement(
+		"INSERT OR IGNORE INTO main.file(id, path, language, modification_time, indexed, complete, line_count) "
+		"SELECT m.id, s.path, s.language, s.modification_time, s.indexed, s.complete, s.line_count "
+		"FROM merge_source.file s JOIN temp.merge_element_map m ON m.source_id = s.id;");
+	for (const char* column: {"language", "modification_time", "complete", "line_count", "indexed"})
+	{
+		executeStatement(
+			std::string("UPDATE main.file SET ") + column + " = (SELECT s." + column +
+			" FROM merge_source.file s JOIN temp.merge_element_map m ON m.source_id = s.id WHERE m.id = main.file.id) "
+			"WHERE indexed = 0 AND id IN (SELECT m.id FROM merge_source.file s JOIN temp.merge_element_map m ON m.source_id = s.id "
+			"WHERE s.indexed != 0);");
+	}
+	{
+		// contents of files that already have one stay, contents that the source refers to are resolved
+		std::string contentQuery =
+			"SELECT m.id, s.content FROM merge_source.filecontent s JOIN temp.merge_element_map m ON m.source_id = s.id";
+		if (executeQuery("SELECT COUNT(*) FROM merge_source.sqlite_master WHERE name = 'filecontent_ref';").getIntField(0, 0) != 0)
+		{
+			contentQuery +=
+				" UNION ALL SELECT m.id, s.content FROM merge_source.filecontent_ref r "
+				"JOIN merge_source.filecontent s ON s.id = r.content_file_id JOIN temp.merge_element_map m ON m.source_id = r.file_id";
+		}
+		CppSQLite3Query q = executeQuery(
+			"SELECT id, content FROM (" + contentQuery + ") WHERE content IS NOT NULL AND "
+			"id NOT IN (SELECT id FROM main.filecontent) AND id NOT IN (SELECT file_id FROM main.filecontent_ref);");
+		while (!q.eof())
+		{
+			int contentSize = 0;
+			const char* content = reinterpret_cast<const char*>(q.getBlobField(1, contentSize));
+			if (contentSize > 0)
+			{
+				addFileContent(q.getIntField(0, 0), utility::getContentHash(content, contentSize), content, contentSize);
+			}
+			q.nextRow();
+		}
+	}
+
+	// edges
+	executeStatement(
+		"INSERT INTO temp.merge_element_map(source_id, id) "
+		"SELECT s.id, COALESCE((SELECT e.id FROM main.edge e WHERE e.source_node_id = ms.id AND e.target_node_id = mt.id AND "
+		"e.type = s.type), s.id + " + elementIdOffset + ") "
+		"FROM merge_source.edge s "
+		"JOIN temp.merge_element_map ms ON ms.source_id = s.source_node_id "
+		"JOIN temp.merge_element_map mt ON mt.source_id = s.target_node_id;");
+	executeStatement(
+		"INSERT INTO main.element(id) "
+		"SELECT m.id FROM merge_source.edge s JOIN temp.merge_element_map m ON m.source_id = s.id WHERE m.id > " + elementIdOffset + ";");
+	executeStatement(
+		"INSERT INTO main.edge(id, type, source_node_id, target_node_id) "
+		"SELECT m.id, s.type, ms.id, mt.id FROM merge_source.edge s "
+		"JOIN temp.merge_element_map m ON m.source_id = s.id "
+		"JOIN temp.merge_element_map ms ON ms.source_id = s.source_node_id "
+		"JOIN temp.merge_element_map mt ON mt.source_id = s.target_node_id "
+		"WHERE m.id > " + elementIdOffset + ";");
+
+	// local symbols
+	executeStatement(
+		"INSERT INTO temp.merge_element_map(source_id, id) "
+		"SELECT s.id, COALESCE((SELECT e.id FROM main.local_symbol e WHERE e.name = s.name), s.id + " + elementIdOffset + ") "
+		"FROM merge_source.local_symbol s;");
+	executeStatement(
+		"INSERT INTO main.element(id) "
+		"SELECT m.id FROM merge_source.local_symbol s JOIN temp.merge_element_map m ON m.source_id = s.id "
+		"WHERE m.id > " + elementIdOffset + ";");
+	executeStatement(
+		"INSERT INTO main.local_symbol(id, name) "
+		"SELECT m.id, s.name FROM merge_source.local_symbol s JOIN temp.merge_element_map m ON m.source_id = s.id "
+		"WHERE m.id > " + elementIdOffset + ";");
+
+	// errors
+	executeStatement(
+		"INSERT INTO temp.merge_element_map(source_id, id) "
+		"SELECT s.id, COALESCE((SELECT e.id FROM main.error e WHERE e.message = s.message AND e.fatal = s.fatal), s.id + " +
+		elementIdOffset + ") FROM merge_source.error s;");
+	executeStatement(
+		"INSERT INTO main.element(id) "
+		"SELECT m.id FROM merge_source.error s JOIN temp.merge_element_map m ON m.source_id = s.id WHERE m.id > " + elementIdOffset + ";");
+	executeStatement(
+		"INSERT INTO main.error(id, message, fatal, indexed, translation_unit) "
+		"SELECT m.id, s.message, s.fatal, s.indexed, s.translation_unit FROM merge_source.error s "
+		"JOIN temp.merge_element_map m ON m.source_id = s.id WHERE m.id > " + elementIdOffset + ";");
+
+	executeStatement(
+		"INSERT INTO main.element_component(element_id, type, data) "
+		"SELECT m.id, s.type, s.data FROM merge_source.element_component s JOIN temp.merge_element_map m ON m.source_id = s.element_id "
+		"WHERE NOT EXISTS (SELECT 1 FROM main.element_component e WHERE e.element_id = m.id AND e.type = s.type AND e.data IS s.data);");
+
+	// source locations and occurrences
+	executeStatement(
+		"INSERT INTO temp.merge_source_location_map(source_id, id) "
+		"SELECT s.id, COALESCE((SELECT e.id FROM main.source_location e WHERE e.file_node_id = mf.id AND "
+		"e.start_line = s.start_line AND e.start_column = s.start_column AND e.end_line = s.end_line AND "
+		"e.end_column = s.end_column AND e.type = s.type), s.id + " + sourceLocationIdOffset + ") "
+		"FROM merge_source.source_location s JOIN temp.merge_element_map mf ON mf.source_id = s.file_node_id;");
+	executeStatement(
+		"INSERT INTO main.source_location(id, file_node_id, start_line, start_column, end_line, end_column, type) "
+		"SELECT m.id, mf.id, s.start_line, s.start_column, s.end_line, s.end_column, s.type FROM merge_source.source_location s "
+		"JOIN temp.merge_source_location_map m ON m.source_id = s.id "
+		"JOIN temp.merge_element_map mf ON mf.source_id = s.file_node_id "
+		"WHERE m.id > " + sourceLocationIdOffset + ";");
+	executeStatement(
+		"INSERT OR IGNORE INTO main.occurrence(element_id, source_location_id) "
+		"SELECT me.id, ml.id FROM merge_source.occurrence s "
+		"JOIN temp.merge_element_map me ON me.source_id = s.element_id "
+		"JOIN temp.merge_source_location_map ml ON ml.source_id = s.source_location_id;");
+
+	executeStatement(
+		"INSERT OR IGNORE INTO main.tests(symbol_id, test_symbol_id) "
+		"SELECT ms.id, mt.id FROM merge_source.tests s "
+		"JOIN temp.merge_element_map ms ON ms.source_id = s.symbol_id "
+		"JOIN temp.merge_element_map mt ON mt.source_id = s.test_symbol_id;");
+
+	// databases written before files were tracked per element do not have the element_file and file_state tables
+	bool sourceTracksFiles = false;
+	{
+		CppSQLite3Query q = executeQuery(
+			"SELECT COUNT(*) FROM merge_source.sqlite_master WHERE name IN ('element_file', 'file_state');");
+		sourceTracksFiles = q.getIntField(0, 0) == 2;
+	}
+	if (sourceTracksFiles)
+	{
+		executeStatement(
+			"INSERT OR IGNORE INTO main.file_state(file_id, size, modification_time, recording_time, content_hash) "
+			"SELECT m.id, s.size, s.modification_time, s.recording_time, s.content_hash FROM merge_source.file_state s "
+			"JOIN temp.merge_element_map m ON m.source_id = s.file_id;");
+		executeStatement(
+			"INSERT OR IGNORE INTO main.element_file(element_id, file_id) "
+			"SELECT me.id, mf.id FROM merge_source.element_file s "
+			"JOIN temp.merge_element_map me ON me.source_id = s.element_id "
+			"JOIN temp.merge_element_map mf ON mf.source_id = s.file_id;");
+	}
+
+	executeStatement("DROP TABLE temp.merge_element_map;");
+	executeStatement("DROP TABLE temp.merge_source_location_map;");
+}
+
+bool DatabaseStorage::hasCachedTableContent() const
+{
+	const std::vector<std::string> tableNames = {"element", "source_location"};
+
+	for (const std::string& tableName: tableNames)
+	{
+		CppSQLite3Query q = executeQuery("SELECT name FROM sqlite_master WHERE type='table' AND name='" + tableName + "';");
+		if (!q.eof() && !executeQuery("SELECT 1 FROM " + tableName + " LIMIT 1;").eof())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void DatabaseStorage::countOperation(OperationStatistics& operation, size_t rows)
+{
+	if (m_statisticsEnabled)
+	{
+		operation.calls++;
+		operation.rows += rows;
+	}
+}
+
+void DatabaseStorage::countLookup(LookupStatistics& lookup, size_t LookupStatistics::*outcome)
+{
+	if (m_statisticsEnabled)
+	{
+		(lookup.*outcome)++;
+	}
+}
+
+void DatabaseStorage::clearCaches(bool cachesComplete)
+{
+	m_nodeIdCache.clear();
+	m_edgeIdCache.clear();
+	m_localSymbolIdCache.clear();
+	m_sourceLocationIdCache.clear();
+	m_elementFileCache.clear();
+	m_cachesComplete = cachesComplete;
+}
+
+DatabaseStorage::EdgeKey::EdgeKey(const StorageEdgeData& storageEdgeData)
+	: sourceNodeId(storageEdgeData.sourceNodeId), targetNodeId(storageEdgeData.targetNodeId), edgeKind(storageEdgeData.edgeKind)
+{
+}
+
+bool DatabaseStorage::EdgeKey::operator==(const EdgeKey& other) const
+{
+	return sourceNodeId == other.sourceNodeId && targetNodeId == other.targetNodeId && edgeKind == other.edgeKind;
+}
+
+size_t DatabaseStorage::EdgeKeyHash::operator()(const EdgeKey& key) const
+{
+	size_t hash = std::hash<int>()(key.sourceNodeId);
+	utility::hashCombine(hash, key.targetNodeId);
+	utility::hashCombine(hash, key.edgeKind);
+	return hash;
+}
+
+DatabaseStorage::SourceLocationKey::SourceLocationKey(const StorageSourceLocationData& storageSourceLocationData)
+	: fileNodeId(storageSourceLocationData.fileNodeId)
+	, startLineNumber(storageSourceLocationData.startLineNumber)
+	, startColumnNumber(storageSourceLocationData.startColumnNumber)
+	, endLineNumber(storageSourceLocationData.endLineNumber)
+	, endColumnNumber(storageSourceLocationData.endColumnNumber)
+	, locationKind(storageSourceLocationData.locationKind)
+{
+}
+
+bool DatabaseStorage::SourceLocationKey::operator==(const SourceLocationKey& other) const
+{
+	return fileNodeId == other.fileNodeId && startLineNumber == other.startLineNumber &&
+		startColumnNumber == other.startColumnNumber && endLineNumber == other.endLineNumber &&
+		endColumnNumber == other.endColumnNumber && locationKind == other.locationKind;
 }
 
-void DatabaseStorage::clearPrecompiledStatements()
+size_t DatabaseStorage::SourceLocationKeyHash::operator()(const SourceLocationKey& key) const
 {
-	m_insertElementStatement.finalize();
-	m_insertElementComponentStatement.finalize();
-	m_findNodeStatement.finalize();
-	m_insertNodeStatement.finalize();
-	m_setNodeTypeStmt.finalize();
-	m_insertSymbolStatement.finalize();
-	m_findFileStatement.finalize();
-	m_insertFileStatement.finalize();
-	m_setFileLanguageStmt.finalize();
-	m_insertFileContentStatement.finalize();
-	m_findEdgeStatement.finalize();
-	m_insertEdgeStatement.finalize();
-	m_findLocalSymbolStmt.finalize();
-	m_insertLocalSymbolStmt.finalize();
-	m_findSourceLocationStmt.finalize();
-	m_insertSourceLocationStmt.finalize();
-	m_insertOccurenceStmt.finalize();
-	m_findErrorStatement.finalize();
-	m_insertErrorStatement.finalize();
-	m_insertOrUpdateMetaValueStmt.finalize();
-	m_insertTestMappingStmt.finalize();
+	size_t hash = std::hash<int>()(key.fileNodeId);
+	utility::hashCombine(hash, key.startLineNumber);
+	utility::hashCombine(hash, key.startColumnNumber);
+	utility::hashCombine(hash, key.endLineNumber);
+	utility::hashCombine(hash, key.endColumnNumber);
+	utility::hashCombine(hash, key.locationKind);
+	return hash;
 }
 
 int DatabaseStorage::insertElement()
 {
-	executeStatement(m_insertElementStatement);
-	const int id = static_cast<int>(m_database.lastRowId());
-	m_insertElementStatement.reset();
-	return id;
+	if (!isInTransaction())
+	{
+		executeStatement(m_insertElementStatement);
+		const int id = static_cast<int>(m_database.lastRowId());
+		m_insertElementStatement.reset();
+		return id;
+	}
+
+	if (m_nextElementId == m_endElementId)
+	{
+		reserveElementIds();
+	}
+	return m_nextElementId++;
+}
+
+void DatabaseStorage::reserveElementIds()
+{
+	m_elementIdBlockSize = std::min(std::max(m_elementIdBlockSize * 2, MIN_ELEMENT_ID_BLOCK_SIZE), MAX_ELEMENT_ID_BLOCK_SIZE);
+
+	const int firstId = static_cast<int>(executeQuery("SELECT COALESCE(MAX(id), 0) + 1 FROM element;").getInt64Field(0, 1));
+	const int lastId = firstId + m_elementIdBlockSize - 1;
+
+	m_insertElementRangeStatement.bind(1, firstId);
+	m_insertElementRangeStatement.bind(2, lastId);
+	executeStatement(m_insertElementRangeStatement);
+	m_insertElementRangeStatement.reset();
+
+	m_nextElementId = firstId;
+	m_endElementId = lastId + 1;
+}
+
+void DatabaseStorage::releaseElementIds()
+{
+	if (m_nextElementId < m_endElementId)
+	{
+		m_deleteElementRangeStatement.bind(1, m_nextElementId);
+		m_deleteElementRangeStatement.bind(2, m_endElementId);
+		executeStatement(m_deleteElementRangeStatement);
+		m_deleteElementRangeStatement.reset();
+	}
+
+	m_nextElementId = 0;
+	m_endElementId = 0;
+	m_elementIdBlockSize = 0;
 }
 
 void DatabaseStorage::insertOrUpdateMetaValue(const std::string& key, const std::string& value)
 {
-	m_insertOrUpdateMetaValueStmt.bind(1, key.c_str());
-	m_insertOrUpdateMetaValueStmt.bind(2, key.c_str());
-	m_insertOrUpdateMetaValueStmt.bind(3, value.c_str());
+	bindText(m_insertOrUpdateMetaValueStmt, 1, key);
+	bindText(m_insertOrUpdateMetaValueStmt, 2, key);
+	bindText(m_insertOrUpdateMetaValueStmt, 3, value);
 	executeStatement(m_insertOrUpdateMetaValueStmt);
 	m_insertOrUpdateMetaValueStmt.reset();
 }
@@ -683,6 +2144,135 @@ int DatabaseStorage::addTestMapping(int symbolId, int testSymbolId)
 	return 1;
 }
 
+void DatabaseStorage::addElementFile(int elementId, int fileId)
+{
+	const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(elementId)) << 32) | static_cast<uint32_t>(fileId);
+	if (!m_elementFileCache.insert(key).second)
+	{
+		return;
+	}
+
+	m_insertElementFileStmt.bind(1, elementId);
+	m_insertElementFileStmt.bind(2, fileId);
+	executeStatement(m_insertElementFileStmt);
+	m_insertElementFileStmt.reset();
+}
+
+bool DatabaseStorage::removeFile(int fileId, int memberEdgeKind, bool keepFileNode)
+{
+	if (m_bulkLoading)
+	{
+		throw SourcetrailException("Unable to remove file, because a bulk load is in progress.");
+	}
+
+	m_findFileStatement.bind(1, fileId);
+	CppSQLite3Query q = executeQuery(m_findFileStatement);
+	const bool isFile = !q.eof();
+	m_findFileStatement.reset();
+	if (!isFile)
+	{
+		return false;
+	}
+
+	setupFileRemovalIndices();
+
+	const std::string savepointName = "remove_file";
+	beginSavepoint(savepointName);
+	try
+	{
+		removeFileElements(fileId, memberEdgeKind);
+
+		moveReferencedFileContent(fileId);
+
+		const std::string id = std::to_string(fileId);
+		if (keepFileNode)
+		{
+			executeStatement("DELETE FROM file WHERE id = " + id + ";");
+		}
+		else
+		{
+			executeStatement("DELETE FROM filecontent WHERE id = " + id + ";");
+			executeStatement("DELETE FROM filecontent_ref WHERE file_id = " + id + ";");
+			executeStatement("UPDATE file SET indexed = 0, complete = 0 WHERE id = " + id + ";");
+			executeStatement(
+				"DELETE FROM element WHERE id = " + id + " AND NOT EXISTS (SELECT 1 FROM edge WHERE source_node_id = " + id +
+				" OR target_node_id = " + id + ");");
+		}
+
+		releaseSavepoint(savepointName);
+	}
+	catch (const SourcetrailException& e)
+	{
+		rollbackToSavepoint(savepointName);
+		releaseSavepoint(savepointName);
+		throw;
+	}
+
+	clearCaches(false);
+	return true;
+}
+
+void DatabaseStorage::removeFileElements(int fileId, int memberEdgeKind)
+{
+	const std::string id = std::to_string(fileId);
+	const std::string memberKind = std::to_string(memberEdgeKind);
+
+	executeStatement("CREATE TEMP TABLE IF NOT EXISTS removed_file_element(id INTEGER PRIMARY KEY);");
+	executeStatement("CREATE TEMP TABLE IF NOT EXISTS removed_node(id INTEGER PRIMARY KEY);");
+	executeStatement("DELETE FROM temp.removed_file_element;");
+	executeStatement(
+		"INSERT INTO temp.removed_file_element(id) SELECT element_id FROM main.element_file WHERE file_id = " + id +
+		" AND element_id != " + id + ";");
+
+	executeStatement("DELETE FROM main.element_file WHERE file_id = " + id + ";");
+	executeStatement("DELETE FROM main.source_location WHERE file_node_id = " + id + ";");
+
+	// elements that are still recorded for other files stay
+	executeStatement(
+		"DELETE FROM temp.removed_file_element WHERE id IN (SELECT element_id FROM main.element_file);");
+
+	// edges, local symbols and errors are not referred to by other elements
+	executeStatement(
+		"DELETE FROM main.element WHERE id IN (SELECT r.id FROM temp.removed_file_element r "
+		"WHERE NOT EXISTS (SELECT 1 FROM main.node n WHERE n.id = r.id));");
+
+	// Nodes stay while edges or source locations refer to them, except for the MEMBER edge from their parent.
+	// Removing a child may release its parent, so the nodes are removed level by level.
+	while (true)
+	{
+		executeStatement("DELETE FROM temp.removed_node;");
+		executeStatement(
+			"INSERT INTO temp.removed_node(id) SELECT r.id FROM temp.removed_file_element r "
+			"WHERE EXISTS (SELECT 1 FROM main.node n WHERE n.id = r.id) "
+			"AND NOT EXISTS (SELECT 1 FROM main.edge e WHERE e.source_node_id = r.id) "
+			"AND NOT EXISTS (SELECT 1 FROM main.edge e WHERE e.target_node_id = r.id AND e.type != " + memberKind + ") "
+			"AND NOT EXISTS (SELECT 1 FROM main.source_location s WHERE s.file_node_id = r.id);");
+		{
+			CppSQLite3Query q = executeQuery("SELECT COUNT(*) FROM temp.removed_node;");
+			if (q.getIntField(0, 0) == 0)
+			{
+				break;
+			}
+		}
+
+		executeStatement(
+			"DELETE FROM main.element WHERE id IN (SELECT e.id FROM main.edge e "
+			"WHERE e.target_node_id IN (SELECT id FROM temp.removed_node) AND e.type = " + memberKind + ");");
+		executeStatement("DELETE FROM main.element WHERE id IN (SELECT id FROM temp.removed_node);");
+		executeStatement("DELETE FROM temp.removed_file_element WHERE id IN (SELECT id FROM temp.removed_node);");
+	}
+}
+
+std::string DatabaseStorage::getSchemaObjectType(const std::string& name) const
+{
+	CppSQLite3Query q = executeQuery("SELECT type FROM main.sqlite_master WHERE name = '" + name + "';");
+	if (!q.eof())
+	{
+		return q.getStringField(0, "");
+	}
+	return "";
+}
+
 CppSQLite3Statement DatabaseStorage::compileStatement(const std::string& statement) const
 {
 	try
@@ -699,6 +2289,7 @@ CppSQLite3Statement DatabaseStorage::compileStatement(const std::string& stateme
 
 void DatabaseStorage::executeStatement(const std::string& statement) const
 {
+	const ScopedStopwatch stopwatch(m_statisticsEnabled ? &m_statistics.sqliteMilliseconds : nullptr);
 	try
 	{
 		m_database.execDML(statement.c_str());
@@ -711,6 +2302,7 @@ void DatabaseStorage::executeStatement(const std::string& statement) const
 
 void DatabaseStorage::executeStatement(CppSQLite3Statement& statement) const
 {
+	const ScopedStopwatch stopwatch(m_statisticsEnabled ? &m_statistics.sqliteMilliseconds : nullptr);
 	try
 	{
 		statement.execDML();
@@ -721,8 +2313,118 @@ void DatabaseStorage::executeStatement(CppSQLite3Statement& statement) const
 	}
 }
 
+CppSQLite3Statement& DatabaseStorage::getReadStatement(const std::string& query) const
+{
+	std::unordered_map<std::string, CppSQLite3Statement>::iterator it = m_readStatements.find(query);
+	if (it == m_readStatements.end())
+	{
+		return m_readStatements.emplace(query, compileStatement(query)).first->second;
+	}
+
+	try
+	{
+		it->second.reset();
+	}
+	catch (CppSQLite3Exception)
+	{
+		// the error of the previous execution has already been reported, the statement can be used again
+	}
+	return it->second;
+}
+
+std::vector<StorageNode> DatabaseStorage::queryNodes(CppSQLite3Statement& statement) const
+{
+	std::vector<StorageNode> nodes;
+
+	CppSQLite3Query q = executeQuery(statement);
+	while (!q.eof())
+	{
+		const int id = q.getIntField(0, 0);
+		const int type = q.getIntField(1, -1);
+		if (id != 0 && type != -1)
+		{
+			nodes.emplace_back(id, type, q.getStringField(2, ""));
+		}
+		q.nextRow();
+	}
+	statement.reset();
+
+	return nodes;
+}
+
+std::vector<StorageSymbolNode> DatabaseStorage::querySymbolNodes(CppSQLite3Statement& statement, bool withSerializedNames) const
+{
+	std::vector<StorageSymbolNode> nodes;
+	visitSymbolNodes(statement, withSerializedNames, [&nodes](const StorageSymbolNode& node) {
+		nodes.push_back(node);
+		return true;
+	});
+	return nodes;
+}
+
+std::vector<StorageEdge> DatabaseStorage::queryEdges(CppSQLite3Statement& statement) const
+{
+	std::vector<StorageEdge> edges;
+	visitEdges(statement, [&edges](const StorageEdge& edge) {
+		edges.push_back(edge);
+		return true;
+	});
+	return edges;
+}
+
+void DatabaseStorage::visitSymbolNodes(
+	CppSQLite3Statement& statement,
+	bool withSerializedNames,
+	const std::function<bool(const StorageSymbolNode&)>& visitor) const
+{
+	CppSQLite3Query q = executeQuery(statement);
+	StorageSymbolNode node;
+	bool proceed = true;
+	while (proceed && !q.eof())
+	{
+		node.id = q.getIntField(0, 0);
+		node.nodeKind = q.getIntField(1, -1);
+		if (node.id != 0 && node.nodeKind != -1)
+		{
+			if (withSerializedNames)
+			{
+				node.serializedName = q.getStringField(2, "");
+				node.definitionKind = q.getIntField(3, -1);
+			}
+			else
+			{
+				node.definitionKind = q.getIntField(2, -1);
+			}
+			proceed = visitor(node);
+		}
+		q.nextRow();
+	}
+	statement.reset();
+}
+
+void DatabaseStorage::visitEdges(CppSQLite3Statement& statement, const std::function<bool(const StorageEdge&)>& visitor) const
+{
+	CppSQLite3Query q = executeQuery(statement);
+	StorageEdge edge;
+	bool proceed = true;
+	while (proceed && !q.eof())
+	{
+		edge.id = q.getIntField(0, 0);
+		edge.edgeKind = q.getIntField(1, -1);
+		if (edge.id != 0 && edge.edgeKind != -1)
+		{
+			edge.sourceNodeId = q.getIntField(2, 0);
+			edge.targetNodeId = q.getIntField(3, 0);
+			proceed = visitor(edge);
+		}
+		q.nextRow();
+	}
+	statement.reset();
+}
+
 CppSQLite3Query DatabaseStorage::executeQuery(const std::string& query) const
 {
+	const ScopedStopwatch stopwatch(m_statisticsEnabled ? &m_statistics.sqliteMilliseconds : nullptr);
 	try
 	{
 		return m_database.execQuery(query.c_str());
@@ -735,6 +2437,7 @@ CppSQLite3Query DatabaseStorage::executeQuery(const std::string& query) const
 
 CppSQLite3Query DatabaseStorage::executeQuery(CppSQLite3Statement& statement) const
 {
+	const ScopedStopwatch stopwatch(m_statisticsEnabled ? &m_statistics.sqliteMilliseconds : nullptr);
 	try
 	{
 		return statement.execQuery();
@@ -935,174 +2638,244 @@ std::vector<StorageError> DatabaseStorage::doGetAll<StorageError>(const std::str
 	return errors;
 }
 
-std::vector<StorageNode> DatabaseStorage::getAllSymbolNodes() const
+std::vector<StorageSymbolNode> DatabaseStorage::getAllSymbolNodes() const
 {
-	CppSQLite3Query q = executeQuery("SELECT n.id, n.type, n.serialized_name FROM node n INNER JOIN symbol s ON n.id = s.id;");
-	std::vector<StorageNode> nodes; 
-	while(!q.eof()) 
-	{ 
-		int id=q.getIntField(0,0); 
-		int type=q.getIntField(1,-1); 
-		std::string ser=q.getStringField(2,""); 
-		if(id&&type!=-1) 
-			nodes.emplace_back(StorageNode(id,type,ser)); 
-		q.nextRow(); 
-	} 
+	std::vector<StorageSymbolNode> nodes;
+	forEachSymbolNode(
+		[&nodes](const StorageSymbolNode& node) {
+			nodes.push_back(node);
+			return true;
+		},
+		true);
 	return nodes;
 }
 
-std::vector<StorageNode> DatabaseStorage::findSymbolNodesBySerializedNameLike(const std::string& pattern) const
+std::vector<StorageSymbolNode> DatabaseStorage::getSymbolNodesBySerializedNameExact(const std::string& serializedName) const
 {
-	CppSQLite3Query q = executeQuery("SELECT n.id, n.type, n.serialized_name FROM node n INNER JOIN symbol s ON n.id = s.id WHERE n.serialized_name LIKE '" + pattern + "';");
-	std::vector<StorageNode> nodes; 
-	while(!q.eof()) 
-	{ 
-		int id=q.getIntField(0,0); 
-		int type=q.getIntField(1,-1); 
-		std::string ser=q.getStringField(2,""); 
-		if(id&&type!=-1) 
-			nodes.emplace_back(StorageNode(id,type,ser)); 
-		q.nextRow(); 
-	} 
-	return nodes;
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node "
+		"INNER JOIN symbol ON node.id = symbol.id WHERE node.serialized_name = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, serializedName);
+	return querySymbolNodes(statement, true);
 }
 
-// --- Targeted read helper implementations ---
+std::vector<StorageSymbolNode> DatabaseStorage::findSymbolNodesBySerializedNameLike(const std::string& pattern) const
+{
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node "
+		"INNER JOIN symbol ON node.id = symbol.id WHERE node.serialized_name LIKE ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, pattern);
+	return querySymbolNodes(statement, true);
+}
 
-std::vector<StorageNode> DatabaseStorage::getNodesBySerializedNameExact(const std::string& serializedName) const
+StorageSymbolNode DatabaseStorage::getSymbolNodeById(int nodeId) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node WHERE serialized_name = '" + serializedName + "';");
-	std::vector<StorageNode> nodes;
-	while (!q.eof())
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node "
+		"LEFT JOIN symbol ON node.id = symbol.id WHERE node.id = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, nodeId);
+	const std::vector<StorageSymbolNode> nodes = querySymbolNodes(statement, true);
+	return nodes.empty() ? StorageSymbolNode() : nodes.front();
+}
+
+bool DatabaseStorage::hasNodeNames() const
+{
+	if (m_hasNodeNames < 0)
 	{
-		const int id = q.getIntField(0, 0);
-		const int type = q.getIntField(1, -1);
-		const std::string ser = q.getStringField(2, "");
-		if (id != 0 && type != -1)
+		m_hasNodeNames = 0;
+		if (getSchemaObjectType("node_name") == "table")
 		{
-			nodes.emplace_back(StorageNode(id, type, ser));
+			// a node added by another writer, e.g. an earlier version, raises the largest node id above the marker
+			CppSQLite3Query q = executeQuery(
+				"SELECT (SELECT value FROM meta WHERE key = '" + std::string(NODE_NAMES_MARKER_KEY) +
+				"') = CAST(COALESCE(MAX(id), 0) AS TEXT) FROM node;");
+			m_hasNodeNames = q.getIntField(0, 0) != 0 ? 1 : 0;
 		}
-		q.nextRow();
 	}
-	return nodes;
+	return m_hasNodeNames == 1;
+}
+
+std::vector<StorageSymbolNode> DatabaseStorage::getSymbolNodesByName(const std::string& name) const
+{
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node_name "
+		"CROSS JOIN node ON node.id = node_name.id INNER JOIN symbol ON node.id = symbol.id WHERE node_name.name = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, name);
+	return querySymbolNodes(statement, true);
+}
+
+std::vector<StorageSymbolNode> DatabaseStorage::getSymbolNodesByNameAndParentName(
+	const std::string& name, const std::string& parentName) const
+{
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node_name "
+		"CROSS JOIN node_name parent ON parent.id = node_name.parent_id CROSS JOIN node ON node.id = node_name.id "
+		"INNER JOIN symbol ON node.id = symbol.id WHERE node_name.name = ? AND parent.name = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, name);
+	bindText(statement, 2, parentName);
+	return querySymbolNodes(statement, true);
+}
+
+std::vector<StorageSymbolNode> DatabaseStorage::findSymbolNodesByNamePrefix(const std::string& prefix, bool ignoreCase) const
+{
+	// all names that start with the prefix lie in [prefix, prefix + "\xff"), because 0xff is no byte of UTF-8
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node_name "
+		"CROSS JOIN node ON node.id = node_name.id INNER JOIN symbol ON node.id = symbol.id "
+		"WHERE node_name.name >= ? AND node_name.name < ?;";
+	static const std::string ignoreCaseQuery =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node_name "
+		"CROSS JOIN node ON node.id = node_name.id INNER JOIN symbol ON node.id = symbol.id "
+		"WHERE node_name.name_lower >= ? AND node_name.name_lower < ?;";
+	const std::string lowerBound = ignoreCase ? utility::toLowerCase(prefix) : prefix;
+	const std::string upperBound = lowerBound + '\xff';
+	CppSQLite3Statement& statement = getReadStatement(ignoreCase ? ignoreCaseQuery : query);
+	bindText(statement, 1, lowerBound);
+	bindText(statement, 2, upperBound);
+	return querySymbolNodes(statement, true);
+}
+
+std::vector<StorageSymbolNode> DatabaseStorage::findSymbolNodesByNameSubstring(const std::string& substring) const
+{
+	// scans the names of the last elements only, which are much shorter than the serialized names
+	static const std::string query =
+		"SELECT node.id, node.type, node.serialized_name, symbol.definition_kind FROM node_name "
+		"CROSS JOIN node ON node.id = node_name.id INNER JOIN symbol ON node.id = symbol.id "
+		"WHERE instr(node_name.name, ?) > 0;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, substring);
+	return querySymbolNodes(statement, true);
+}
+
+void DatabaseStorage::forEachSymbolNode(
+	const std::function<bool(const StorageSymbolNode&)>& visitor, bool withSerializedNames, int afterId, size_t limit) const
+{
+	// the symbol table drives the join, so the rows come in the order of its primary key without sorting
+	CppSQLite3Statement statement = compileStatement(
+		std::string("SELECT node.id, node.type, ") + (withSerializedNames ? "node.serialized_name, " : "") +
+		"symbol.definition_kind FROM symbol CROSS JOIN node ON node.id = symbol.id "
+		"WHERE symbol.id > ? ORDER BY symbol.id LIMIT ?;");
+	statement.bind(1, afterId);
+	statement.bind(2, limit ? static_cast<sqlite_int64>(limit) : -1); // a negative limit returns all rows
+	visitSymbolNodes(statement, withSerializedNames, visitor);
+}
+
+void DatabaseStorage::forEachEdge(const std::function<bool(const StorageEdge&)>& visitor, int afterId, size_t limit) const
+{
+	CppSQLite3Statement statement = compileStatement(
+		"SELECT id, type, source_node_id, target_node_id FROM edge WHERE id > ? ORDER BY id LIMIT ?;");
+	statement.bind(1, afterId);
+	statement.bind(2, limit ? static_cast<sqlite_int64>(limit) : -1);
+	visitEdges(statement, visitor);
+}
+
+void DatabaseStorage::forEachEdgeOfType(
+	int edgeKind, const std::function<bool(const StorageEdge&)>& visitor, int afterId, size_t limit) const
+{
+	CppSQLite3Statement statement = compileStatement(
+		"SELECT id, type, source_node_id, target_node_id FROM edge WHERE type = ? AND id > ? ORDER BY id LIMIT ?;");
+	statement.bind(1, edgeKind);
+	statement.bind(2, afterId);
+	statement.bind(3, limit ? static_cast<sqlite_int64>(limit) : -1);
+	visitEdges(statement, visitor);
+}
+
+// --- Targeted read helper implementations ---
+
+std::vector<StorageNode> DatabaseStorage::getNodesBySerializedNameExact(const std::string& serializedName) const
+{
+	static const std::string query = "SELECT id, type, serialized_name FROM node WHERE serialized_name = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, serializedName);
+	return queryNodes(statement);
 }
 
 std::vector<StorageNode> DatabaseStorage::getNodesBySerializedNameLike(const std::string& pattern) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node WHERE serialized_name LIKE '" + pattern + "';");
-	std::vector<StorageNode> nodes;
-	while (!q.eof())
-	{
-		const int id = q.getIntField(0, 0);
-		const int type = q.getIntField(1, -1);
-		const std::string ser = q.getStringField(2, "");
-		if (id != 0 && type != -1)
-		{
-			nodes.emplace_back(StorageNode(id, type, ser));
-		}
-		q.nextRow();
-	}
-	return nodes;
+	static const std::string query = "SELECT id, type, serialized_name FROM node WHERE serialized_name LIKE ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	bindText(statement, 1, pattern);
+	return queryNodes(statement);
 }
 
 StorageNode DatabaseStorage::getNodeById(int nodeId) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, serialized_name FROM node WHERE id = " + std::to_string(nodeId) + " LIMIT 1;");
+	static const std::string query = "SELECT id, type, serialized_name FROM node WHERE id = ? LIMIT 1;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, nodeId);
+	const std::vector<StorageNode> nodes = queryNodes(statement);
+	return nodes.empty() ? StorageNode(0, -1, "") : nodes.front();
+}
+
+std::string DatabaseStorage::getFileContent(int fileId) const
+{
+	// databases written before the filecontent_ref table was introduced store the content of every file
+	static const std::string query = "SELECT content FROM filecontent WHERE id = ? LIMIT 1;";
+	static const std::string refQuery =
+		"SELECT content FROM filecontent "
+		"WHERE id = COALESCE((SELECT content_file_id FROM filecontent_ref WHERE file_id = ?1), ?1) LIMIT 1;";
+	CppSQLite3Statement& statement = getReadStatement(getSchemaObjectType("filecontent_ref") == "table" ? refQuery : query);
+	statement.bind(1, fileId);
+
+	std::string content;
+	CppSQLite3Query q = executeQuery(statement);
 	if (!q.eof())
 	{
-		const int id = q.getIntField(0, 0);
-		const int type = q.getIntField(1, -1);
-		const std::string ser = q.getStringField(2, "");
-		if (id != 0 && type != -1)
+		int contentSize = 0;
+		const unsigned char* data = q.getBlobField(0, contentSize);
+		if (data != nullptr)
 		{
-			return StorageNode(id, type, ser);
+			content.assign(reinterpret_cast<const char*>(data), contentSize);
 		}
 	}
-	return StorageNode(0, -1, "");
+	statement.reset();
+	return content;
 }
 
 int DatabaseStorage::getDefinitionKindForSymbol(int symbolId) const
 {
-	CppSQLite3Query q = executeQuery("SELECT definition_kind FROM symbol WHERE id = " + std::to_string(symbolId) + " LIMIT 1;");
+	static const std::string query = "SELECT definition_kind FROM symbol WHERE id = ? LIMIT 1;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, symbolId);
+
+	int definitionKind = -1;
+	CppSQLite3Query q = executeQuery(statement);
 	if (!q.eof())
 	{
-		return q.getIntField(0, -1);
+		definitionKind = q.getIntField(0, -1);
 	}
-	return -1;
+	statement.reset();
+	return definitionKind;
 }
 
 std::vector<StorageEdge> DatabaseStorage::getEdgesFromNode(int sourceNodeId) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, source_node_id, target_node_id FROM edge WHERE source_node_id = " + std::to_string(sourceNodeId) + ";");
-	std::vector<StorageEdge> edges;
-	while (!q.eof())
-	{
-		const int id = q.getIntField(0, 0);
-		const int kind = q.getIntField(1, -1);
-		const int src = q.getIntField(2, 0);
-		const int tgt = q.getIntField(3, 0);
-		if (id != 0 && kind != -1)
-		{
-			edges.emplace_back(StorageEdge(id, src, tgt, kind));
-		}
-		q.nextRow();
-	}
-	return edges;
+	static const std::string query = "SELECT id, type, source_node_id, target_node_id FROM edge WHERE source_node_id = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, sourceNodeId);
+	return queryEdges(statement);
 }
 
 std::vector<StorageEdge> DatabaseStorage::getEdgesToNode(int targetNodeId) const
 {
-	std::vector<StorageEdge> edges;
-#if 0
-	// First determine how many rows will be returned so we can reserve capacity.
-	int edgeCount = 0;
-	{
-		CppSQLite3Query cq = executeQuery("SELECT COUNT(*) FROM edge WHERE target_node_id = " + std::to_string(targetNodeId) + ";");
-		if (!cq.eof())
-		{
-			edgeCount = cq.getIntField(0, 0);
-		}
-	}
-
-	// Print the count (basic diagnostic / instrumentation output).
-	std::cout << "[DatabaseStorage] getEdgesToNode targetNodeId=" << targetNodeId << " count=" << edgeCount << std::endl;
-
-
-	edges.reserve(edgeCount);
-#endif
-
-	CppSQLite3Query q = executeQuery("SELECT id, type, source_node_id, target_node_id FROM edge WHERE target_node_id = " + std::to_string(targetNodeId) + ";");
-	while (!q.eof())
-	{
-		const int id = q.getIntField(0, 0);
-		const int kind = q.getIntField(1, -1);
-		const int src = q.getIntField(2, 0);
-		const int tgt = q.getIntField(3, 0);
-		if (id != 0 && kind != -1)
-		{
-			edges.emplace_back(StorageEdge(id, src, tgt, kind));
-		}
-		q.nextRow();
-	}
-	return edges;
+	static const std::string query = "SELECT id, type, source_node_id, target_node_id FROM edge WHERE target_node_id = ?;";
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, targetNodeId);
+	return queryEdges(statement);
 }
 
 std::vector<StorageEdge> DatabaseStorage::getEdgesByType(int edgeKind) const
 {
-	CppSQLite3Query q = executeQuery("SELECT id, type, source_node_id, target_node_id FROM edge WHERE type = " + std::to_string(edgeKind) + ";");
 	std::vector<StorageEdge> edges;
-	while (!q.eof())
-	{
-		const int id = q.getIntField(0, 0);
-		const int kind = q.getIntField(1, -1);
-		const int src = q.getIntField(2, 0);
-		const int tgt = q.getIntField(3, 0);
-		if (id != 0 && kind != -1)
-		{
-			edges.emplace_back(StorageEdge(id, src, tgt, kind));
-		}
-		q.nextRow();
-	}
+	forEachEdgeOfType(edgeKind, [&edges](const StorageEdge& edge) {
+		edges.push_back(edge);
+		return true;
+	});
 	return edges;
 }
 
@@ -1112,28 +2885,22 @@ std::vector<StorageEdge> DatabaseStorage::getEdgesFromNodeOfKinds(int sourceNode
 	{
 		return {};
 	}
-	std::string inClause;
-	for (size_t i = 0; i < kinds.size(); ++i)
+
+	// one placeholder per kind, so that each list length is compiled once
+	std::string query = "SELECT id, type, source_node_id, target_node_id FROM edge WHERE source_node_id = ? AND type IN (?";
+	for (size_t i = 1; i < kinds.size(); ++i)
 	{
-		if (i) inClause += ",";
-		inClause += std::to_string(kinds[i]);
+		query += ", ?";
 	}
-	CppSQLite3Query q = executeQuery(
-		"SELECT id, type, source_node_id, target_node_id FROM edge WHERE source_node_id = " + std::to_string(sourceNodeId) + " AND type IN (" + inClause + ");");
-	std::vector<StorageEdge> edges;
-	while (!q.eof())
+	query += ");";
+
+	CppSQLite3Statement& statement = getReadStatement(query);
+	statement.bind(1, sourceNodeId);
+	for (size_t i = 0; i < kinds.size(); ++i)
 	{
-		const int id = q.getIntField(0, 0);
-		const int kind = q.getIntField(1, -1);
-		const int src = q.getIntField(2, 0);
-		const int tgt = q.getIntField(3, 0);
-		if (id != 0 && kind != -1)
-		{
-			edges.emplace_back(StorageEdge(id, src, tgt, kind));
-		}
-		q.nextRow();
+		statement.bind(static_cast<int>(i) + 2, kinds[i]);
 	}
-	return edges;
+	return queryEdges(statement);
 }
 
 }	 // namespace sourcetrail
@@ -0,0 +1,206 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "MemoryMappedFile.h"
+
+#ifdef _WIN32
+#	ifndef NOMINMAX
+#		define NOMINMAX
+#	endif
+#	include <windows.h>
+#else
+#	include <errno.h>
+#	include <fcntl.h>
+#	include <sys/mman.h>
+#	include <sys/stat.h>
+#	include <unistd.h>
+#endif
+
+#include "SourcetrailException.h"
+
+namespace sourcetrail
+{
+namespace
+{
+SourcetrailException getReadException(const std::string& filePath, const std::string& reason)
+{
+	return SourcetrailException("Exception thrown while reading file \"" + filePath + "\": " + reason);
+}
+}	 // namespace
+
+#ifdef _WIN32
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filePath)
+	: m_data(nullptr), m_size(0), m_fileHandle(INVALID_HANDLE_VALUE), m_mappingHandle(nullptr)
+{
+	m_fileHandle = CreateFileA(
+		filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (m_fileHandle == INVALID_HANDLE_VALUE)
+	{
+		throw getReadException(filePath, "Could not open file");
+	}
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(m_fileHandle, &fileSize))
+	{
+		CloseHandle(m_fileHandle);
+		throw getReadException(filePath, "Could not determine size of file");
+	}
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+
+	if (m_size > 0 && m_size < MIN_MAPPED_SIZE)
+	{
+		// a file that shrinks while it is read is stored with the bytes it still has
+		m_buffer.resize(m_size);
+		size_t readSize = 0;
+		bool failed = false;
+		while (readSize < m_size)
+		{
+			DWORD chunkSize = 0;
+			if (!ReadFile(m_fileHandle, &m_buffer[readSize], static_cast<DWORD>(m_size - readSize), &chunkSize, nullptr))
+			{
+				failed = true;
+				break;
+			}
+			if (chunkSize == 0)
+			{
+				break;
+			}
+			readSize += chunkSize;
+		}
+		CloseHandle(m_fileHandle);
+		m_fileHandle = INVALID_HANDLE_VALUE;
+		if (failed)
+		{
+			throw getReadException(filePath, "Could not read file");
+		}
+		m_buffer.resize(readSize);
+		m_size = readSize;
+		m_data = m_size > 0 ? m_buffer.data() : nullptr;
+	}
+	else if (m_size > 0)
+	{
+		m_mappingHandle = CreateFileMappingA(m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (m_mappingHandle)
+		{
+			m_data = static_cast<const char*>(MapViewOfFile(m_mappingHandle, FILE_MAP_READ, 0, 0, 0));
+		}
+		if (!m_data)
+		{
+			if (m_mappingHandle)
+			{
+				CloseHandle(m_mappingHandle);
+			}
+			CloseHandle(m_fileHandle);
+			throw getReadException(filePath, "Could not map file");
+		}
+	}
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (m_mappingHandle)
+	{
+		UnmapViewOfFile(m_data);
+		CloseHandle(m_mappingHandle);
+	}
+	if (m_fileHandle != INVALID_HANDLE_VALUE)
+	{
+		CloseHandle(m_fileHandle);
+	}
+}
+
+#else
+
+MemoryMappedFile::MemoryMappedFile(const std::string& filePath): m_data(nullptr), m_size(0)
+{
+	const int fileDescriptor = ::open(filePath.c_str(), O_RDONLY);
+	if (fileDescriptor < 0)
+	{
+		throw getReadException(filePath, "Could not open file");
+	}
+
+	struct stat fileStatus;
+	if (fstat(fileDescriptor, &fileStatus) != 0)
+	{
+		::close(fileDescriptor);
+		throw getReadException(filePath, "Could not determine size of file");
+	}
+	m_size = static_cast<size_t>(fileStatus.st_size);
+
+	if (m_size > 0 && m_size < MIN_MAPPED_SIZE)
+	{
+		// a file that shrinks while it is read is stored with the bytes it still has
+		m_buffer.resize(m_size);
+		size_t readSize = 0;
+		while (readSize < m_size)
+		{
+			const ssize_t chunkSize = ::read(fileDescriptor, &m_buffer[readSize], m_size - readSize);
+			if (chunkSize < 0 && errno == EINTR)
+			{
+				continue;
+			}
+			if (chunkSize < 0)
+			{
+				::close(fileDescriptor);
+				throw getReadException(filePath, "Could not read file");
+			}
+			if (chunkSize == 0)
+			{
+				break;
+			}
+			readSize += static_cast<size_t>(chunkSize);
+		}
+		m_buffer.resize(readSize);
+		m_size = readSize;
+		m_data = m_size > 0 ? m_buffer.data() : nullptr;
+	}
+	else if (m_size > 0)
+	{
+		void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+		if (data == MAP_FAILED)
+		{
+			::close(fileDescriptor);
+			throw getReadException(filePath, "Could not map file");
+		}
+		madvise(data, m_size, MADV_SEQUENTIAL);
+		m_data = static_cast<const char*>(data);
+	}
+
+	// the mapping stays valid after the descriptor has been closed
+	::close(fileDescriptor);
+}
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+	if (m_data && m_buffer.empty())
+	{
+		munmap(const_cast<char*>(m_data), m_size);
+	}
+}
+
+#endif
+
+const char* MemoryMappedFile::getData() const
+{
+	return m_data;
+}
+
+size_t MemoryMappedFile::getSize() const
+{
+	return m_size;
+}
+}	 // namespace sourcetrail
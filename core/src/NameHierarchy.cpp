@@ -16,6 +16,8 @@
 
 #include "NameHierarchy.h"
 
+#include "NameHierarchyBuilder.h"
+
 #include "json.hpp"
 
 namespace sourcetrail
@@ -103,23 +105,61 @@ NameHierarchy deserializeNameHierarchyFromJson(const std::string& serializedName
 	return nameHierarchy;
 }
 
-std::string serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy)
+namespace
 {
-	static std::string META_DELIMITER = "\tm";
-	static std::string NAME_DELIMITER = "\tn";
-	static std::string PARTS_DELIMITER = "\ts";
-	static std::string SIGNATURE_DELIMITER = "\tp";
+const std::string META_DELIMITER = "\tm";
+const std::string NAME_DELIMITER = "\tn";
+const std::string PARTS_DELIMITER = "\ts";
+const std::string SIGNATURE_DELIMITER = "\tp";
+}	 // namespace
 
-	std::string serialized = nameHierarchy.nameDelimiter + META_DELIMITER;
+std::string serializeNameHierarchyToDatabaseString(const NameHierarchy& nameHierarchy)
+{
+	std::string serialized;
+	beginNameHierarchyDatabaseString(serialized, nameHierarchy.nameDelimiter);
 	for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
 	{
-		if (i != 0)
-		{
-			serialized += NAME_DELIMITER;
-		}
-		const NameElement& nameElement = nameHierarchy.nameElements[i];
-		serialized += nameElement.name + PARTS_DELIMITER + nameElement.prefix + SIGNATURE_DELIMITER + nameElement.postfix;
+		appendNameElementToDatabaseString(serialized, nameHierarchy.nameElements[i], i == 0);
 	}
 	return serialized;
 }
+
+void beginNameHierarchyDatabaseString(std::string& serialized, const std::string& nameDelimiter)
+{
+	serialized.assign(nameDelimiter);
+	serialized += META_DELIMITER;
+}
+
+void appendNameElementToDatabaseString(std::string& serialized, const NameElement& nameElement, bool isFirstElement)
+{
+	if (!isFirstElement)
+	{
+		serialized += NAME_DELIMITER;
+	}
+	serialized += nameElement.name;
+	serialized += PARTS_DELIMITER;
+	serialized += nameElement.prefix;
+	serialized += SIGNATURE_DELIMITER;
+	serialized += nameElement.postfix;
+}
+
+void beginNameHierarchyDatabaseString(std::string& serialized, const NameHierarchyBuilder::StringRef& nameDelimiter)
+{
+	serialized.assign(nameDelimiter.data, nameDelimiter.size);
+	serialized += META_DELIMITER;
+}
+
+void appendNameElementToDatabaseString(
+	std::string& serialized, const NameHierarchyBuilder::Element& nameElement, bool isFirstElement)
+{
+	if (!isFirstElement)
+	{
+		serialized += NAME_DELIMITER;
+	}
+	serialized.append(nameElement.name.data, nameElement.name.size);
+	serialized += PARTS_DELIMITER;
+	serialized.append(nameElement.prefix.data, nameElement.prefix.size);
+	serialized += SIGNATURE_DELIMITER;
+	serialized.append(nameElement.postfix.data, nameElement.postfix.size);
+}
 }	 // namespace sourcetrail
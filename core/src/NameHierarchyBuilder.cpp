@@ -0,0 +1,163 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NameHierarchyBuilder.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "SourcetrailException.h"
+
+namespace
+{
+// the arena grows in blocks of doubling size, strings longer than a block get a block of their own
+const size_t MIN_ARENA_BLOCK_SIZE = 4096;
+const size_t MAX_ARENA_BLOCK_SIZE = 65536;
+}	 // namespace
+
+namespace sourcetrail
+{
+NameHierarchyBuilder::NameHierarchyBuilder(const std::string& nameDelimiter)
+{
+	m_nameDelimiter = intern(nameDelimiter);
+}
+
+void NameHierarchyBuilder::clear()
+{
+	m_nameElements.clear();
+}
+
+void NameHierarchyBuilder::setNameDelimiter(const std::string& nameDelimiter)
+{
+	m_nameDelimiter = intern(nameDelimiter);
+}
+
+void NameHierarchyBuilder::pushNameElement(const std::string& name)
+{
+	const StringRef empty = {"", 0};
+	m_nameElements.push_back(Element {empty, intern(name), empty});
+}
+
+void NameHierarchyBuilder::pushNameElement(const char* name, size_t nameSize)
+{
+	const StringRef empty = {"", 0};
+	m_nameElements.push_back(Element {empty, intern(name, nameSize), empty});
+}
+
+void NameHierarchyBuilder::pushNameElement(const std::string& prefix, const std::string& name, const std::string& postfix)
+{
+	m_nameElements.push_back(Element {intern(prefix), intern(name), intern(postfix)});
+}
+
+void NameHierarchyBuilder::popNameElement()
+{
+	if (m_nameElements.empty())
+	{
+		throw SourcetrailException("Unable to remove name element, because the name hierarchy is empty.");
+	}
+	m_nameElements.pop_back();
+}
+
+NameHierarchyBuilder::StringRef NameHierarchyBuilder::getNameDelimiter() const
+{
+	return m_nameDelimiter;
+}
+
+size_t NameHierarchyBuilder::getNameElementCount() const
+{
+	return m_nameElements.size();
+}
+
+const NameHierarchyBuilder::Element& NameHierarchyBuilder::getNameElement(size_t index) const
+{
+	return m_nameElements[index];
+}
+
+NameHierarchy NameHierarchyBuilder::toNameHierarchy() const
+{
+	NameHierarchy nameHierarchy;
+	nameHierarchy.nameDelimiter.assign(m_nameDelimiter.data, m_nameDelimiter.size);
+	nameHierarchy.nameElements.reserve(m_nameElements.size());
+	for (const Element& element: m_nameElements)
+	{
+		nameHierarchy.nameElements.push_back(NameElement {
+			std::string(element.prefix.data, element.prefix.size),
+			std::string(element.name.data, element.name.size),
+			std::string(element.postfix.data, element.postfix.size)});
+	}
+	return nameHierarchy;
+}
+
+size_t NameHierarchyBuilder::getInternedStringCount() const
+{
+	return m_internedStrings.size();
+}
+
+size_t NameHierarchyBuilder::StringRefHash::operator()(const StringRef& stringRef) const
+{
+	// FNV-1a
+	uint64_t hash = 14695981039346656037ULL;
+	for (size_t i = 0; i < stringRef.size; i++)
+	{
+		hash ^= static_cast<unsigned char>(stringRef.data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return static_cast<size_t>(hash);
+}
+
+bool NameHierarchyBuilder::StringRefEqual::operator()(const StringRef& a, const StringRef& b) const
+{
+	return a.size == b.size && std::memcmp(a.data, b.data, a.size) == 0;
+}
+
+NameHierarchyBuilder::StringRef NameHierarchyBuilder::intern(const std::string& str)
+{
+	return intern(str.data(), str.size());
+}
+
+NameHierarchyBuilder::StringRef NameHierarchyBuilder::intern(const char* data, size_t size)
+{
+	if (size == 0)
+	{
+		return StringRef {"", 0};
+	}
+
+	// the lookup references the caller's buffer, only new strings are copied to the arena
+	std::unordered_set<StringRef, StringRefHash, StringRefEqual>::const_iterator it =
+		m_internedStrings.find(StringRef {data, size});
+	if (it != m_internedStrings.end())
+	{
+		return *it;
+	}
+
+	if (m_arenaBlocks.empty() || m_arenaBlockSize - m_arenaBlockUsed < size)
+	{
+		m_arenaBlockSize = std::max(
+			std::min(std::max(m_arenaBlockSize * 2, MIN_ARENA_BLOCK_SIZE), MAX_ARENA_BLOCK_SIZE), size);
+		m_arenaBlocks.push_back(std::unique_ptr<char[]>(new char[m_arenaBlockSize]));
+		m_arenaBlockUsed = 0;
+	}
+
+	char* arenaData = m_arenaBlocks.back().get() + m_arenaBlockUsed;
+	std::memcpy(arenaData, data, size);
+	m_arenaBlockUsed += size;
+
+	const StringRef stringRef = {arenaData, size};
+	m_internedStrings.insert(stringRef);
+	return stringRef;
+}
+}	 // namespace sourcetrail
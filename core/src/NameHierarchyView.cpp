@@ -0,0 +1,200 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "NameHierarchyView.h"
+
+namespace
+{
+// second characters of the delimiters "\tm", "\tn", "\ts" and "\tp" of the database format
+const char META_DELIMITER = 'm';
+const char NAME_DELIMITER = 'n';
+const char PARTS_DELIMITER = 's';
+const char SIGNATURE_DELIMITER = 'p';
+const size_t DELIMITER_SIZE = 2;
+
+// names without meta delimiter are shown with the delimiter of C++
+const char DEFAULT_NAME_DELIMITER[] = "::";
+
+// returns the position of the delimiter in [begin, end) or end if it is not found, the search must not leave the
+// serialized name because the buffer may contain further names
+size_t findDelimiter(const std::string& buffer, char delimiter, size_t begin, size_t end)
+{
+	for (size_t i = begin; i + 1 < end; i++)
+	{
+		if (buffer[i] == '\t' && buffer[i + 1] == delimiter)
+		{
+			return i;
+		}
+	}
+	return end;
+}
+}	 // namespace
+
+namespace sourcetrail
+{
+NameHierarchyView::NameHierarchyView()
+	: m_serializedName {0, 0}, m_decoded(false), m_hasNameDelimiter(false), m_nameDelimiter {0, 0}
+{
+}
+
+NameHierarchyView::NameHierarchyView(const std::string& serializedName)
+	: NameHierarchyView(std::make_shared<const std::string>(serializedName), 0, serializedName.size())
+{
+}
+
+NameHierarchyView::NameHierarchyView(std::shared_ptr<const std::string> buffer, size_t offset, size_t size)
+	: m_buffer(std::move(buffer))
+	, m_serializedName {offset, size}
+	, m_decoded(false)
+	, m_hasNameDelimiter(false)
+	, m_nameDelimiter {0, 0}
+{
+}
+
+NameHierarchyView::StringRef NameHierarchyView::getSerializedName() const
+{
+	return toStringRef(m_serializedName);
+}
+
+NameHierarchyView::StringRef NameHierarchyView::getNameDelimiter() const
+{
+	decode();
+	if (!m_hasNameDelimiter)
+	{
+		return StringRef {DEFAULT_NAME_DELIMITER, sizeof(DEFAULT_NAME_DELIMITER) - 1};
+	}
+	return toStringRef(m_nameDelimiter);
+}
+
+size_t NameHierarchyView::getNameElementCount() const
+{
+	decode();
+	return m_nameElements.size();
+}
+
+NameHierarchyView::Element NameHierarchyView::getNameElement(size_t index) const
+{
+	decode();
+	const ElementRanges& element = m_nameElements[index];
+	return Element {toStringRef(element.prefix), toStringRef(element.name), toStringRef(element.postfix)};
+}
+
+std::string NameHierarchyView::getQualifiedName() const
+{
+	decode();
+	const StringRef nameDelimiter = getNameDelimiter();
+
+	std::string qualifiedName;
+	for (size_t i = 0; i < m_nameElements.size(); i++)
+	{
+		if (i)
+		{
+			qualifiedName.append(nameDelimiter.data, nameDelimiter.size);
+		}
+		const StringRef name = toStringRef(m_nameElements[i].name);
+		qualifiedName.append(name.data, name.size);
+	}
+	return qualifiedName;
+}
+
+NameHierarchy NameHierarchyView::toNameHierarchy() const
+{
+	decode();
+	const StringRef nameDelimiter = getNameDelimiter();
+
+	NameHierarchy nameHierarchy;
+	nameHierarchy.nameDelimiter.assign(nameDelimiter.data, nameDelimiter.size);
+	nameHierarchy.nameElements.reserve(m_nameElements.size());
+	for (const ElementRanges& element: m_nameElements)
+	{
+		const StringRef prefix = toStringRef(element.prefix);
+		const StringRef name = toStringRef(element.name);
+		const StringRef postfix = toStringRef(element.postfix);
+		nameHierarchy.nameElements.push_back(NameElement {
+			std::string(prefix.data, prefix.size), std::string(name.data, name.size), std::string(postfix.data, postfix.size)});
+	}
+	return nameHierarchy;
+}
+
+void NameHierarchyView::decode() const
+{
+	if (m_decoded)
+	{
+		return;
+	}
+	m_decoded = true;
+
+	if (!m_buffer || m_serializedName.size == 0)
+	{
+		return;
+	}
+
+	const std::string& buffer = *m_buffer;
+	const size_t begin = m_serializedName.offset;
+	const size_t end = begin + m_serializedName.size;
+	const Range empty = {begin, 0};
+
+	const size_t metaPos = findDelimiter(buffer, META_DELIMITER, begin, end);
+	if (metaPos == end)
+	{
+		// not in database format, the whole name is a single element
+		m_nameElements.push_back(ElementRanges {empty, m_serializedName, empty});
+		return;
+	}
+
+	m_hasNameDelimiter = true;
+	m_nameDelimiter = Range {begin, metaPos - begin};
+
+	size_t cursor = metaPos + DELIMITER_SIZE;
+	while (cursor < end)
+	{
+		const size_t partsPos = findDelimiter(buffer, PARTS_DELIMITER, cursor, end);
+		if (partsPos == end)
+		{
+			break;	  // malformed
+		}
+		const size_t signaturePos = findDelimiter(buffer, SIGNATURE_DELIMITER, partsPos + DELIMITER_SIZE, end);
+		if (signaturePos == end)
+		{
+			break;	  // malformed
+		}
+		const size_t postfixBegin = signaturePos + DELIMITER_SIZE;
+		const size_t namePos = findDelimiter(buffer, NAME_DELIMITER, postfixBegin, end);
+
+		ElementRanges element;
+		element.name = Range {cursor, partsPos - cursor};
+		element.prefix = Range {partsPos + DELIMITER_SIZE, signaturePos - partsPos - DELIMITER_SIZE};
+		element.postfix = Range {postfixBegin, namePos - postfixBegin};
+		m_nameElements.push_back(element);
+
+		cursor = namePos == end ? end : namePos + DELIMITER_SIZE;
+	}
+
+	if (m_nameElements.empty())
+	{
+		m_nameElements.push_back(ElementRanges {empty, m_serializedName, empty});
+	}
+}
+
+NameHierarchyView::StringRef NameHierarchyView::toStringRef(const Range& range) const
+{
+	if (!m_buffer)
+	{
+		return StringRef {"", 0};
+	}
+	return StringRef {m_buffer->data() + range.offset, range.size};
+}
+}	 // namespace sourcetrail
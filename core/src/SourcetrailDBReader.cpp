@@ -21,84 +21,15 @@
 #include <set>
 
 #include "DatabaseStorage.h"
+#include "NameHierarchyView.h"
+#include "SourcetrailException.h"
 #include "version.h"
 #include "NodeKind.h"
+#include "utility.h"
 
 namespace sourcetrail
 {
 
-// Properly deserialize a serialized name hierarchy (mirrors logic from main Sourcetrail app)
-static NameHierarchy parseSerializedNameHierarchy(const std::string& serializedName)
-{
-    static const std::string META_DELIMITER = "\tm";      // separates delimiter from first element
-    static const std::string NAME_DELIMITER = "\tn";      // separates name elements
-    static const std::string PART_DELIMITER = "\ts";      // separates name from prefix
-    static const std::string SIGNATURE_DELIMITER = "\tp"; // separates prefix from postfix
-
-    NameHierarchy hierarchy;
-
-    // Find meta delimiter to extract the hierarchy delimiter (e.g. "::")
-    size_t mpos = serializedName.find(META_DELIMITER);
-    if (mpos == std::string::npos)
-    {
-        // Fallback: treat entire string as a single element
-        hierarchy.nameDelimiter = "::";
-        if (!serializedName.empty())
-        {
-            NameElement e;
-            e.name = serializedName; 
-            hierarchy.nameElements.push_back(std::move(e));
-        }
-        return hierarchy;
-    }
-
-    hierarchy.nameDelimiter = serializedName.substr(0, mpos);
-    size_t cursor = mpos + META_DELIMITER.size();
-
-    while (cursor < serializedName.size())
-    {
-        // name up to PART_DELIMITER
-        size_t spos = serializedName.find(PART_DELIMITER, cursor);
-        if (spos == std::string::npos) break; // malformed
-        std::string name = serializedName.substr(cursor, spos - cursor);
-        spos += PART_DELIMITER.size();
-
-        // prefix up to SIGNATURE_DELIMITER
-        size_t ppos = serializedName.find(SIGNATURE_DELIMITER, spos);
-        if (ppos == std::string::npos) break; // malformed
-        std::string prefix = serializedName.substr(spos, ppos - spos);
-        ppos += SIGNATURE_DELIMITER.size();
-
-        // postfix up to NAME_DELIMITER (or end)
-        size_t npos = serializedName.find(NAME_DELIMITER, ppos);
-        std::string postfix;
-        if (npos == std::string::npos)
-        {
-            postfix = serializedName.substr(ppos);
-            cursor = serializedName.size();
-        }
-        else
-        {
-            postfix = serializedName.substr(ppos, npos - ppos);
-            cursor = npos + NAME_DELIMITER.size();
-        }
-
-        NameElement element;
-        element.name = std::move(name);
-        element.prefix = std::move(prefix);
-        element.postfix = std::move(postfix);
-        hierarchy.nameElements.push_back(std::move(element));
-    }
-
-    // Fallback: if nothing parsed, keep whole string
-    if (hierarchy.nameElements.empty() && !serializedName.empty())
-    {
-        NameElement e; e.name = serializedName; hierarchy.nameElements.push_back(std::move(e));
-    }
-
-    return hierarchy;
-}
-
 // Convert stored NodeKind bitmask integer to SymbolKind enum (previous code wrongly cast bitmask)
 static SymbolKind nodeKindIntToSymbolKind(int nodeKindInt)
 {
@@ -129,6 +60,78 @@ static SymbolKind nodeKindIntToSymbolKind(int nodeKindInt)
     }
 }
 
+static DefinitionKind storageDefinitionKindToDefinitionKind(int definitionKind)
+{
+    return definitionKind >= 0 ? static_cast<DefinitionKind>(definitionKind) : DefinitionKind::EXPLICIT;
+}
+
+// Decode a node that has been read together with its definition kind
+static SourcetrailDBReader::Symbol storageSymbolNodeToSymbol(const StorageSymbolNode& node, const NameHierarchyView& name)
+{
+    SourcetrailDBReader::Symbol symbol;
+    symbol.id = node.id;
+    symbol.nameHierarchy = name.toNameHierarchy();
+    symbol.symbolKind = nodeKindIntToSymbolKind(node.nodeKind);
+    symbol.definitionKind = storageDefinitionKindToDefinitionKind(node.definitionKind);
+    return symbol;
+}
+
+static SourcetrailDBReader::Symbol storageSymbolNodeToSymbol(const StorageSymbolNode& node)
+{
+    return storageSymbolNodeToSymbol(node, NameHierarchyView(node.serializedName));
+}
+
+static std::string getLastElementName(const NameHierarchyView& view)
+{
+    const size_t elementCount = view.getNameElementCount();
+    if (!elementCount) return std::string();
+    const NameHierarchyView::StringRef name = view.getNameElement(elementCount - 1).name;
+    return std::string(name.data, name.size);
+}
+
+namespace
+{
+// Copies serialized names into shared buffers, so that the views of many symbols need a single allocation. A buffer
+// is never reallocated, every name that does not fit anymore starts a new one.
+class NameBuffer
+{
+public:
+    NameHierarchyView add(const std::string& serializedName)
+    {
+        static const size_t BUFFER_SIZE = 65536;
+        if (!m_buffer || m_buffer->size() + serializedName.size() > m_buffer->capacity())
+        {
+            m_buffer = std::make_shared<std::string>();
+            m_buffer->reserve(std::max(BUFFER_SIZE, serializedName.size()));
+        }
+        const size_t offset = m_buffer->size();
+        m_buffer->append(serializedName);
+        return NameHierarchyView(m_buffer, offset, serializedName.size());
+    }
+
+private:
+    std::shared_ptr<std::string> m_buffer;
+};
+}
+
+static SourcetrailDBReader::SymbolView storageSymbolNodeToSymbolView(const StorageSymbolNode& node, NameBuffer& nameBuffer)
+{
+    SourcetrailDBReader::SymbolView symbol;
+    symbol.id = node.id;
+    symbol.name = nameBuffer.add(node.serializedName);
+    symbol.symbolKind = nodeKindIntToSymbolKind(node.nodeKind);
+    symbol.definitionKind = storageDefinitionKindToDefinitionKind(node.definitionKind);
+    return symbol;
+}
+
+static void storageEdgeToReference(const StorageEdge& edge, SourcetrailDBReader::Reference& reference)
+{
+    reference.id = edge.id;
+    reference.sourceSymbolId = edge.sourceNodeId;
+    reference.targetSymbolId = edge.targetNodeId;
+    reference.edgeKind = intToEdgeKind(edge.edgeKind);
+}
+
 SourcetrailDBReader::SourcetrailDBReader()
 {
 }
@@ -154,12 +157,17 @@ const std::string& SourcetrailDBReader::getLastError() const
 }
 
 bool SourcetrailDBReader::open(const std::string& databaseFilePath)
+{
+    return open(databaseFilePath, getStorageOptions(StorageProfile::DEFAULT));
+}
+
+bool SourcetrailDBReader::open(const std::string& databaseFilePath, const StorageOptions& storageOptions)
 {
     clearLastError();
 
     try
     {
-        m_databaseStorage = DatabaseStorage::openDatabase(databaseFilePath);
+        m_databaseStorage = DatabaseStorage::openDatabase(databaseFilePath, storageOptions);
         if (!m_databaseStorage)
         {
             setLastError("Failed to open database");
@@ -208,12 +216,11 @@ std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::getAllSymbols() co
     clearLastError();
     if (!isOpen()) { setLastError("Database is not open"); return symbols; }
     try {
-        // targeted: only fetch nodes that are actually symbols via helper
-        std::vector<StorageNode> storageNodes = m_databaseStorage->getAllSymbolNodes();
-        for (const auto& n : storageNodes) {
-            Symbol s; s.id = n.id; s.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); s.symbolKind = nodeKindIntToSymbolKind(n.nodeKind);
-            int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id); if (defKind >= 0) s.definitionKind = static_cast<DefinitionKind>(defKind); else s.definitionKind = DefinitionKind::EXPLICIT; symbols.push_back(std::move(s));
-        }
+        // one query yields node, type and definition kind of every symbol
+        m_databaseStorage->forEachSymbolNode([&](const StorageSymbolNode& n) {
+            symbols.push_back(storageSymbolNodeToSymbol(n));
+            return true;
+        }, true);
     } catch (const std::exception& e) { setLastError(std::string("Exception while getting symbols: ") + e.what()); }
     return symbols;
 }
@@ -224,21 +231,34 @@ std::vector<SourcetrailDBReader::SymbolBrief> SourcetrailDBReader::getAllSymbols
     clearLastError();
     if (!isOpen()) { setLastError("Database is not open"); return out; }
     try {
-        // Get all symbols via symbol table, then fetch definition kind directly.
-        std::vector<StorageNode> storageNodes = m_databaseStorage->getAllSymbolNodes();
-        out.reserve(storageNodes.size());
-        for (const auto& n : storageNodes) {
-            int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id);
-            if (defKind < 0) continue; // safety
-            SymbolBrief sb; sb.id = n.id; sb.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); sb.definitionKind = static_cast<DefinitionKind>(defKind);
+        // serialized names are neither read nor decoded for brief symbols
+        m_databaseStorage->forEachSymbolNode([&out](const StorageSymbolNode& n) {
+            if (n.definitionKind < 0) return true; // safety
+            SymbolBrief sb; sb.id = n.id; sb.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); sb.definitionKind = static_cast<DefinitionKind>(n.definitionKind);
             out.push_back(sb);
-        }
+            return true;
+        }, false);
     } catch (const std::exception& e) {
         setLastError(std::string("Exception while getting brief symbols: ") + e.what());
     }
     return out;
 }
 
+std::vector<SourcetrailDBReader::SymbolView> SourcetrailDBReader::getAllSymbolViews() const
+{
+    std::vector<SymbolView> symbols;
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return symbols; }
+    try {
+        NameBuffer nameBuffer;
+        m_databaseStorage->forEachSymbolNode([&](const StorageSymbolNode& n) {
+            symbols.push_back(storageSymbolNodeToSymbolView(n, nameBuffer));
+            return true;
+        }, true);
+    } catch (const std::exception& e) { setLastError(std::string("Exception while getting symbol views: ") + e.what()); }
+    return symbols;
+}
+
 SourcetrailDBReader::Symbol SourcetrailDBReader::getSymbolById(int symbolId) const
 {
     Symbol symbol;
@@ -252,12 +272,11 @@ SourcetrailDBReader::Symbol SourcetrailDBReader::getSymbolById(int symbolId) con
     }
 
     try {
-        StorageNode n = m_databaseStorage->getNodeById(symbolId);
+        const StorageSymbolNode n = m_databaseStorage->getSymbolNodeById(symbolId);
         if (n.id != 0) {
             // ensure it's actually a symbol
-            int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id);
-            if (defKind >= 0) {
-                symbol.id = n.id; symbol.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); symbol.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); symbol.definitionKind = static_cast<DefinitionKind>(defKind);
+            if (n.definitionKind >= 0) {
+                symbol = storageSymbolNodeToSymbol(n);
             } else { setLastError("Id " + std::to_string(symbolId) + " is not a symbol"); }
         } else { setLastError("Symbol with ID " + std::to_string(symbolId) + " not found"); }
     } catch (const std::exception& e) { setLastError(std::string("Exception while getting symbol by ID: ") + e.what()); }
@@ -278,16 +297,13 @@ std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByName(
 
         // If exactMatch, attempt direct serialized exact lookup first (fast path).
     if (exactMatch) {
-        std::vector<StorageNode> exactNodes = m_databaseStorage->getNodesBySerializedNameExact(name);
+        const std::vector<StorageSymbolNode> exactNodes = m_databaseStorage->getSymbolNodesBySerializedNameExact(name);
         std::set<int> addedIds;
         for (const auto& n : exactNodes) {
-            int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id);
-            if (defKind < 0) continue; // not a symbol
             if (!addedIds.insert(n.id).second) continue;
-            Symbol s; s.id = n.id; s.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); s.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); s.definitionKind = static_cast<DefinitionKind>(defKind);
-            // Build FQN to verify (safety)
-            std::string fqn; for (size_t i=0;i<s.nameHierarchy.nameElements.size();++i){ if(i) fqn+=s.nameHierarchy.nameDelimiter; fqn+=s.nameHierarchy.nameElements[i].name; }
-            if (fqn == name) matchingSymbols.push_back(std::move(s));
+            // Build FQN to verify (safety), names are only decoded for matches
+            const NameHierarchyView view(n.serializedName);
+            if (view.getQualifiedName() == name) matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
         }
         if (!matchingSymbols.empty()) return matchingSymbols; // success fast path
         // Fall through to suffix-based search if no exact hit (e.g., prefixes/postfixes present in DB)
@@ -300,15 +316,20 @@ std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByName(
     }
 
     try {
-        // The serialized_name column contains the full hierarchy encoding; for quick filtering we can pattern match.
-        // We use LIKE with %name% as heuristic and post-filter exact element name when needed.
-        std::string likePattern = "%" + name + "%";
-        std::vector<StorageNode> candidateNodes = m_databaseStorage->findSymbolNodesBySerializedNameLike(likePattern);
+        // The node_name table of newer databases holds the last element name of every node. Without it the
+        // serialized_name column, which contains the full hierarchy encoding, is matched with LIKE %name% as heuristic.
+        // Both ways post-filter the exact element name.
+        std::vector<StorageSymbolNode> candidateNodes;
+        if (m_databaseStorage->hasNodeNames()) {
+            candidateNodes = exactMatch ? m_databaseStorage->getSymbolNodesByName(name) : m_databaseStorage->findSymbolNodesByNameSubstring(name);
+        } else {
+            candidateNodes = m_databaseStorage->findSymbolNodesBySerializedNameLike("%" + name + "%");
+        }
         for (const auto& n : candidateNodes) {
-            Symbol s; s.id = n.id; s.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); s.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id); if (defKind >= 0) s.definitionKind = static_cast<DefinitionKind>(defKind); else s.definitionKind = DefinitionKind::EXPLICIT; 
-            std::string finalName = s.nameHierarchy.nameElements.empty()? std::string() : s.nameHierarchy.nameElements.back().name;
+            const NameHierarchyView view(n.serializedName);
+            const std::string finalName = getLastElementName(view);
             bool match = exactMatch ? (finalName == name) : (finalName.find(name) != std::string::npos);
-            if (match) matchingSymbols.push_back(std::move(s));
+            if (match) matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
         }
     } catch (const std::exception& e) { setLastError(std::string("Exception while searching symbols by name: ") + e.what()); }
 
@@ -316,6 +337,33 @@ std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByName(
 }
 
 
+std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByNamePrefix(const std::string& prefix, bool ignoreCase) const
+{
+    std::vector<Symbol> matchingSymbols;
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return matchingSymbols; }
+    try {
+        if (m_databaseStorage->hasNodeNames()) {
+            // the range seek on the index matches the prefix exactly, names are only decoded for matches
+            for (const auto& n : m_databaseStorage->findSymbolNodesByNamePrefix(prefix, ignoreCase)) {
+                matchingSymbols.push_back(storageSymbolNodeToSymbol(n));
+            }
+            return matchingSymbols;
+        }
+
+        // LIKE ignores the case of ASCII letters, so it finds a superset of the matches in older databases
+        const std::string lowerPrefix = utility::toLowerCase(prefix);
+        for (const auto& n : m_databaseStorage->findSymbolNodesBySerializedNameLike("%" + prefix + "%")) {
+            const NameHierarchyView view(n.serializedName);
+            const std::string finalName = getLastElementName(view);
+            bool match = ignoreCase ? utility::toLowerCase(finalName).compare(0, lowerPrefix.size(), lowerPrefix) == 0
+                                    : finalName.compare(0, prefix.size(), prefix) == 0;
+            if (match) matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
+        }
+    } catch (const std::exception& e) { setLastError(std::string("Exception while searching symbols by name prefix: ") + e.what()); }
+    return matchingSymbols;
+}
+
 std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByQualifiedName(const std::string& qualifiedPattern, bool exactMatch) const
 {
 	std::vector<Symbol> matchingSymbols;
@@ -366,39 +414,42 @@ std::vector<SourcetrailDBReader::Symbol> SourcetrailDBReader::findSymbolsByQuali
             // Detect delimiter actually used in input (support '.' or '::').
             std::string delim = (qualifiedPattern.find("::") != std::string::npos) ? std::string("::") : std::string(".");
             std::string serializedGuess = encodeSerialized(parts, delim);
-            std::vector<StorageNode> exactNodes = m_databaseStorage->getNodesBySerializedNameExact(serializedGuess);
+            const std::vector<StorageSymbolNode> exactNodes = m_databaseStorage->getSymbolNodesBySerializedNameExact(serializedGuess);
             std::set<int> addedIds;
             for (const auto& n : exactNodes) {
-                int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id);
-                if (defKind < 0) continue; // not a symbol
                 if (!addedIds.insert(n.id).second) continue;
-                Symbol s; s.id = n.id; s.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); s.symbolKind = nodeKindIntToSymbolKind(n.nodeKind); s.definitionKind = static_cast<DefinitionKind>(defKind);
                 // Build FQN to verify (safety)
-                std::string fqn; for (size_t i=0;i<s.nameHierarchy.nameElements.size();++i){ if(i) fqn+=s.nameHierarchy.nameDelimiter; fqn+=s.nameHierarchy.nameElements[i].name; }
-                if (fqn == qualifiedPattern) matchingSymbols.push_back(std::move(s));
+                const NameHierarchyView view(n.serializedName);
+                if (view.getQualifiedName() == qualifiedPattern) matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
             }
             if (!matchingSymbols.empty()) return matchingSymbols; // success fast path
             // Fall through to suffix-based search if no exact hit (e.g., prefixes/postfixes present in DB)
         }
 
-        // Fallback / non-exact path: query by tail element and filter.
+        // Fallback / non-exact path: query by tail element and filter. With the node_name table the tail and the
+        // element before it are index seeks, otherwise the serialized names are matched with LIKE.
         const std::string& tail = parts.back();
-        std::string likePattern = "%" + tail + "%";
-        std::vector<StorageNode> candidateNodes = m_databaseStorage->findSymbolNodesBySerializedNameLike(likePattern);
+        std::vector<StorageSymbolNode> candidateNodes;
+        if (!tail.empty() && m_databaseStorage->hasNodeNames()) {
+            const std::string& parentName = parts.size() > 1 ? parts[parts.size() - 2] : std::string();
+            candidateNodes = parentName.empty() ? m_databaseStorage->getSymbolNodesByName(tail)
+                                                : m_databaseStorage->getSymbolNodesByNameAndParentName(tail, parentName);
+        } else {
+            candidateNodes = m_databaseStorage->findSymbolNodesBySerializedNameLike("%" + tail + "%");
+        }
         for (const auto& n : candidateNodes) {
-            Symbol s; s.id=n.id; s.nameHierarchy = parseSerializedNameHierarchy(n.serializedName); s.symbolKind = nodeKindIntToSymbolKind(n.nodeKind);
-            int defKind = m_databaseStorage->getDefinitionKindForSymbol(n.id); if (defKind>=0) s.definitionKind = static_cast<DefinitionKind>(defKind); else s.definitionKind = DefinitionKind::EXPLICIT;
-            std::string fqn; fqn.reserve(qualifiedPattern.size()+8);
-            for (size_t i = 0; i < s.nameHierarchy.nameElements.size(); ++i) { if (i) fqn += s.nameHierarchy.nameDelimiter; fqn += s.nameHierarchy.nameElements[i].name; }
+            const NameHierarchyView view(n.serializedName);
+            const std::string fqn = view.getQualifiedName();
             if (exactMatch) {
-                if (fqn == qualifiedPattern) matchingSymbols.push_back(std::move(s));
+                if (fqn == qualifiedPattern) matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
             } else {
-                if (fqn == qualifiedPattern) { matchingSymbols.push_back(std::move(s)); continue; }
+                if (fqn == qualifiedPattern) { matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view)); continue; }
                 if (fqn.size() > qualifiedPattern.size()) {
                     if (fqn.compare(fqn.size() - qualifiedPattern.size(), qualifiedPattern.size(), qualifiedPattern) == 0) {
                         size_t prefixLen = fqn.size() - qualifiedPattern.size();
-                        if (prefixLen == 0 || (prefixLen >= s.nameHierarchy.nameDelimiter.size() && fqn.substr(prefixLen - s.nameHierarchy.nameDelimiter.size(), s.nameHierarchy.nameDelimiter.size()) == s.nameHierarchy.nameDelimiter)) {
-                            matchingSymbols.push_back(std::move(s));
+                        const NameHierarchyView::StringRef delimiter = view.getNameDelimiter();
+                        if (prefixLen == 0 || (prefixLen >= delimiter.size && fqn.compare(prefixLen - delimiter.size, delimiter.size, delimiter.data, delimiter.size) == 0)) {
+                            matchingSymbols.push_back(storageSymbolNodeToSymbol(n, view));
                         }
                     }
                 }
@@ -421,10 +472,8 @@ std::vector<SourcetrailDBReader::Reference> SourcetrailDBReader::getAllReference
     }
 
     try {
-        // All references (still may be large, future: add pagination). For now we keep previous behavior.
-        std::vector<StorageEdge> storageEdges = m_databaseStorage->getAll<StorageEdge>();
-        references.reserve(storageEdges.size());
-    for (const auto& e : storageEdges) { Reference r; r.id = e.id; r.sourceSymbolId = e.sourceNodeId; r.targetSymbolId = e.targetNodeId; r.edgeKind = intToEdgeKind(e.edgeKind); references.push_back(std::move(r)); }
+        // rows are decoded straight into the result, use forEachEdge() to page through large tables
+        m_databaseStorage->forEachEdge([&references](const StorageEdge& e) { Reference r; storageEdgeToReference(e, r); references.push_back(std::move(r)); return true; });
     } catch (const std::exception& e) { setLastError(std::string("Exception while getting references: ") + e.what()); }
 
     return references;
@@ -436,11 +485,10 @@ std::vector<SourcetrailDBReader::EdgeBrief> SourcetrailDBReader::getAllEdgesBrie
     clearLastError();
     if (!isOpen()) { setLastError("Database is not open"); return out; }
     try {
-        std::vector<StorageEdge> storageEdges = m_databaseStorage->getAll<StorageEdge>();
-        out.reserve(storageEdges.size());
-        for (const auto& e : storageEdges) {
+        m_databaseStorage->forEachEdge([&out](const StorageEdge& e) {
             EdgeBrief eb; eb.sourceSymbolId = e.sourceNodeId; eb.targetSymbolId = e.targetNodeId; eb.edgeKind = intToEdgeKind(e.edgeKind); out.push_back(eb);
-        }
+            return true;
+        });
     } catch (const std::exception& e) {
         setLastError(std::string("Exception while getting brief edges: ") + e.what());
     }
@@ -510,12 +558,67 @@ std::vector<SourcetrailDBReader::Reference> SourcetrailDBReader::getReferencesBy
         return references;
     }
 
-    try { auto edges = m_databaseStorage->getEdgesByType(edgeKindToInt(edgeKind)); for (const auto& e: edges) { Reference r; r.id = e.id; r.sourceSymbolId = e.sourceNodeId; r.targetSymbolId = e.targetNodeId; r.edgeKind = intToEdgeKind(e.edgeKind); references.push_back(std::move(r)); } }
+    try { m_databaseStorage->forEachEdgeOfType(edgeKindToInt(edgeKind), [&references](const StorageEdge& e) { Reference r; storageEdgeToReference(e, r); references.push_back(std::move(r)); return true; }); }
     catch (const std::exception& e) { setLastError(std::string("Exception while getting references by type: ") + e.what()); }
 
     return references;
 }
 
+bool SourcetrailDBReader::forEachSymbol(const SymbolVisitor& visitor, int afterId, size_t limit) const
+{
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return false; }
+    try {
+        m_databaseStorage->forEachSymbolNode([&](const StorageSymbolNode& n) { return visitor(storageSymbolNodeToSymbol(n)); }, true, afterId, limit);
+        return true;
+    }
+    catch (const SourcetrailException& e) { setLastError("Exception while visiting symbols: " + e.getMessage()); }
+    catch (const std::exception& e) { setLastError(std::string("Exception while visiting symbols: ") + e.what()); }
+    return false;
+}
+
+bool SourcetrailDBReader::forEachSymbolView(const SymbolViewVisitor& visitor, int afterId, size_t limit) const
+{
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return false; }
+    try {
+        NameBuffer nameBuffer; // buffers that the visitor does not keep views of are released while visiting
+        m_databaseStorage->forEachSymbolNode([&](const StorageSymbolNode& n) { return visitor(storageSymbolNodeToSymbolView(n, nameBuffer)); }, true, afterId, limit);
+        return true;
+    }
+    catch (const SourcetrailException& e) { setLastError("Exception while visiting symbols: " + e.getMessage()); }
+    catch (const std::exception& e) { setLastError(std::string("Exception while visiting symbols: ") + e.what()); }
+    return false;
+}
+
+bool SourcetrailDBReader::forEachEdge(const ReferenceVisitor& visitor, int afterId, size_t limit) const
+{
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return false; }
+    try {
+        Reference r; // reused for every row, its locations stay empty
+        m_databaseStorage->forEachEdge([&visitor, &r](const StorageEdge& e) { storageEdgeToReference(e, r); return visitor(r); }, afterId, limit);
+        return true;
+    }
+    catch (const SourcetrailException& e) { setLastError("Exception while visiting references: " + e.getMessage()); }
+    catch (const std::exception& e) { setLastError(std::string("Exception while visiting references: ") + e.what()); }
+    return false;
+}
+
+bool SourcetrailDBReader::forEachEdgeOfType(EdgeKind edgeKind, const ReferenceVisitor& visitor, int afterId, size_t limit) const
+{
+    clearLastError();
+    if (!isOpen()) { setLastError("Database is not open"); return false; }
+    try {
+        Reference r;
+        m_databaseStorage->forEachEdgeOfType(edgeKindToInt(edgeKind), [&visitor, &r](const StorageEdge& e) { storageEdgeToReference(e, r); return visitor(r); }, afterId, limit);
+        return true;
+    }
+    catch (const SourcetrailException& e) { setLastError("Exception while visiting references: " + e.getMessage()); }
+    catch (const std::exception& e) { setLastError(std::string("Exception while visiting references: ") + e.what()); }
+    return false;
+}
+
 std::vector<SourcetrailDBReader::File> SourcetrailDBReader::getAllFiles() const
 {
     std::vector<File> files;
@@ -568,6 +671,23 @@ SourcetrailDBReader::File SourcetrailDBReader::getFileById(int fileId) const
     return file;
 }
 
+std::string SourcetrailDBReader::getFileContent(int fileId) const
+{
+    clearLastError();
+
+    if (!isOpen())
+    {
+        setLastError("Database is not open");
+        return "";
+    }
+
+    try {
+        return m_databaseStorage->getFileContent(fileId);
+    } catch (const std::exception& e) { setLastError(std::string("Exception while getting file content: ") + e.what()); }
+
+    return "";
+}
+
 std::vector<SourcetrailDBReader::File> SourcetrailDBReader::findFilesByPath(const std::string& path, bool exactMatch) const
 {
     std::vector<File> matchingFiles;
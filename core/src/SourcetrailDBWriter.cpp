@@ -17,6 +17,7 @@
 #include "SourcetrailDBWriter.h"
 
 #include <algorithm>
+#include <chrono>
 #include <fstream>
 #include <vector>
 
@@ -35,11 +36,91 @@
 #include "utility.h"
 #include "version.h"
 
+namespace
+{
+const std::string BATCH_SAVEPOINT_NAME = "record_batch";
+
+size_t getRecordedBytes(const sourcetrail::NameHierarchy& nameHierarchy)
+{
+	size_t bytes = nameHierarchy.nameDelimiter.size();
+	for (const sourcetrail::NameElement& nameElement: nameHierarchy.nameElements)
+	{
+		bytes += nameElement.prefix.size() + nameElement.name.size() + nameElement.postfix.size();
+	}
+	return bytes;
+}
+
+size_t getRecordedBytes(const sourcetrail::NameHierarchyBuilder& nameHierarchy)
+{
+	size_t bytes = nameHierarchy.getNameDelimiter().size;
+	for (size_t i = 0; i < nameHierarchy.getNameElementCount(); i++)
+	{
+		const sourcetrail::NameHierarchyBuilder::Element& nameElement = nameHierarchy.getNameElement(i);
+		bytes += nameElement.prefix.size + nameElement.name.size + nameElement.postfix.size;
+	}
+	return bytes;
+}
+
+size_t getNameElementCount(const sourcetrail::NameHierarchy& nameHierarchy)
+{
+	return nameHierarchy.nameElements.size();
+}
+
+size_t getNameElementCount(const sourcetrail::NameHierarchyBuilder& nameHierarchy)
+{
+	return nameHierarchy.getNameElementCount();
+}
+
+void beginDatabaseString(std::string& serialized, const sourcetrail::NameHierarchy& nameHierarchy)
+{
+	sourcetrail::beginNameHierarchyDatabaseString(serialized, nameHierarchy.nameDelimiter);
+}
+
+void beginDatabaseString(std::string& serialized, const sourcetrail::NameHierarchyBuilder& nameHierarchy)
+{
+	sourcetrail::beginNameHierarchyDatabaseString(serialized, nameHierarchy.getNameDelimiter());
+}
+
+void appendToDatabaseString(std::string& serialized, const sourcetrail::NameHierarchy& nameHierarchy, size_t index)
+{
+	sourcetrail::appendNameElementToDatabaseString(serialized, nameHierarchy.nameElements[index], index == 0);
+}
+
+void appendToDatabaseString(std::string& serialized, const sourcetrail::NameHierarchyBuilder& nameHierarchy, size_t index)
+{
+	sourcetrail::appendNameElementToDatabaseString(serialized, nameHierarchy.getNameElement(index), index == 0);
+}
+
+size_t getRecordedBytes(const sourcetrail::SourceRange& sourceRange)
+{
+	return sizeof(sourceRange);
+}
+
+size_t getElapsedMilliseconds(std::chrono::steady_clock::time_point startTime)
+{
+	return static_cast<size_t>(
+		std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - startTime).count());
+}
+}	 // namespace
+
 namespace sourcetrail
 {
 // --- Public Interface ---
 
-SourcetrailDBWriter::SourcetrailDBWriter(): m_lastError("") {}
+SourcetrailDBWriter::SourcetrailDBWriter()
+	: m_storageOptions(getStorageOptions(StorageProfile::DEFAULT))
+	, m_lastError("")
+	, m_autoCommitEnabled(false)
+	, m_autoCommitOptions(AutoCommitOptions {0, 0, 0})
+	, m_pendingRecords(0)
+	, m_pendingBytes(0)
+	, m_commitStatistics(CommitStatistics {0, 0, 0.0, 0.0, 0.0})
+	, m_updatedFileId(0)
+	, m_staged(false)
+	, m_persistedChangeCount(0)
+	, m_recordDepth(0)
+{
+}
 
 SourcetrailDBWriter::~SourcetrailDBWriter() {}
 
@@ -69,8 +150,96 @@ void SourcetrailDBWriter::clearLastError()
 }
 
 bool SourcetrailDBWriter::open(const std::string& databaseFilePath)
+{
+	return open(databaseFilePath, getStorageOptions(StorageProfile::DEFAULT));
+}
+
+bool SourcetrailDBWriter::open(const std::string& databaseFilePath, const StorageOptions& storageOptions)
+{
+	if (storageOptions.queryOnly)
+	{
+		m_lastError = "Unable to open database, because the storage options do not allow writing.";
+		return false;
+	}
+
+	m_staged = false;
+	return openProject(databaseFilePath, storageOptions);
+}
+
+bool SourcetrailDBWriter::openStaged(const std::string& databaseFilePath, const StagingOptions& stagingOptions)
+{
+	const utility::FileStatus fileStatus = utility::getFileStatus(databaseFilePath);
+	const long long estimatedBytes = (fileStatus.exists ? fileStatus.size : 0) + stagingOptions.expectedBytes;
+	if (stagingOptions.memoryBudgetBytes > 0 && estimatedBytes > stagingOptions.memoryBudgetBytes)
+	{
+		m_lastError = "Unable to open database in memory, because its estimated size of " + std::to_string(estimatedBytes) +
+			" bytes exceeds the memory budget of " + std::to_string(stagingOptions.memoryBudgetBytes) + " bytes.";
+		return false;
+	}
+
+	m_staged = true;
+	return openProject(databaseFilePath, getStorageOptions(StorageProfile::BULK_INGEST));
+}
+
+bool SourcetrailDBWriter::persist(const PersistProgressCallback& progressCallback)
+{
+	if (!m_storage)
+	{
+		m_lastError = "Unable to persist database, because no database is currently open.";
+		return false;
+	}
+	if (!m_staged)
+	{
+		m_lastError = "Unable to persist database, because it has not been opened in memory.";
+		return false;
+	}
+	if (!m_savepoints.empty())
+	{
+		m_lastError = "Unable to persist database, because a savepoint is in progress.";
+		return false;
+	}
+	if (m_storage->isBulkLoading())
+	{
+		m_lastError = "Unable to persist database, because a bulk load is in progress.";
+		return false;
+	}
+	if (!m_autoCommitEnabled && m_storage->isInTransaction())
+	{
+		m_lastError = "Unable to persist database, because a transaction is in progress.";
+		return false;
+	}
+
+	try
+	{
+		if (m_autoCommitEnabled)
+		{
+			commitAutoCommitTransaction();
+		}
+		m_storage->saveDatabase(m_databaseFilePath, progressCallback);
+		m_persistedChangeCount = m_storage->getChangeCount();
+		if (m_autoCommitEnabled)
+		{
+			beginAutoCommitTransaction();
+		}
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+
+	return true;
+}
+
+bool SourcetrailDBWriter::isStaged() const
+{
+	return m_staged;
+}
+
+bool SourcetrailDBWriter::openProject(const std::string& databaseFilePath, const StorageOptions& storageOptions)
 {
 	m_databaseFilePath = databaseFilePath;
+	m_storageOptions = storageOptions;
 
 	m_projectFilePath = databaseFilePath;	 // FIXME: only find dot after last slash/backslash! otherwise it may be part of the file path
 	const size_t pos = m_projectFilePath.rfind('.');
@@ -220,6 +389,11 @@ bool SourcetrailDBWriter::beginTransaction()
 		m_lastError = "Unable to begin transaction, because no database is currently open.";
 		return false;
 	}
+	if (m_autoCommitEnabled)
+	{
+		m_lastError = "Unable to begin transaction, because auto commit is enabled.";
+		return false;
+	}
 
 	try
 	{
@@ -241,10 +415,16 @@ bool SourcetrailDBWriter::commitTransaction()
 		m_lastError = "Unable to commit transaction, because no database is currently open.";
 		return false;
 	}
+	if (m_autoCommitEnabled)
+	{
+		m_lastError = "Unable to commit transaction, because auto commit is enabled.";
+		return false;
+	}
 
 	try
 	{
-		m_storage->commitTransaction();
+		commitMeasured();
+		m_savepoints.clear();
 	}
 	catch (const SourcetrailException e)
 	{
@@ -262,6 +442,13 @@ bool SourcetrailDBWriter::rollbackTransaction()
 		m_lastError = "Unable to rollback transaction, because no database is currently open.";
 		return false;
 	}
+	if (m_autoCommitEnabled)
+	{
+		m_lastError = "Unable to rollback transaction, because auto commit is enabled.";
+		return false;
+	}
+
+	m_savepoints.clear();
 
 	try
 	{
@@ -276,17 +463,27 @@ bool SourcetrailDBWriter::rollbackTransaction()
 	return true;
 }
 
-bool SourcetrailDBWriter::optimizeDatabaseMemory()
+bool SourcetrailDBWriter::enableAutoCommit(const AutoCommitOptions& options)
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to optimize database memory, because no database is currently open.";
+		m_lastError = "Unable to enable auto commit, because no database is currently open.";
+		return false;
+	}
+	if (m_autoCommitEnabled)
+	{
+		m_autoCommitOptions = options;
+		return true;
+	}
+	if (m_storage->isInTransaction())
+	{
+		m_lastError = "Unable to enable auto commit, because a transaction is currently active.";
 		return false;
 	}
 
 	try
 	{
-		m_storage->optimizeDatabaseMemory();
+		beginAutoCommitTransaction();
 	}
 	catch (const SourcetrailException e)
 	{
@@ -294,246 +491,331 @@ bool SourcetrailDBWriter::optimizeDatabaseMemory()
 		return false;
 	}
 
+	m_autoCommitOptions = options;
+	m_autoCommitEnabled = true;
 	return true;
 }
 
-int SourcetrailDBWriter::recordSymbol(const NameHierarchy& nameHierarchy)
+bool SourcetrailDBWriter::disableAutoCommit()
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol, because no database is currently open.";
+		m_lastError = "Unable to disable auto commit, because no database is currently open.";
+		return false;
+	}
+	if (!m_autoCommitEnabled)
+	{
+		return true;
+	}
+	if (!m_savepoints.empty())
+	{
+		m_lastError = "Unable to disable auto commit, because savepoint \"" + m_savepoints.back().name + "\" is still active.";
 		return false;
 	}
 
 	try
 	{
-		return addNodeHierarchy(nameHierarchy);
+		commitAutoCommitTransaction();
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
-		return 0;
+		return false;
 	}
+
+	m_autoCommitEnabled = false;
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind)
+const SourcetrailDBWriter::CommitStatistics& SourcetrailDBWriter::getCommitStatistics() const
+{
+	return m_commitStatistics;
+}
+
+bool SourcetrailDBWriter::enableStatistics()
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol kind, because no database is currently open.";
+		m_lastError = "Unable to enable statistics, because no database is currently open.";
 		return false;
 	}
 
-	try
-	{
-		m_storage->addSymbol(StorageSymbol(symbolId, definitionKindToInt(definitionKind)));
-	}
-	catch (const SourcetrailException e)
+	m_storage->setStatisticsEnabled(true);
+	return true;
+}
+
+bool SourcetrailDBWriter::disableStatistics()
+{
+	if (!m_storage)
 	{
-		m_lastError = e.getMessage();
+		m_lastError = "Unable to disable statistics, because no database is currently open.";
 		return false;
 	}
 
+	m_storage->setStatisticsEnabled(false);
 	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolKind(int symbolId, SymbolKind symbolKind)
+StorageStatistics SourcetrailDBWriter::getStatistics() const
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol kind, because no database is currently open.";
+		return StorageStatistics();
+	}
+	return m_storage->getStatistics();
+}
+
+bool SourcetrailDBWriter::resetStatistics()
+{
+	if (!m_storage)
+	{
+		m_lastError = "Unable to reset statistics, because no database is currently open.";
 		return false;
 	}
 
-	try
+	m_storage->resetStatistics();
+	return true;
+}
+
+bool SourcetrailDBWriter::enableFileContentDeduplication()
+{
+	if (!m_storage)
 	{
-		m_storage->setNodeType(symbolId, nodeKindToInt(symbolKindToNodeKind(symbolKind)));
+		m_lastError = "Unable to enable file content deduplication, because no database is currently open.";
+		return false;
 	}
-	catch (const SourcetrailException e)
+
+	m_storage->setFileContentDeduplicationEnabled(true);
+	return true;
+}
+
+bool SourcetrailDBWriter::disableFileContentDeduplication()
+{
+	if (!m_storage)
 	{
-		m_lastError = e.getMessage();
+		m_lastError = "Unable to disable file content deduplication, because no database is currently open.";
 		return false;
 	}
 
+	m_storage->setFileContentDeduplicationEnabled(false);
 	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolLocation(int symbolId, const SourceRange& location)
+bool SourcetrailDBWriter::beginSavepoint(const std::string& name)
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol location, because no database is currently open.";
+		m_lastError = "Unable to begin savepoint, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::TOKEN);
-		return true;
+		m_storage->beginSavepoint(name);
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
 		return false;
 	}
+
+	m_savepoints.push_back(SavepointState {name, m_pendingRecords, m_pendingBytes});
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolScopeLocation(int symbolId, const SourceRange& location)
+bool SourcetrailDBWriter::releaseSavepoint(const std::string& name)
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol scope location, because no database is currently open.";
+		m_lastError = "Unable to release savepoint, because no database is currently open.";
+		return false;
+	}
+
+	std::vector<SavepointState>::iterator it = std::find_if(
+		m_savepoints.rbegin(), m_savepoints.rend(), [&name](const SavepointState& savepoint) {
+			return savepoint.name == name;
+		}).base();
+	if (it == m_savepoints.begin())
+	{
+		m_lastError = "Unable to release savepoint, because savepoint \"" + name + "\" does not exist.";
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::SCOPE);
-		return true;
+		m_storage->releaseSavepoint(name);
+		m_savepoints.erase(it - 1, m_savepoints.end());
+		onRecorded(0, 0);
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
 		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordSymbolSignatureLocation(int symbolId, const SourceRange& location)
+bool SourcetrailDBWriter::rollbackToSavepoint(const std::string& name)
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol signature location, because no database is currently open.";
+		m_lastError = "Unable to rollback to savepoint, because no database is currently open.";
+		return false;
+	}
+
+	std::vector<SavepointState>::iterator it = std::find_if(
+		m_savepoints.rbegin(), m_savepoints.rend(), [&name](const SavepointState& savepoint) {
+			return savepoint.name == name;
+		}).base();
+	if (it == m_savepoints.begin())
+	{
+		m_lastError = "Unable to rollback to savepoint, because savepoint \"" + name + "\" does not exist.";
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(symbolId, location, LocationKind::SIGNATURE);
-		return true;
+		m_storage->rollbackToSavepoint(name);
+		m_storage->releaseSavepoint(name);
+		m_pendingRecords = (it - 1)->pendingRecords;
+		m_pendingBytes = (it - 1)->pendingBytes;
+		m_savepoints.erase(it - 1, m_savepoints.end());
+		onRecorded(0, 0);
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
 		return false;
 	}
+
+	return true;
 }
 
-int SourcetrailDBWriter::recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+bool SourcetrailDBWriter::optimizeDatabaseMemory()
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record reference, because no database is currently open.";
-		return 0;
+		m_lastError = "Unable to optimize database memory, because no database is currently open.";
+		return false;
 	}
 
 	try
 	{
-		return addEdge(contextSymbolId, referencedSymbolId, referenceKindToEdgeKind(referenceKind));
+		m_storage->optimizeDatabaseMemory();
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
-		return 0;
+		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordReferenceLocation(int referenceId, const SourceRange& location)
+bool SourcetrailDBWriter::beginBulkLoad()
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol reference location, because no database is currently open.";
+		m_lastError = "Unable to begin bulk load, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(referenceId, location, LocationKind::TOKEN);
-		return true;
+		m_storage->beginBulkLoad();
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
 		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordReferenceIsAmbiguous(int referenceId)
+bool SourcetrailDBWriter::endBulkLoad()
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record ambiguity of reference, because no database is currently open.";
+		m_lastError = "Unable to end bulk load, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		addElementComponent(referenceId, ElementComponentKind::IS_AMBIGUOUS, "");
-		return false;
+		m_storage->endBulkLoad();
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
 		return false;
 	}
+
+	return true;
 }
 
-int SourcetrailDBWriter::recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location)
+bool SourcetrailDBWriter::mergeDatabase(const std::string& databaseFilePath)
 {
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol reference, because no database is currently open.";
-		return 0;
+		m_lastError = "Unable to merge database, because no database is currently open.";
+		return false;
 	}
 
 	try
 	{
-		NameHierarchy unsolvedSymbolName;
-		NameElement unsolvedSymbolNameElement;
-		unsolvedSymbolNameElement.name = "unsolved symbol";
-		unsolvedSymbolName.nameElements.push_back(unsolvedSymbolNameElement);
-		int unsolvedSymbolId = addNodeHierarchy(unsolvedSymbolName);
-		int referenceId = addEdge(contextSymbolId, unsolvedSymbolId, referenceKindToEdgeKind(referenceKind));
-		addSourceLocation(referenceId, location, LocationKind::UNSOLVED);
-		return referenceId;
+		m_storage->mergeDatabase(databaseFilePath, nodeKindToInt(NodeKind::UNKNOWN));
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
-		return 0;
+		return false;
 	}
+
+	return true;
 }
 
-bool SourcetrailDBWriter::recordQualifierLocation(int referencedSymbolId, const SourceRange& location)
+int SourcetrailDBWriter::recordSymbol(const NameHierarchy& nameHierarchy)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record symbol qualifier location, because no database is currently open.";
+		m_lastError = "Unable to record symbol, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		addSourceLocation(referencedSymbolId, location, LocationKind::QUALIFIER);
-		return true;
+		const int symbolId = addNodeHierarchy(nameHierarchy);
+		addElementFile(nameHierarchy);
+		onRecorded(1, getRecordedBytes(nameHierarchy));
+		return symbolId;
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
-		return false;
+		return 0;
 	}
 }
 
-int SourcetrailDBWriter::recordFile(const std::string& filePath)
+int SourcetrailDBWriter::recordSymbol(const NameHierarchyBuilder& nameHierarchy)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record file, because no database is currently open.";
+		m_lastError = "Unable to record symbol, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		return addFile(filePath);
+		const int symbolId = addNodeHierarchy(nameHierarchy);
+		addElementFile(nameHierarchy);
+		onRecorded(1, getRecordedBytes(nameHierarchy));
+		return symbolId;
 	}
 	catch (const SourcetrailException e)
 	{
@@ -542,17 +824,20 @@ int SourcetrailDBWriter::recordFile(const std::string& filePath)
 	}
 }
 
-bool SourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& languageIdentifier)
+bool SourcetrailDBWriter::recordSymbolDefinitionKind(int symbolId, DefinitionKind definitionKind)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record file language, because no database is currently open.";
+		m_lastError = "Unable to record symbol kind, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		m_storage->setFileLanguage(fileId, languageIdentifier);
+		m_storage->addSymbol(StorageSymbol(symbolId, definitionKindToInt(definitionKind)));
+		onRecorded(1, sizeof(StorageSymbol));
 	}
 	catch (const SourcetrailException e)
 	{
@@ -563,27 +848,404 @@ bool SourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& lang
 	return true;
 }
 
-int SourcetrailDBWriter::recordLocalSymbol(const std::string& name)
+bool SourcetrailDBWriter::recordSymbolKind(int symbolId, SymbolKind symbolKind)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
-		m_lastError = "Unable to record local symbol, because no database is currently open.";
+		m_lastError = "Unable to record symbol kind, because no database is currently open.";
 		return false;
 	}
 
 	try
 	{
-		return m_storage->addLocalSymbol(StorageLocalSymbolData(name));
+		m_storage->setNodeType(symbolId, nodeKindToInt(symbolKindToNodeKind(symbolKind)));
+		onRecorded(1, sizeof(symbolKind));
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
-		return 0;
+		return false;
+	}
+
+	return true;
+}
+
+bool SourcetrailDBWriter::recordSymbolLocation(int symbolId, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol location, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addSourceLocation(symbolId, location, LocationKind::TOKEN);
+		onRecorded(1, getRecordedBytes(location));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::recordSymbolScopeLocation(int symbolId, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol scope location, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addSourceLocation(symbolId, location, LocationKind::SCOPE);
+		onRecorded(1, getRecordedBytes(location));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::recordSymbolSignatureLocation(int symbolId, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol signature location, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addSourceLocation(symbolId, location, LocationKind::SIGNATURE);
+		onRecorded(1, getRecordedBytes(location));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+int SourcetrailDBWriter::recordReference(int contextSymbolId, int referencedSymbolId, ReferenceKind referenceKind)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record reference, because no database is currently open.";
+		return 0;
+	}
+
+	try
+	{
+		const int referenceId = addEdge(contextSymbolId, referencedSymbolId, referenceKindToEdgeKind(referenceKind));
+		addElementFile(referenceId);
+		addElementFile(contextSymbolId);
+		addElementFile(referencedSymbolId);
+		onRecorded(1, sizeof(StorageEdgeData));
+		return referenceId;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordReferenceLocation(int referenceId, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol reference location, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addSourceLocation(referenceId, location, LocationKind::TOKEN);
+		onRecorded(1, getRecordedBytes(location));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::recordReferenceIsAmbiguous(int referenceId)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record ambiguity of reference, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addElementComponent(referenceId, ElementComponentKind::IS_AMBIGUOUS, "");
+		onRecorded(1, sizeof(StorageElementComponentData));
+		return false;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+int SourcetrailDBWriter::recordReferenceToUnsolvedSymhol(int contextSymbolId, ReferenceKind referenceKind, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol reference, because no database is currently open.";
+		return 0;
+	}
+
+	try
+	{
+		NameHierarchy unsolvedSymbolName;
+		NameElement unsolvedSymbolNameElement;
+		unsolvedSymbolNameElement.name = "unsolved symbol";
+		unsolvedSymbolName.nameElements.push_back(unsolvedSymbolNameElement);
+		int unsolvedSymbolId = addNodeHierarchy(unsolvedSymbolName);
+		int referenceId = addEdge(contextSymbolId, unsolvedSymbolId, referenceKindToEdgeKind(referenceKind));
+		addSourceLocation(referenceId, location, LocationKind::UNSOLVED);
+		addElementFile(referenceId);
+		addElementFile(contextSymbolId);
+		addElementFile(unsolvedSymbolId);
+		onRecorded(1, sizeof(StorageEdgeData) + getRecordedBytes(location));
+		return referenceId;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordQualifierLocation(int referencedSymbolId, const SourceRange& location)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbol qualifier location, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		addSourceLocation(referencedSymbolId, location, LocationKind::QUALIFIER);
+		onRecorded(1, getRecordedBytes(location));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+int SourcetrailDBWriter::recordFile(const std::string& filePath)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record file, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		size_t recordedBytes = 0;
+		const int fileId = addFile(filePath, recordedBytes);
+		onRecorded(1, recordedBytes);
+		return fileId;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::recordFileLanguage(int fileId, const std::string& languageIdentifier)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record file language, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		m_storage->setFileLanguage(fileId, languageIdentifier);
+		onRecorded(1, languageIdentifier.size());
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+
+	return true;
+}
+
+int SourcetrailDBWriter::beginFileUpdate(const std::string& filePath)
+{
+	if (!m_storage)
+	{
+		m_lastError = "Unable to begin file update, because no database is currently open.";
+		return 0;
+	}
+	if (m_updatedFileId)
+	{
+		m_lastError = "Unable to begin file update, because another file is currently updated.";
+		return 0;
+	}
+
+	try
+	{
+		NameElement nameElement;
+		nameElement.name = filePath;
+		NameHierarchy nameHierarchy;
+		nameHierarchy.nameDelimiter = "/";
+		nameHierarchy.nameElements.push_back(nameElement);
+
+		// the old data is only removed if the file can be recorded again
+		m_storage->beginSavepoint(BATCH_SAVEPOINT_NAME);
+		const int fileId = addNodeHierarchy(nameHierarchy);
+		m_storage->removeFile(fileId, edgeKindToInt(EdgeKind::MEMBER), true);
+
+		size_t recordedBytes = 0;
+		const int updatedFileId = addFile(filePath, recordedBytes);
+		m_storage->releaseSavepoint(BATCH_SAVEPOINT_NAME);
+
+		m_updatedFileId = updatedFileId;
+		onRecorded(1, recordedBytes);
+		return m_updatedFileId;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		rollbackBatch();
+		return 0;
+	}
+}
+
+bool SourcetrailDBWriter::isFileUpToDate(const std::string& filePath) const
+{
+	if (!m_storage)
+	{
+		m_lastError = "Unable to check if file is up to date, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		return m_storage->isFileUpToDate(filePath);
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+bool SourcetrailDBWriter::endFileUpdate()
+{
+	if (!m_updatedFileId)
+	{
+		m_lastError = "Unable to end file update, because no file is currently updated.";
+		return false;
+	}
+
+	m_updatedFileId = 0;
+	return true;
+}
+
+bool SourcetrailDBWriter::removeFile(int fileId)
+{
+	if (!m_storage)
+	{
+		m_lastError = "Unable to remove file, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		if (!m_storage->removeFile(fileId, edgeKindToInt(EdgeKind::MEMBER), false))
+		{
+			m_lastError = "Unable to remove file, because id " + std::to_string(fileId) + " does not refer to a file.";
+			return false;
+		}
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+
+	if (m_updatedFileId == fileId)
+	{
+		m_updatedFileId = 0;
+	}
+	return true;
+}
+
+int SourcetrailDBWriter::recordLocalSymbol(const std::string& name)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record local symbol, because no database is currently open.";
+		return false;
+	}
+
+	try
+	{
+		const int localSymbolId = m_storage->addLocalSymbol(name);
+		addElementFile(localSymbolId);
+		onRecorded(1, name.size());
+		return localSymbolId;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return 0;
 	}
 }
 
 bool SourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const SourceRange& location)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
 		m_lastError = "Unable to record local symbol location, because no database is currently open.";
@@ -593,6 +1255,7 @@ bool SourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const Sou
 	try
 	{
 		addSourceLocation(localSymbolId, location, LocationKind::LOCAL_SYMBOL);
+		onRecorded(1, getRecordedBytes(location));
 		return true;
 	}
 	catch (const SourcetrailException e)
@@ -604,6 +1267,8 @@ bool SourcetrailDBWriter::recordLocalSymbolLocation(int localSymbolId, const Sou
 
 bool SourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
 		m_lastError = "Unable to record atomic source range, because no database is currently open.";
@@ -619,7 +1284,7 @@ bool SourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange
 			sourceRange.endLine,
 			sourceRange.endColumn,
 			locationKindToInt(LocationKind::ATOMIC_RANGE)));
-
+		onRecorded(1, getRecordedBytes(sourceRange));
 		return true;
 	}
 	catch (const SourcetrailException e)
@@ -631,6 +1296,8 @@ bool SourcetrailDBWriter::recordAtomicSourceRange(const SourceRange& sourceRange
 
 bool SourcetrailDBWriter::recordError(const std::string& message, bool fatal, const SourceRange& location)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
 		m_lastError = "Unable to record error, because no database is currently open.";
@@ -639,8 +1306,10 @@ bool SourcetrailDBWriter::recordError(const std::string& message, bool fatal, co
 
 	try
 	{
-		const int errorId = m_storage->addError(StorageErrorData(message, "", fatal, true));
+		const int errorId = m_storage->addError(message, "", fatal, true);
 		addSourceLocation(errorId, location, LocationKind::INDEXER_ERROR);
+		addElementFile(errorId);
+		onRecorded(1, message.size() + getRecordedBytes(location));
 		return true;
 	}
 	catch (const SourcetrailException e)
@@ -652,6 +1321,8 @@ bool SourcetrailDBWriter::recordError(const std::string& message, bool fatal, co
 
 bool SourcetrailDBWriter::recordTestMapping(int symbolId, int testSymbolId)
 {
+	const RecordTimer recordTimer(*this);
+
 	if (!m_storage)
 	{
 		m_lastError = "Unable to record test mapping, because no database is currently open.";
@@ -665,17 +1336,179 @@ bool SourcetrailDBWriter::recordTestMapping(int symbolId, int testSymbolId)
 	try
 	{
 		m_storage->addTestMapping(symbolId, testSymbolId);
+		onRecorded(1, 2 * sizeof(int));
+		return true;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		return false;
+	}
+}
+
+std::vector<int> SourcetrailDBWriter::recordSymbols(const std::vector<NameHierarchy>& nameHierarchies)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record symbols, because no database is currently open.";
+		return std::vector<int>();
+	}
+
+	try
+	{
+		m_storage->beginSavepoint(BATCH_SAVEPOINT_NAME);
+		const std::vector<int> symbolIds = addNodeHierarchies(nameHierarchies);
+		for (const NameHierarchy& nameHierarchy: nameHierarchies)
+		{
+			addElementFile(nameHierarchy);
+		}
+		m_storage->releaseSavepoint(BATCH_SAVEPOINT_NAME);
+
+		size_t recordedBytes = 0;
+		for (const NameHierarchy& nameHierarchy: nameHierarchies)
+		{
+			recordedBytes += getRecordedBytes(nameHierarchy);
+		}
+		onRecorded(nameHierarchies.size(), recordedBytes);
+		return symbolIds;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		rollbackBatch();
+		return std::vector<int>();
+	}
+}
+
+std::vector<int> SourcetrailDBWriter::recordReferences(const std::vector<ReferenceRecord>& references)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record references, because no database is currently open.";
+		return std::vector<int>();
+	}
+
+	std::vector<StorageEdgeData> edges;
+	edges.reserve(references.size());
+	for (const ReferenceRecord& reference: references)
+	{
+		if (!reference.contextSymbolId || !reference.referencedSymbolId)
+		{
+			m_lastError = "Unable to record references, because a context or referenced symbol id is invalid.";
+			return std::vector<int>();
+		}
+		edges.emplace_back(
+			reference.contextSymbolId, reference.referencedSymbolId, edgeKindToInt(referenceKindToEdgeKind(reference.referenceKind)));
+	}
+
+	try
+	{
+		m_storage->beginSavepoint(BATCH_SAVEPOINT_NAME);
+		const std::vector<int> referenceIds = m_storage->addEdges(edges);
+		for (size_t i = 0; i < references.size(); i++)
+		{
+			addElementFile(referenceIds[i]);
+			addElementFile(references[i].contextSymbolId);
+			addElementFile(references[i].referencedSymbolId);
+		}
+		m_storage->releaseSavepoint(BATCH_SAVEPOINT_NAME);
+		onRecorded(references.size(), references.size() * sizeof(StorageEdgeData));
+		return referenceIds;
+	}
+	catch (const SourcetrailException e)
+	{
+		m_lastError = e.getMessage();
+		rollbackBatch();
+		return std::vector<int>();
+	}
+}
+
+bool SourcetrailDBWriter::recordLocations(const std::vector<LocationRecord>& locations)
+{
+	const RecordTimer recordTimer(*this);
+
+	if (!m_storage)
+	{
+		m_lastError = "Unable to record locations, because no database is currently open.";
+		return false;
+	}
+
+	std::vector<StorageSourceLocationData> sourceLocations;
+	sourceLocations.reserve(locations.size());
+	for (const LocationRecord& location: locations)
+	{
+		sourceLocations.emplace_back(
+			location.location.fileId,
+			location.location.startLine,
+			location.location.startColumn,
+			location.location.endLine,
+			location.location.endColumn,
+			locationKindToInt(location.locationKind));
+	}
+
+	try
+	{
+		m_storage->beginSavepoint(BATCH_SAVEPOINT_NAME);
+
+		const std::vector<int> sourceLocationIds = m_storage->addSourceLocations(sourceLocations);
+
+		std::vector<StorageOccurrence> occurrences;
+		occurrences.reserve(locations.size());
+		for (size_t i = 0; i < locations.size(); i++)
+		{
+			occurrences.emplace_back(locations[i].elementId, sourceLocationIds[i]);
+		}
+		m_storage->addOccurrences(occurrences);
+
+		if (m_updatedFileId)
+		{
+			for (const LocationRecord& location: locations)
+			{
+				m_storage->addElementFile(location.elementId, location.location.fileId);
+			}
+		}
+
+		m_storage->releaseSavepoint(BATCH_SAVEPOINT_NAME);
+		onRecorded(locations.size(), locations.size() * getRecordedBytes(SourceRange()));
 		return true;
 	}
 	catch (const SourcetrailException e)
 	{
 		m_lastError = e.getMessage();
+		rollbackBatch();
 		return false;
 	}
 }
 
 // --- Private Interface ---
 
+SourcetrailDBWriter::RecordTimer::RecordTimer(SourcetrailDBWriter& writer)
+	: m_writer(writer), m_statistics(nullptr), m_startSqliteMilliseconds(0.0)
+{
+	if (m_writer.m_recordDepth++ == 0 && m_writer.m_storage && m_writer.m_storage->isStatisticsEnabled())
+	{
+		m_statistics = &m_writer.m_storage->getStatistics();
+		m_startSqliteMilliseconds = m_statistics->sqliteMilliseconds;
+		m_startTime = std::chrono::steady_clock::now();
+	}
+}
+
+SourcetrailDBWriter::RecordTimer::~RecordTimer()
+{
+	m_writer.m_recordDepth--;
+	if (m_statistics)
+	{
+		const double milliseconds =
+			std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - m_startTime).count();
+		const double sqliteMilliseconds = m_statistics->sqliteMilliseconds - m_startSqliteMilliseconds;
+		m_statistics->libraryMilliseconds += std::max(0.0, milliseconds - sqliteMilliseconds);
+	}
+}
+
 void SourcetrailDBWriter::openDatabase()
 {
 	if (m_storage)
@@ -683,15 +1516,39 @@ void SourcetrailDBWriter::openDatabase()
 		closeDatabase();
 	}
 
+	m_autoCommitEnabled = false;
+	m_pendingRecords = 0;
+	m_pendingBytes = 0;
+	m_commitStatistics = CommitStatistics {0, 0, 0.0, 0.0, 0.0};
+	m_savepoints.clear();
+	m_updatedFileId = 0;
+
 	try
 	{
-		m_storage = DatabaseStorage::openDatabase(m_databaseFilePath);
+		if (m_staged)
+		{
+			m_storage = DatabaseStorage::openDatabase(":memory:", m_storageOptions);
+			if (utility::getFileStatus(m_databaseFilePath).exists)
+			{
+				m_storage->loadDatabase(m_databaseFilePath);
+			}
+			m_persistedChangeCount = m_storage->getChangeCount();
+		}
+		else
+		{
+			m_storage = DatabaseStorage::openDatabase(m_databaseFilePath, m_storageOptions);
+		}
 	}
 	catch (CppSQLite3Exception e)
 	{
 		m_storage.reset();
 		throw e;
 	}
+	catch (const SourcetrailException e)
+	{
+		m_storage.reset();
+		throw e;
+	}
 }
 
 void SourcetrailDBWriter::closeDatabase()
@@ -700,7 +1557,41 @@ void SourcetrailDBWriter::closeDatabase()
 	{
 		throw SourcetrailException("Unable to close database, because no database is currently open.");
 	}
+
+	// the storage is only released once everything has been written, so that a failed close can be retried
+	try
+	{
+		if (m_autoCommitEnabled)
+		{
+			commitAutoCommitTransaction();
+		}
+
+		if (m_storage->isBulkLoading())
+		{
+			m_storage->endBulkLoad();
+		}
+
+		if (m_staged && m_storage->getChangeCount() != m_persistedChangeCount)
+		{
+			m_storage->saveDatabase(m_databaseFilePath, PersistProgressCallback());
+			m_persistedChangeCount = m_storage->getChangeCount();
+		}
+
+		m_storage->restoreJournalMode();
+	}
+	catch (const SourcetrailException e)
+	{
+		if (m_autoCommitEnabled && !m_storage->isInTransaction())
+		{
+			beginAutoCommitTransaction();
+		}
+		throw e;
+	}
+
 	m_storage.reset();
+	m_autoCommitEnabled = false;
+	m_savepoints.clear();
+	m_updatedFileId = 0;
 }
 
 void SourcetrailDBWriter::setupDatabaseTables()
@@ -718,7 +1609,19 @@ void SourcetrailDBWriter::clearDatabaseTables()
 	{
 		throw SourcetrailException("Unable to setup database tables, because no database is currently open.");
 	}
-	m_storage->clearDatabase();
+	m_updatedFileId = 0;
+
+	if (m_autoCommitEnabled)
+	{
+		m_storage->commitTransaction();
+		m_storage->clearDatabase();
+		m_savepoints.clear();
+		beginAutoCommitTransaction();
+	}
+	else
+	{
+		m_storage->clearDatabase();
+	}
 }
 
 void SourcetrailDBWriter::createOrResetProjectFile()
@@ -767,24 +1670,49 @@ void SourcetrailDBWriter::updateProjectSettingsText()
 	}
 }
 
-int SourcetrailDBWriter::addNodeHierarchy(const NameHierarchy& nameHierarchy)
+template <typename NameHierarchyType>
+int SourcetrailDBWriter::addNodeHierarchy(const NameHierarchyType& nameHierarchy)
 {
-	if (nameHierarchy.nameElements.size() == 0)
+	const size_t nameElementCount = getNameElementCount(nameHierarchy);
+	if (nameElementCount == 0)
 	{
 		throw SourcetrailException("Unable to add nodes for an empty name hierarchy.");
 	}
 
-	int parentNodeId = 0;
+	std::string& serializedName = m_serializedName;
+	std::vector<size_t>& prefixEnds = m_serializedNamePrefixEnds;
+	beginDatabaseString(serializedName, nameHierarchy);
+	const size_t nameBegin = serializedName.size();
+	prefixEnds.clear();
+	for (size_t i = 0; i < nameElementCount; i++)
+	{
+		appendToDatabaseString(serializedName, nameHierarchy, i);
+		prefixEnds.push_back(serializedName.size());
+	}
 
-	NameHierarchy currentNameHierarchy;
-	currentNameHierarchy.nameDelimiter = nameHierarchy.nameDelimiter;
+	// The nodes of all prefixes of a cached node and their MEMBER edges have been added before, so only the
+	// prefixes after the longest cached one need to be added. Usually that is the full name or its parent.
+	int parentNodeId = 0;
+	size_t knownElementCount = nameElementCount;
+	for (; knownElementCount > 0; knownElementCount--)
+	{
+		serializedName.resize(prefixEnds[knownElementCount - 1]);
+		parentNodeId = m_storage->findCachedNodeId(serializedName);
+		if (parentNodeId != 0)
+		{
+			break;
+		}
+	}
+	if (knownElementCount == 0)
+	{
+		serializedName.resize(nameBegin);
+	}
 
-	for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
+	for (size_t i = knownElementCount; i < nameElementCount; i++)
 	{
-		currentNameHierarchy.nameElements.push_back(nameHierarchy.nameElements[i]);
+		appendToDatabaseString(serializedName, nameHierarchy, i);
 
-		int nodeId = m_storage->addNode(
-			StorageNodeData(nodeKindToInt(NodeKind::UNKNOWN), serializeNameHierarchyToDatabaseString(currentNameHierarchy)));
+		int nodeId = m_storage->addNode(nodeKindToInt(NodeKind::UNKNOWN), serializedName);
 
 		if (parentNodeId != 0)
 		{
@@ -796,7 +1724,195 @@ int SourcetrailDBWriter::addNodeHierarchy(const NameHierarchy& nameHierarchy)
 	return parentNodeId;
 }
 
-int SourcetrailDBWriter::addFile(const std::string& filePath)
+std::vector<int> SourcetrailDBWriter::addNodeHierarchies(const std::vector<NameHierarchy>& nameHierarchies)
+{
+	// Collect all name prefixes that are not known yet. Each one is added once, together with the
+	// index of its parent prefix, so that nodes and member edges can be written in one go.
+	std::vector<std::string> newNames;
+	std::vector<std::pair<int, int>> newNameParents;
+	std::unordered_map<std::string, int> newNameIndices;
+
+	// parents and symbols are referenced either by known node id or by index of a new name (-1 if none)
+	std::vector<std::pair<int, int>> symbols;
+	symbols.reserve(nameHierarchies.size());
+
+	for (const NameHierarchy& nameHierarchy: nameHierarchies)
+	{
+		if (nameHierarchy.nameElements.size() == 0)
+		{
+			throw SourcetrailException("Unable to add nodes for an empty name hierarchy.");
+		}
+
+		int parentNodeId = 0;
+		int parentIndex = -1;
+
+		std::string serializedName;
+		beginNameHierarchyDatabaseString(serializedName, nameHierarchy.nameDelimiter);
+
+		for (size_t i = 0; i < nameHierarchy.nameElements.size(); i++)
+		{
+			appendNameElementToDatabaseString(serializedName, nameHierarchy.nameElements[i], i == 0);
+
+			const int nodeId = m_storage->findCachedNodeId(serializedName);
+			if (nodeId != 0)
+			{
+				parentNodeId = nodeId;
+				parentIndex = -1;
+				continue;
+			}
+
+			std::pair<std::unordered_map<std::string, int>::iterator, bool> inserted =
+				newNameIndices.emplace(serializedName, static_cast<int>(newNames.size()));
+			if (inserted.second)
+			{
+				newNames.push_back(serializedName);
+				newNameParents.push_back(std::make_pair(parentNodeId, parentIndex));
+			}
+			parentNodeId = 0;
+			parentIndex = inserted.first->second;
+		}
+
+		symbols.push_back(std::make_pair(parentNodeId, parentIndex));
+	}
+
+	std::vector<StorageNodeData> nodes;
+	nodes.reserve(newNames.size());
+	for (const std::string& name: newNames)
+	{
+		nodes.emplace_back(nodeKindToInt(NodeKind::UNKNOWN), name);
+	}
+	const std::vector<int> nodeIds = m_storage->addNodes(nodes);
+
+	std::vector<StorageEdgeData> memberEdges;
+	for (size_t i = 0; i < newNames.size(); i++)
+	{
+		const std::pair<int, int>& parent = newNameParents[i];
+		const int parentNodeId = parent.second >= 0 ? nodeIds[parent.second] : parent.first;
+		if (parentNodeId != 0)
+		{
+			memberEdges.emplace_back(parentNodeId, nodeIds[i], edgeKindToInt(EdgeKind::MEMBER));
+		}
+	}
+	m_storage->addEdges(memberEdges);
+
+	std::vector<int> symbolIds;
+	symbolIds.reserve(symbols.size());
+	for (const std::pair<int, int>& symbol: symbols)
+	{
+		symbolIds.push_back(symbol.second >= 0 ? nodeIds[symbol.second] : symbol.first);
+	}
+	return symbolIds;
+}
+
+void SourcetrailDBWriter::rollbackBatch()
+{
+	try
+	{
+		m_storage->rollbackToSavepoint(BATCH_SAVEPOINT_NAME);
+		m_storage->releaseSavepoint(BATCH_SAVEPOINT_NAME);
+	}
+	catch (const SourcetrailException e)
+	{
+		// the savepoint has not been created, so there is nothing to revert
+	}
+}
+
+void SourcetrailDBWriter::addElementFile(int elementId)
+{
+	if (m_updatedFileId)
+	{
+		m_storage->addElementFile(elementId, m_updatedFileId);
+	}
+}
+
+template <typename NameHierarchyType>
+void SourcetrailDBWriter::addElementFile(const NameHierarchyType& nameHierarchy)
+{
+	if (!m_updatedFileId)
+	{
+		return;
+	}
+
+	// all prefixes of the name hierarchy are known after it has been added
+	std::string& serializedName = m_serializedName;
+	beginDatabaseString(serializedName, nameHierarchy);
+	for (size_t i = 0; i < getNameElementCount(nameHierarchy); i++)
+	{
+		appendToDatabaseString(serializedName, nameHierarchy, i);
+		const int nodeId = m_storage->findCachedNodeId(serializedName);
+		if (nodeId != 0)
+		{
+			m_storage->addElementFile(nodeId, m_updatedFileId);
+		}
+	}
+}
+
+void SourcetrailDBWriter::onRecorded(size_t recordCount, size_t recordBytes)
+{
+	if (!m_autoCommitEnabled)
+	{
+		return;
+	}
+
+	m_pendingRecords += recordCount;
+	m_pendingBytes += recordBytes;
+
+	if (!m_savepoints.empty())
+	{
+		return;
+	}
+
+	if ((m_autoCommitOptions.maxRecords && m_pendingRecords >= m_autoCommitOptions.maxRecords) ||
+		(m_autoCommitOptions.maxBytes && m_pendingBytes >= m_autoCommitOptions.maxBytes) ||
+		(m_autoCommitOptions.maxMilliseconds &&
+		 getElapsedMilliseconds(m_transactionStartTime) >= m_autoCommitOptions.maxMilliseconds))
+	{
+		commitAutoCommitTransaction();
+		beginAutoCommitTransaction();
+	}
+}
+
+void SourcetrailDBWriter::beginAutoCommitTransaction()
+{
+	m_storage->beginTransaction();
+	m_transactionStartTime = std::chrono::steady_clock::now();
+}
+
+void SourcetrailDBWriter::commitAutoCommitTransaction()
+{
+	if (m_storage->isInTransaction())
+	{
+		commitMeasured();
+	}
+	m_commitStatistics.committedRecords += m_pendingRecords;
+	m_pendingRecords = 0;
+	m_pendingBytes = 0;
+}
+
+void SourcetrailDBWriter::commitMeasured()
+{
+	const std::chrono::steady_clock::time_point startTime = std::chrono::steady_clock::now();
+	m_storage->commitTransaction();
+	const double milliseconds =
+		std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startTime).count();
+
+	m_commitStatistics.commitCount++;
+	m_commitStatistics.totalMilliseconds += milliseconds;
+	m_commitStatistics.maxMilliseconds = std::max(m_commitStatistics.maxMilliseconds, milliseconds);
+	m_commitStatistics.lastMilliseconds = milliseconds;
+
+	if (m_storage->isStatisticsEnabled())
+	{
+		size_t bucket = 0;
+		while (bucket + 1 < COMMIT_LATENCY_BUCKET_COUNT && milliseconds > COMMIT_LATENCY_BUCKET_UPPER_BOUNDS[bucket])
+		{
+			bucket++;
+		}
+		m_storage->getStatistics().commitLatencyBuckets[bucket]++;
+	}
+}
+
+int SourcetrailDBWriter::addFile(const std::string& filePath, size_t& recordedBytes)
 {
 	NameElement nameElement;
 	nameElement.name = filePath;
@@ -807,7 +1923,11 @@ int SourcetrailDBWriter::addFile(const std::string& filePath)
 	const int nodeId = addNodeHierarchy(nameHierarchy);
 	m_storage->setNodeType(nodeId, nodeKindToInt(NodeKind::FILE));
 
-	m_storage->addFile(StorageFile(nodeId, filePath, "", utility::getDateTimeString(time(0)), true, true));
+	const utility::FileStatus fileStatus = utility::getFileStatus(filePath);
+	const time_t modificationTime = fileStatus.exists ? static_cast<time_t>(fileStatus.modificationTime) : time(0);
+	const size_t contentBytes =
+		m_storage->addFile(StorageFile(nodeId, filePath, "", utility::getDateTimeString(modificationTime), true, true));
+	recordedBytes = filePath.size() + contentBytes;
 
 	return nodeId;
 }
@@ -836,6 +1956,10 @@ void SourcetrailDBWriter::addSourceLocation(int elementId, const SourceRange& lo
 		location.fileId, location.startLine, location.startColumn, location.endLine, location.endColumn, locationKindToInt(kind)));
 
 	m_storage->addOccurrence(StorageOccurrence(elementId, sourceLocationId));
+	if (m_updatedFileId)
+	{
+		m_storage->addElementFile(elementId, location.fileId);
+	}
 }
 
 void SourcetrailDBWriter::addElementComponent(int elementId, ElementComponentKind kind, const std::string& data)
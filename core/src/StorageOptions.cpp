@@ -0,0 +1,80 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StorageOptions.h"
+
+namespace sourcetrail
+{
+std::string storageProfileToString(StorageProfile profile)
+{
+	switch (profile)
+	{
+	case StorageProfile::DEFAULT:
+		return "default";
+	case StorageProfile::BULK_INGEST:
+		return "bulk-ingest";
+	case StorageProfile::READ_MOSTLY:
+		return "read-mostly";
+	}
+
+	return "default";
+}
+
+StorageProfile stringToStorageProfile(const std::string& s)
+{
+	const StorageProfile profiles[] = {StorageProfile::DEFAULT, StorageProfile::BULK_INGEST, StorageProfile::READ_MOSTLY};
+
+	for (StorageProfile profile: profiles)
+	{
+		if (s == storageProfileToString(profile))
+		{
+			return profile;
+		}
+	}
+
+	return StorageProfile::DEFAULT;
+}
+
+StorageOptions getStorageOptions(StorageProfile profile)
+{
+	StorageOptions options;
+	options.profile = profile;
+	options.cacheSizeKiB = 0;
+	options.mmapSizeBytes = 0;
+	options.tempStoreInMemory = false;
+	options.queryOnly = false;
+
+	switch (profile)
+	{
+	case StorageProfile::DEFAULT:
+		break;
+	case StorageProfile::BULK_INGEST:
+		// WAL instead of OFF, so that transactions and savepoints can still be rolled back
+		options.journalMode = "WAL";
+		options.synchronous = "OFF";
+		options.cacheSizeKiB = 256 * 1024;
+		options.tempStoreInMemory = true;
+		break;
+	case StorageProfile::READ_MOSTLY:
+		options.cacheSizeKiB = 64 * 1024;
+		options.mmapSizeBytes = 256LL * 1024 * 1024;
+		options.queryOnly = true;
+		break;
+	}
+
+	return options;
+}
+}	 // namespace sourcetrail
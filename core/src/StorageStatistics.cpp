@@ -0,0 +1,85 @@
+/*
+ * Copyright 2018 Coati Software KG
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "StorageStatistics.h"
+
+#include "json.hpp"
+
+namespace
+{
+nlohmann::json toJson(const sourcetrail::OperationStatistics& operation)
+{
+	return {{"calls", operation.calls}, {"rows", operation.rows}};
+}
+
+nlohmann::json toJson(const sourcetrail::LookupStatistics& lookup)
+{
+	const size_t lookupCount = lookup.cacheHits + lookup.databaseHits + lookup.misses;
+	const double hitRatio =
+		lookupCount ? static_cast<double>(lookup.cacheHits + lookup.databaseHits) / static_cast<double>(lookupCount) : 0.0;
+	return {
+		{"cache_hits", lookup.cacheHits},
+		{"database_hits", lookup.databaseHits},
+		{"misses", lookup.misses},
+		{"hit_ratio", hitRatio}};
+}
+}	 // namespace
+
+namespace sourcetrail
+{
+std::string storageStatisticsToJson(const StorageStatistics& statistics)
+{
+	nlohmann::json j;
+
+	j["nodes"] = toJson(statistics.nodes);
+	j["edges"] = toJson(statistics.edges);
+	j["source_locations"] = toJson(statistics.sourceLocations);
+	j["occurrences"] = toJson(statistics.occurrences);
+	j["files"] = toJson(statistics.files);
+	j["local_symbols"] = toJson(statistics.localSymbols);
+	j["errors"] = toJson(statistics.errors);
+
+	j["node_lookups"] = toJson(statistics.nodeLookups);
+	j["edge_lookups"] = toJson(statistics.edgeLookups);
+	j["source_location_lookups"] = toJson(statistics.sourceLocationLookups);
+	j["local_symbol_lookups"] = toJson(statistics.localSymbolLookups);
+	j["error_lookups"] = toJson(statistics.errorLookups);
+	j["file_content_lookups"] = toJson(statistics.fileContentLookups);
+
+	j["sqlite_ms"] = statistics.sqliteMilliseconds;
+	j["library_ms"] = statistics.libraryMilliseconds;
+
+	j["commit_latency_ms"] = nlohmann::json::array();
+	for (size_t i = 0; i < COMMIT_LATENCY_BUCKET_COUNT; i++)
+	{
+		nlohmann::json bucket;
+		if (i + 1 < COMMIT_LATENCY_BUCKET_COUNT)
+		{
+			bucket["max"] = COMMIT_LATENCY_BUCKET_UPPER_BOUNDS[i];
+		}
+		else
+		{
+			bucket["max"] = nullptr;
+		}
+		bucket["count"] = statistics.commitLatencyBuckets[i];
+		j["commit_latency_ms"].push_back(bucket);
+	}
+
+	j["file_content_bytes"] = statistics.fileContentBytes;
+
+	return j.dump(4);
+}
+}	 // namespace sourcetrail
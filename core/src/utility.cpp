@@ -17,52 +17,57 @@
 #include "utility.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <cstring>
 #include <ctime>
 #include <fstream>
-#include <vector>
 
+#include <sys/stat.h>
+#include <sys/types.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#	define SOURCETRAIL_USE_SSE2
+#	include <emmintrin.h>
+#endif
+
+#include "MemoryMappedFile.h"
 #include "SourcetrailException.h"
 
 namespace
 {
-std::istream& safeGetline(std::istream& is, std::string& t)
+uint64_t rotateLeft(uint64_t value, int bits)
 {
-	t.clear();
-
-	// The characters in the stream are read one-by-one using a std::streambuf.
-	// That is faster than reading them one-by-one using the std::istream.
-	// Code that uses streambuf this way must be guarded by a sentry object.
-	// The sentry object performs various tasks,
-	// such as thread synchronization and updating the stream state.
+	return (value << bits) | (value >> (64 - bits));
+}
 
-	std::istream::sentry se(is, true);
-	std::streambuf* sb = is.rdbuf();
+uint64_t finalizeHash(uint64_t value)
+{
+	value ^= value >> 33;
+	value *= 0xff51afd7ed558ccdULL;
+	value ^= value >> 33;
+	value *= 0xc4ceb9fe1a85ec53ULL;
+	value ^= value >> 33;
+	return value;
+}
 
-	while (true)
+uint64_t readLittleEndian(const unsigned char* bytes, size_t count)
+{
+	uint64_t value = 0;
+	for (size_t i = 0; i < count; i++)
 	{
-		int c = sb->sbumpc();
-		switch (c)
-		{
-		case '\n':
-			return is;
-		case '\r':
-			if (sb->sgetc() == '\n')
-			{
-				sb->sbumpc();
-			}
-			return is;
-		case std::streambuf::traits_type::eof():
-			// Also handle the case when the last line has no line ending
-			if (t.empty())
-			{
-				is.setstate(std::ios::eofbit);
-			}
-			return is;
-		default:
-			t += (char)c;
-		}
+		value |= static_cast<uint64_t>(bytes[i]) << (8 * i);
 	}
+	return value;
 }
+
+#ifdef SOURCETRAIL_USE_SSE2
+size_t getByteSum(__m128i counts)
+{
+	const __m128i sums = _mm_sad_epu8(counts, _mm_setzero_si128());
+	return static_cast<size_t>(_mm_cvtsi128_si32(sums)) +
+		static_cast<size_t>(_mm_cvtsi128_si32(_mm_unpackhi_epi64(sums, sums)));
+}
+#endif
 }	 // namespace
 
 namespace sourcetrail
@@ -75,56 +80,163 @@ bool getFileExists(const std::string& filePath)
 	return file.good();
 }
 
+FileStatus getFileStatus(const std::string& filePath)
+{
+	FileStatus status = {false, 0, 0};
+#ifdef _WIN32
+	struct _stat64 fileStatus;
+	if (_stat64(filePath.c_str(), &fileStatus) == 0)
+#else
+	struct stat fileStatus;
+	if (stat(filePath.c_str(), &fileStatus) == 0)
+#endif
+	{
+		status.exists = true;
+		status.size = static_cast<long long>(fileStatus.st_size);
+		status.modificationTime = static_cast<long long>(fileStatus.st_mtime);
+	}
+	return status;
+}
+
 std::string getFileContent(const std::string& filePath)
 {
-	std::vector<std::string> lines;
+	const MemoryMappedFile file(filePath);
+	return getNormalizedFileContent(file.getData(), file.getSize());
+}
 
-	try
-	{
-		std::ifstream srcFile;
-		srcFile.open(filePath, std::ios::binary | std::ios::in);
+std::string getNormalizedFileContent(const char* data, size_t size)
+{
+	std::string content;
+	content.reserve(size + 1);
 
-		if (srcFile.fail())
+	const char* it = data;
+	const char* end = data + size;
+	while (it != end)
+	{
+		const char* carriageReturn = static_cast<const char*>(std::memchr(it, '\r', end - it));
+		if (!carriageReturn)
 		{
-			throw SourcetrailException("Could not open file " + filePath);
+			content.append(it, end);
+			break;
 		}
 
-		while (!srcFile.eof())
+		content.append(it, carriageReturn);
+		content += '\n';
+		it = carriageReturn + 1;
+		if (it != end && *it == '\n')
 		{
-			std::string line;
-			safeGetline(srcFile, line);
-			lines.push_back(line + '\n');
+			it++;
 		}
-
-		srcFile.close();
-	}
-	catch (std::exception& e)
-	{
-		throw SourcetrailException("Exception thrown while reading file \"" + filePath + "\": " + e.what());
 	}
-	catch (...)
+
+	if (!content.empty() && content.back() != '\n')
 	{
-		throw SourcetrailException("Unknown exception thrown while reading file \"" + filePath + "\"");
+		content += '\n';
 	}
 
-	if (!lines.empty())
+	return content;
+}
+
+void countLineBreaks(const char* data, size_t size, size_t& newlineCount, size_t& carriageReturnCount)
+{
+	newlineCount = 0;
+	carriageReturnCount = 0;
+	size_t i = 0;
+
+#ifdef SOURCETRAIL_USE_SSE2
+	// Matches are accumulated in 8 bit lanes, which need to be summed up before they overflow.
+	const __m128i newline = _mm_set1_epi8('\n');
+	const __m128i carriageReturn = _mm_set1_epi8('\r');
+	while (size - i >= 16)
 	{
-		std::string last = lines.back().substr(0, lines.back().size() - 1);
-		lines.pop_back();
-		if (!last.empty())
+		__m128i newlines = _mm_setzero_si128();
+		__m128i carriageReturns = _mm_setzero_si128();
+		for (int round = 0; round < 255 && size - i >= 16; round++, i += 16)
 		{
-			lines.push_back(last);
+			const __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data + i));
+			newlines = _mm_sub_epi8(newlines, _mm_cmpeq_epi8(chunk, newline));
+			carriageReturns = _mm_sub_epi8(carriageReturns, _mm_cmpeq_epi8(chunk, carriageReturn));
 		}
+		newlineCount += getByteSum(newlines);
+		carriageReturnCount += getByteSum(carriageReturns);
 	}
+#endif
 
-	std::string content;
+	for (; i < size; i++)
+	{
+		newlineCount += data[i] == '\n';
+		carriageReturnCount += data[i] == '\r';
+	}
+}
 
-	for (const std::string& line: lines)
+std::string getContentHash(const char* data, size_t size)
+{
+	// MurmurHash3_x64_128 by Austin Appleby, with seed 0
+	const uint64_t c1 = 0x87c37b91114253d5ULL;
+	const uint64_t c2 = 0x4cf5ad432745937fULL;
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+	const size_t blockCount = size / 16;
+
+	uint64_t h1 = 0;
+	uint64_t h2 = 0;
+
+	for (size_t i = 0; i < blockCount; i++)
 	{
-		content += line;
+		uint64_t k1 = readLittleEndian(bytes + i * 16, 8);
+		uint64_t k2 = readLittleEndian(bytes + i * 16 + 8, 8);
+
+		k1 *= c1;
+		k1 = rotateLeft(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+		h1 = rotateLeft(h1, 27);
+		h1 += h2;
+		h1 = h1 * 5 + 0x52dce729;
+
+		k2 *= c2;
+		k2 = rotateLeft(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+		h2 = rotateLeft(h2, 31);
+		h2 += h1;
+		h2 = h2 * 5 + 0x38495ab5;
 	}
 
-	return content;
+	const unsigned char* tail = bytes + blockCount * 16;
+	const size_t tailSize = size & 15;
+	if (tailSize > 8)
+	{
+		uint64_t k2 = readLittleEndian(tail + 8, tailSize - 8);
+		k2 *= c2;
+		k2 = rotateLeft(k2, 33);
+		k2 *= c1;
+		h2 ^= k2;
+	}
+	if (tailSize > 0)
+	{
+		uint64_t k1 = readLittleEndian(tail, std::min<size_t>(tailSize, 8));
+		k1 *= c1;
+		k1 = rotateLeft(k1, 31);
+		k1 *= c2;
+		h1 ^= k1;
+	}
+
+	h1 ^= size;
+	h2 ^= size;
+	h1 += h2;
+	h2 += h1;
+	h1 = finalizeHash(h1);
+	h2 = finalizeHash(h2);
+	h1 += h2;
+	h2 += h1;
+
+	std::string hash(16, '\0');
+	for (size_t i = 0; i < 8; i++)
+	{
+		hash[i] = static_cast<char>(h1 >> (8 * i));
+		hash[i + 8] = static_cast<char>(h2 >> (8 * i));
+	}
+	return hash;
 }
 
 std::string getDateTimeString(const time_t& time)
@@ -140,7 +252,23 @@ std::string getDateTimeString(const time_t& time)
 
 int getLineCount(const std::string s)
 {
-	return static_cast<int>(std::count(s.begin(), s.end(), '\n'));
+	size_t newlineCount = 0;
+	size_t carriageReturnCount = 0;
+	countLineBreaks(s.data(), s.size(), newlineCount, carriageReturnCount);
+	return static_cast<int>(newlineCount);
+}
+
+std::string toLowerCase(const std::string& s)
+{
+	std::string lowerCase = s;
+	for (char& c: lowerCase)
+	{
+		if (c >= 'A' && c <= 'Z')
+		{
+			c = static_cast<char>(c - 'A' + 'a');
+		}
+	}
+	return lowerCase;
 }
 }	 // namespace utility
 }	 // namespace sourcetrail
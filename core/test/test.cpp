@@ -15,12 +15,38 @@
 */
 
 #define CATCH_CONFIG_MAIN  // This tells Catch to provide a main() function
+#define CATCH_CONFIG_NO_POSIX_SIGNALS  // SIGSTKSZ is no longer a compile time constant in recent glibc versions
 
 #include "catch.hpp"
 
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <set>
+#include <thread>
+
+#ifdef _WIN32
+#	include <direct.h>
+#	include <sys/utime.h>
+#else
+#	include <sys/stat.h>
+#	include <unistd.h>
+#	include <utime.h>
+#endif
+
+#include "CppSQLite3.h"
+
+#include "AsyncSourcetrailDBWriter.h"
+#include "BoundedMpscQueue.h"
 #include "DatabaseStorage.h"
+#include "MemoryMappedFile.h"
+#include "NameHierarchyBuilder.h"
+#include "NameHierarchyView.h"
 #include "NodeKind.h"
+#include "SourcetrailDBReader.h"
 #include "SourcetrailDBWriter.h"
+#include "SourcetrailException.h"
+#include "utility.h"
 
 namespace sourcetrail
 {
@@ -387,6 +413,369 @@ namespace sourcetrail
 		REQUIRE(writer.getLastError() == "");
 	}
 
+	TEST_CASE("Testing file content ingestion")
+	{
+		SECTION("line breaks are counted in long content")
+		{
+			std::string content;
+			for (int i = 0; i < 1000; i++)
+			{
+				content += "int line_" + std::to_string(i) + (i % 3 ? ";\r\n" : ";\n");
+			}
+			size_t newlineCount = 0;
+			size_t carriageReturnCount = 0;
+			utility::countLineBreaks(content.data(), content.size(), newlineCount, carriageReturnCount);
+			REQUIRE(newlineCount == 1000);
+			REQUIRE(carriageReturnCount == 666);
+		}
+
+		SECTION("line endings are normalized")
+		{
+			const std::string content = "a\r\nb\rc\n\r\nd";
+			REQUIRE(utility::getNormalizedFileContent(content.data(), content.size()) == "a\nb\nc\n\nd\n");
+			REQUIRE(utility::getNormalizedFileContent(nullptr, 0) == "");
+		}
+
+		SECTION("writer stores normalized file content")
+		{
+			const std::string databasePath = "testing.db";
+			const std::string unixFilePath = "testing_unix.cpp";
+			const std::string windowsFilePath = "testing_windows.cpp";
+			std::ofstream(unixFilePath, std::ios::binary) << "int a;\nint b;\n";
+			std::ofstream(windowsFilePath, std::ios::binary) << "int a;\r\nint b;";
+
+			SourcetrailDBWriter writer;
+			writer.open(databasePath);
+			writer.clear();
+			const int unixFileId = writer.recordFile(unixFilePath);
+			const int windowsFileId = writer.recordFile(windowsFilePath);
+			REQUIRE(writer.getLastError() == "");
+			writer.close();
+
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			for (const int fileId: { unixFileId, windowsFileId })
+			{
+				const std::string id = std::to_string(fileId);
+				REQUIRE(database.execScalar(("SELECT line_count FROM file WHERE id = " + id + ";").c_str()) == 2);
+				CppSQLite3Query query = database.execQuery(("SELECT content FROM filecontent WHERE id = " + id + ";").c_str());
+				REQUIRE(std::string(query.getStringField(0)) == "int a;\nint b;\n");
+			}
+			database.close();
+
+			std::remove(unixFilePath.c_str());
+			std::remove(windowsFilePath.c_str());
+		}
+
+		SECTION("files are read or mapped depending on their size")
+		{
+			const std::string smallFilePath = "testing_small.cpp";
+			const std::string largeFilePath = "testing_large.cpp";
+			const std::string line = "int a;\r\n";
+			std::string largeContent;
+			while (largeContent.size() < MemoryMappedFile::MIN_MAPPED_SIZE)
+			{
+				largeContent += line;
+			}
+			std::ofstream(smallFilePath, std::ios::binary) << line;
+			std::ofstream(largeFilePath, std::ios::binary) << largeContent;
+
+			REQUIRE(MemoryMappedFile(smallFilePath).getSize() == line.size());
+			REQUIRE(MemoryMappedFile(largeFilePath).getSize() == largeContent.size());
+			REQUIRE(utility::getFileContent(smallFilePath) == "int a;\n");
+			REQUIRE(utility::getFileContent(largeFilePath) == utility::getNormalizedFileContent(largeContent.data(), largeContent.size()));
+
+			std::string error;
+			try
+			{
+				utility::getFileContent("testing_missing.cpp");
+			}
+			catch (const SourcetrailException& e)
+			{
+				error = e.getMessage();
+			}
+			REQUIRE(error.find("Exception thrown while reading file \"testing_missing.cpp\"") == 0);
+
+			std::remove(smallFilePath.c_str());
+			std::remove(largeFilePath.c_str());
+		}
+
+		SECTION("writer stores the content of every file unless deduplication is enabled")
+		{
+			const std::string databasePath = "testing.db";
+			const std::vector<std::string> filePaths = { "testing_copy_1.h", "testing_copy_2.h", "testing_copy_3.h" };
+			std::ofstream(filePaths[0], std::ios::binary) << "#pragma once\nint a;\n";
+			std::ofstream(filePaths[1], std::ios::binary) << "#pragma once\nint a;\n";
+			std::ofstream(filePaths[2], std::ios::binary) << "#pragma once\r\nint a;\r\n";
+
+			SourcetrailDBWriter writer;
+			writer.open(databasePath);
+			writer.clear();
+			REQUIRE(writer.recordFile(filePaths[0]) != 0);
+			REQUIRE(writer.enableFileContentDeduplication());
+			std::vector<int> fileIds;
+			for (const std::string& filePath: filePaths)
+			{
+				fileIds.push_back(writer.recordFile(filePath));
+			}
+			REQUIRE(writer.getLastError() == "");
+			writer.close();
+
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM filecontent WHERE content = '#pragma once\nint a;\n';") == 1);
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM filecontent_ref;") == 2);
+			REQUIRE(
+				database.execScalar(("SELECT COUNT(*) FROM filecontent_ref WHERE content_file_id = " + std::to_string(fileIds[0]) + ";").c_str()) ==
+				2);
+			REQUIRE(
+				std::string(database.execQuery("SELECT value FROM meta WHERE key = 'storage_version';").getStringField(0, "")) == "25");
+			database.close();
+
+			SourcetrailDBReader reader;
+			REQUIRE(reader.open(databasePath));
+			for (const int fileId: fileIds)
+			{
+				REQUIRE(reader.getFileContent(fileId) == "#pragma once\nint a;\n");
+			}
+			reader.close();
+
+			// the content is kept for the other files when the file that stores it is removed
+			writer.open(databasePath);
+			REQUIRE(writer.removeFile(fileIds[0]));
+			REQUIRE(writer.getLastError() == "");
+			writer.close();
+
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM filecontent;") == 1);
+			REQUIRE(
+				database.execScalar(("SELECT COUNT(*) FROM filecontent WHERE id = " + std::to_string(fileIds[1]) + ";").c_str()) == 1);
+			REQUIRE(
+				database.execScalar(("SELECT content_file_id FROM filecontent_ref WHERE file_id = " + std::to_string(fileIds[2]) + ";").c_str()) ==
+				fileIds[1]);
+			database.close();
+
+			reader.open(databasePath);
+			REQUIRE(reader.getFileContent(fileIds[0]) == "");
+			REQUIRE(reader.getFileContent(fileIds[2]) == "#pragma once\nint a;\n");
+			reader.close();
+
+			for (const std::string& filePath: filePaths)
+			{
+				std::remove(filePath.c_str());
+			}
+		}
+
+		SECTION("writer compares contents with the same hash")
+		{
+			const std::string databasePath = "testing.db";
+			const std::string filePath = "testing_collision.h";
+			const std::string otherFilePath = "testing_collision_other.h";
+			const std::string content = "int a;\n";
+			std::ofstream(filePath, std::ios::binary) << content;
+			std::ofstream(otherFilePath, std::ios::binary) << "int b;\n";
+
+			SourcetrailDBWriter writer;
+			writer.open(databasePath);
+			writer.clear();
+			const int otherFileId = writer.recordFile(otherFilePath);
+			writer.close();
+
+			// a stored content whose hash collides with the one of the file
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			{
+				const std::string hash = utility::getContentHash(content.data(), content.size());
+				CppSQLite3Statement statement = database.compileStatement("UPDATE file_state SET content_hash = ? WHERE file_id = ?;");
+				statement.bind(1, reinterpret_cast<const unsigned char*>(hash.data()), static_cast<int>(hash.size()));
+				statement.bind(2, otherFileId);
+				statement.execDML();
+			}
+			database.close();
+
+			writer.open(databasePath);
+			writer.enableFileContentDeduplication();
+			const int fileId = writer.recordFile(filePath);
+			REQUIRE(writer.getLastError() == "");
+			writer.close();
+
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM filecontent_ref;") == 0);
+			CppSQLite3Query query = database.execQuery(("SELECT content FROM filecontent WHERE id = " + std::to_string(fileId) + ";").c_str());
+			REQUIRE(std::string(query.getStringField(0)) == content);
+			query.finalize();
+			database.close();
+
+			std::remove(filePath.c_str());
+			std::remove(otherFilePath.c_str());
+		}
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter updates and removes files")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		const int fileA = writer.beginFileUpdate("a.cpp");
+		REQUIRE(fileA != 0);
+		REQUIRE(writer.beginFileUpdate("b.cpp") == 0);
+		writer.clearLastError();
+		const int idFoo = writer.recordSymbol({ "::", { { "", "ns", "" }, { "void", "foo", "()" } } });
+		const int idBar = writer.recordSymbol({ "::", { { "", "ns", "" }, { "void", "bar", "()" } } });
+		writer.recordSymbolLocation(idFoo, { fileA, 1, 1, 1, 3 });
+		const int idCall = writer.recordReference(idFoo, idBar, ReferenceKind::CALL);
+		writer.recordReferenceLocation(idCall, { fileA, 2, 1, 2, 3 });
+		writer.recordLocalSymbol("a.cpp<1:1>");
+		REQUIRE(writer.endFileUpdate());
+		REQUIRE(!writer.endFileUpdate());
+		writer.clearLastError();
+
+		const int fileB = writer.beginFileUpdate("b.cpp");
+		writer.recordSymbol({ "::", { { "", "ns", "" }, { "void", "bar", "()" } } });
+		writer.recordSymbolLocation(idBar, { fileB, 1, 1, 1, 3 });
+		const int idBaz = writer.recordSymbol({ "::", { { "", "other", "" }, { "void", "baz", "()" } } });
+		writer.recordSymbolLocation(idBaz, { fileB, 2, 1, 2, 3 });
+		writer.endFileUpdate();
+		REQUIRE(writer.getLastError() == "");
+
+		// a.cpp, b.cpp, ns, foo, bar, other, baz
+		REQUIRE(storage->getAll<StorageNode>().size() == 7);
+		REQUIRE(storage->getAll<StorageLocalSymbol>().size() == 1);
+
+		SECTION("updating a file replaces its data")
+		{
+			REQUIRE(writer.beginFileUpdate("a.cpp") == fileA);
+			const int idQux = writer.recordSymbol({ "::", { { "", "ns", "" }, { "void", "qux", "()" } } });
+			writer.recordSymbolLocation(idQux, { fileA, 1, 1, 1, 3 });
+			writer.endFileUpdate();
+			REQUIRE(writer.getLastError() == "");
+
+			const std::vector<StorageNode> nodes = storage->getAll<StorageNode>();
+			REQUIRE(nodes.size() == 7);
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.id == idFoo; }) == 0);
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.id == idBar; }) == 1);
+			REQUIRE(storage->getAll<StorageLocalSymbol>().size() == 0);
+			REQUIRE(storage->getAll<StorageFile>().size() == 2);
+
+			// ns, bar and qux with their MEMBER edges
+			for (const StorageEdge& edge: storage->getAll<StorageEdge>())
+			{
+				REQUIRE(edge.edgeKind == edgeKindToInt(EdgeKind::MEMBER));
+			}
+			REQUIRE(storage->getAll<StorageEdge>().size() == 3);
+			REQUIRE(storage->getAll<StorageSourceLocation>().size() == 3);
+		}
+
+		SECTION("removing a file keeps symbols used by other files")
+		{
+			REQUIRE(writer.removeFile(fileB));
+			REQUIRE(writer.getLastError() == "");
+
+			// bar is still referenced from a.cpp
+			const std::vector<StorageNode> nodes = storage->getAll<StorageNode>();
+			REQUIRE(nodes.size() == 4);
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.id == idBar; }) == 1);
+			REQUIRE(storage->getAll<StorageFile>().size() == 1);
+			REQUIRE(storage->getAll<StorageSourceLocation>().size() == 2);
+
+			REQUIRE(writer.removeFile(fileA));
+			REQUIRE(storage->getAll<StorageNode>().size() == 0);
+			REQUIRE(storage->getAll<StorageEdge>().size() == 0);
+			REQUIRE(storage->getAll<StorageOccurrence>().size() == 0);
+		}
+
+		SECTION("files are only tracked per element within file updates")
+		{
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			const int elementFileCount = database.execScalar("SELECT COUNT(*) FROM element_file;");
+			const std::string indexCountQuery =
+				"SELECT COUNT(*) FROM sqlite_master WHERE name IN ('edge_target_node_index', 'occurrence_source_location_index');";
+			REQUIRE(database.execScalar(indexCountQuery.c_str()) == 0);
+
+			const int fileC = writer.recordFile("c.cpp");
+			const int idQux = writer.recordSymbol({ "::", { { "", "ns", "" }, { "void", "qux", "()" } } });
+			writer.recordSymbolLocation(idQux, { fileC, 1, 1, 1, 3 });
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM element_file;") == elementFileCount);
+
+			REQUIRE(writer.removeFile(fileC));
+			REQUIRE(database.execScalar(indexCountQuery.c_str()) == 2);
+			database.close();
+		}
+
+		SECTION("removing a symbol id is rejected")
+		{
+			REQUIRE(!writer.removeFile(idBar));
+			REQUIRE(writer.getLastError() != "");
+			writer.clearLastError();
+			REQUIRE(storage->getAll<StorageNode>().size() == 7);
+			REQUIRE(storage->getAll<StorageSourceLocation>().size() == 4);
+		}
+
+		SECTION("failing file updates keep the database unchanged")
+		{
+			// files cannot be removed during a bulk load
+			REQUIRE(writer.beginBulkLoad());
+			REQUIRE(writer.beginFileUpdate("c.cpp") == 0);
+			REQUIRE(writer.getLastError() != "");
+			writer.clearLastError();
+			REQUIRE(writer.endBulkLoad());
+
+			REQUIRE(storage->getAll<StorageNode>().size() == 7);
+			REQUIRE(storage->getAll<StorageFile>().size() == 2);
+		}
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter detects changed files")
+	{
+		const std::string databasePath = "testing.db";
+		const std::string filePath = "testing_changed.cpp";
+		std::ofstream(filePath, std::ios::binary) << "int a;\n";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(!writer.isFileUpToDate(filePath));
+		writer.recordFile(filePath);
+		REQUIRE(writer.isFileUpToDate(filePath));
+		REQUIRE(!writer.isFileUpToDate("testing_unknown.cpp"));
+
+		SECTION("touched files are up to date")
+		{
+			struct utimbuf times;
+			times.actime = time(0) - 1000;
+			times.modtime = time(0) - 1000;
+			REQUIRE(utime(filePath.c_str(), &times) == 0);
+			REQUIRE(writer.isFileUpToDate(filePath));
+
+			std::ofstream(filePath, std::ios::binary) << "int b;\n";
+			REQUIRE(!writer.isFileUpToDate(filePath));
+		}
+
+		SECTION("files of different size have changed")
+		{
+			std::ofstream(filePath, std::ios::binary) << "int a, b;\n";
+			REQUIRE(!writer.isFileUpToDate(filePath));
+
+			REQUIRE(writer.beginFileUpdate(filePath) != 0);
+			writer.endFileUpdate();
+			REQUIRE(writer.isFileUpToDate(filePath));
+		}
+
+		REQUIRE(writer.getLastError() == "");
+		writer.close();
+		std::remove(filePath.c_str());
+	}
+
 	TEST_CASE("Testing SourcetrailDBWriter records local symbols")
 	{
 		const std::string databasePath = "testing.db";
@@ -599,4 +988,1100 @@ namespace sourcetrail
 		writer.close();
 		REQUIRE(writer.getLastError() == "");
 	}
+	TEST_CASE("Testing SourcetrailDBWriter deduplicates across sessions and rollbacks")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		const NameHierarchy nameSymbol1({ "::" ,{ { "", "ns", "" }, { "void", "foo", "()" } } });
+		const int idSymbol1 = writer.recordSymbol(nameSymbol1);
+		const int idSymbol2 = writer.recordSymbol({ "::" ,{ { "", "ns", "" }, { "void", "bar", "()" } } });
+		const int idReference1 = writer.recordReference(idSymbol1, idSymbol2, ReferenceKind::CALL);
+		const int idLocalSymbol1 = writer.recordLocalSymbol("local");
+		REQUIRE(idReference1 != 0);
+		REQUIRE(writer.getLastError() == "");
+
+		SECTION("writer finds elements recorded by a previous session")
+		{
+			writer.close();
+			writer.open(databasePath);
+			REQUIRE(writer.getLastError() == "");
+
+			REQUIRE(writer.recordSymbol(nameSymbol1) == idSymbol1);
+			REQUIRE(writer.recordReference(idSymbol1, idSymbol2, ReferenceKind::CALL) == idReference1);
+			REQUIRE(writer.recordLocalSymbol("local") == idLocalSymbol1);
+			REQUIRE(writer.getLastError() == "");
+
+			REQUIRE(storage->getAll<StorageNode>().size() == 3);
+			REQUIRE(storage->getAll<StorageEdge>().size() == 3);
+			REQUIRE(storage->getAll<StorageLocalSymbol>().size() == 1);
+		}
+
+		SECTION("writer does not hand out ids of rolled back elements")
+		{
+			writer.beginTransaction();
+			const NameHierarchy nameSymbol3({ "::" ,{ { "", "ns", "" }, { "void", "baz", "()" } } });
+			writer.recordSymbol(nameSymbol3);
+			writer.rollbackTransaction();
+			REQUIRE(writer.getLastError() == "");
+
+			const int idSymbol3 = writer.recordSymbol(nameSymbol3);
+			REQUIRE(idSymbol3 != 0);
+			REQUIRE(writer.recordSymbol(nameSymbol1) == idSymbol1);
+			REQUIRE(writer.getLastError() == "");
+
+			bool found = false;
+			for (const StorageNode& node: storage->getAll<StorageNode>())
+			{
+				found |= node.id == idSymbol3;
+			}
+			REQUIRE(found);
+			REQUIRE(storage->getAll<StorageNode>().size() == 4);
+		}
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+	TEST_CASE("Testing SourcetrailDBWriter reserves element ids in transactions")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		writer.beginTransaction();
+		std::set<int> ids;
+		for (int i = 0; i < 100; i++)
+		{
+			ids.insert(writer.recordSymbol({ "::", { { "", "symbol" + std::to_string(i), "" } } }));
+		}
+		REQUIRE(ids.size() == 100);
+		REQUIRE(ids.count(0) == 0);
+
+		writer.beginSavepoint("file");
+		const int idRolledBack = writer.recordSymbol({ "::", { { "", "rolled_back", "" } } });
+		writer.rollbackToSavepoint("file");
+		REQUIRE(writer.recordSymbol({ "::", { { "", "kept", "" } } }) == idRolledBack);
+		const int fileId = writer.recordFile("path/to/non_existing_file.cpp");
+		REQUIRE(writer.recordError("error", false, { fileId, 1, 1, 1, 1 }));
+		writer.commitTransaction();
+
+		writer.recordLocalSymbol("local");
+		REQUIRE(writer.getLastError() == "");
+		writer.close();
+
+		// reserved ids that have not been handed out are removed on commit
+		CppSQLite3DB database;
+		database.open(databasePath.c_str());
+		REQUIRE(database.execScalar("SELECT COUNT(*) FROM element;") == 104);
+		REQUIRE(
+			database.execScalar(
+				"SELECT COUNT(*) FROM element WHERE id NOT IN (SELECT id FROM node) AND id NOT IN (SELECT id FROM error) "
+				"AND id NOT IN (SELECT id FROM local_symbol);") == 0);
+		database.close();
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records nested name hierarchies")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		const NameHierarchy nameMethod1({ "::" ,{ { "", "ns", "" }, { "", "a", "" }, { "", "Class", "" }, { "void", "foo", "()" } } });
+		const NameHierarchy nameMethod2({ "::" ,{ { "", "ns", "" }, { "", "a", "" }, { "", "Class", "" }, { "int", "bar", "() const" } } });
+		const int idMethod1 = writer.recordSymbol(nameMethod1);
+		const int idMethod2 = writer.recordSymbol(nameMethod2);
+		REQUIRE(idMethod1 != 0);
+		REQUIRE(idMethod2 != 0);
+		REQUIRE(writer.getLastError() == "");
+
+		const std::vector<StorageNode> nodes = storage->getAll<StorageNode>();
+		REQUIRE(nodes.size() == 5);
+
+		const std::vector<StorageEdge> edges = storage->getAll<StorageEdge>();
+		REQUIRE(edges.size() == 4);
+
+		NameHierarchy prefix({ "::", {} });
+		for (const NameElement& element: nameMethod1.nameElements)
+		{
+			prefix.nameElements.push_back(element);
+			const std::string serializedName = serializeNameHierarchyToDatabaseString(prefix);
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.serializedName == serializedName; }) == 1);
+		}
+
+		int idClass = 0;
+		for (const StorageEdge& edge: edges)
+		{
+			REQUIRE(edge.edgeKind == edgeKindToInt(EdgeKind::MEMBER));
+			if (edge.targetNodeId == idMethod1)
+			{
+				idClass = edge.sourceNodeId;
+			}
+		}
+		REQUIRE(idClass != 0);
+		REQUIRE(std::count_if(edges.begin(), edges.end(), [&](const StorageEdge& edge) { return edge.sourceNodeId == idClass; }) == 2);
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records symbols built by a NameHierarchyBuilder")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		const NameHierarchy nameMethod({ "::" ,{ { "", "ns", "" }, { "", "Class", "" }, { "void", "foo", "()" } } });
+		const int idMethod = writer.recordSymbol(nameMethod);
+
+		NameHierarchyBuilder builder("::");
+		builder.pushNameElement("ns");
+		builder.pushNameElement("Class");
+		builder.pushNameElement("void", "foo", "()");
+		REQUIRE(serializeNameHierarchyToDatabaseString(builder.toNameHierarchy()) == serializeNameHierarchyToDatabaseString(nameMethod));
+		REQUIRE(writer.recordSymbol(builder) == idMethod);
+
+		builder.popNameElement();
+		builder.pushNameElement("int", "bar", "()");
+		const int idOtherMethod = writer.recordSymbol(builder);
+		REQUIRE(idOtherMethod != 0);
+		REQUIRE(idOtherMethod != idMethod);
+
+		// names that have been used before are interned once
+		const size_t internedStringCount = builder.getInternedStringCount();
+		builder.clear();
+		builder.pushNameElement("ns");
+		builder.pushNameElement("Class");
+		builder.pushNameElement("int", "bar", "()");
+		REQUIRE(builder.getInternedStringCount() == internedStringCount);
+		REQUIRE(writer.recordSymbol(builder) == idOtherMethod);
+
+		// names can be taken from a buffer without terminating them
+		const char* source = "ns::Class";
+		builder.clear();
+		builder.pushNameElement(source, 2);
+		builder.pushNameElement(source + 4, 5);
+		builder.pushNameElement("int", "bar", "()");
+		REQUIRE(builder.getInternedStringCount() == internedStringCount);
+		REQUIRE(writer.recordSymbol(builder) == idOtherMethod);
+
+		builder.clear();
+		REQUIRE(writer.recordSymbol(builder) == 0);
+		REQUIRE(writer.getLastError() != "");
+
+		writer.close();
+	}
+
+	TEST_CASE("Testing NameHierarchyView decodes serialized names")
+	{
+		const NameHierarchy nameMethod({ "::" ,{ { "", "ns", "" }, { "void", "foo", "(int)" } } });
+		const NameHierarchy nameField({ ".", { { "", "Class", "" }, { "", "field", "" } } });
+
+		// views of several names share one buffer
+		const std::string serializedMethod = serializeNameHierarchyToDatabaseString(nameMethod);
+		const std::string serializedField = serializeNameHierarchyToDatabaseString(nameField);
+		const std::shared_ptr<const std::string> buffer = std::make_shared<const std::string>(serializedMethod + serializedField);
+		const NameHierarchyView viewMethod(buffer, 0, serializedMethod.size());
+		const NameHierarchyView viewField(buffer, serializedMethod.size(), serializedField.size());
+
+		REQUIRE(viewMethod.getNameElementCount() == 2);
+		REQUIRE(std::string(viewMethod.getNameDelimiter().data, viewMethod.getNameDelimiter().size) == "::");
+		const NameHierarchyView::Element element = viewMethod.getNameElement(1);
+		REQUIRE(std::string(element.prefix.data, element.prefix.size) == "void");
+		REQUIRE(std::string(element.name.data, element.name.size) == "foo");
+		REQUIRE(std::string(element.postfix.data, element.postfix.size) == "(int)");
+		REQUIRE(viewMethod.getQualifiedName() == "ns::foo");
+		REQUIRE(serializeNameHierarchyToDatabaseString(viewMethod.toNameHierarchy()) == serializedMethod);
+
+		REQUIRE(viewField.getQualifiedName() == "Class.field");
+		REQUIRE(serializeNameHierarchyToDatabaseString(viewField.toNameHierarchy()) == serializedField);
+
+		// names that are not in database format become a single element
+		const NameHierarchyView viewPlain("plain");
+		REQUIRE(viewPlain.getNameElementCount() == 1);
+		REQUIRE(viewPlain.getQualifiedName() == "plain");
+		REQUIRE(NameHierarchyView().getNameElementCount() == 0);
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter records batches")
+	{
+		const std::string databasePath = "testing.db";
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		// more than one multi-row statement worth of records, plus a remainder
+		std::vector<NameHierarchy> names;
+		for (int i = 0; i < 100; i++)
+		{
+			names.push_back(NameHierarchy({ "::", { { "", "ns", "" }, { "void", "foo" + std::to_string(i % 90), "()" } } }));
+		}
+
+		const std::vector<int> symbolIds = writer.recordSymbols(names);
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(symbolIds.size() == 100);
+		REQUIRE(symbolIds[5] == symbolIds[95]);
+		REQUIRE(writer.recordSymbol(names[42]) == symbolIds[42]);
+		REQUIRE(storage->getAll<StorageNode>().size() == 91);
+		REQUIRE(storage->getAll<StorageEdge>().size() == 90);
+
+		std::vector<SourcetrailDBWriter::ReferenceRecord> references;
+		for (int i = 1; i < 100; i++)
+		{
+			references.push_back({ symbolIds[0], symbolIds[i], ReferenceKind::CALL });
+		}
+
+		const std::vector<int> referenceIds = writer.recordReferences(references);
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(referenceIds.size() == 99);
+		REQUIRE(referenceIds[4] == referenceIds[94]);
+		REQUIRE(writer.recordReference(symbolIds[0], symbolIds[7], ReferenceKind::CALL) == referenceIds[6]);
+		REQUIRE(storage->getAll<StorageEdge>().size() == 90 + 90);
+
+		const int fileId = writer.recordFile("/tmp/batch.cpp");
+		REQUIRE(fileId != 0);
+
+		std::vector<SourcetrailDBWriter::LocationRecord> locations;
+		for (int i = 0; i < 100; i++)
+		{
+			locations.push_back({ symbolIds[i], { fileId, i % 80 + 1, 1, i % 80 + 1, 10 }, LocationKind::TOKEN });
+		}
+		locations.push_back({ referenceIds[0], { fileId, 1, 1, 1, 10 }, LocationKind::TOKEN });
+
+		REQUIRE(writer.recordLocations(locations));
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(storage->getAll<StorageSourceLocation>().size() == 80);
+		REQUIRE(storage->getAll<StorageOccurrence>().size() == 101);
+
+		// a failing batch leaves no trace
+		names.push_back(NameHierarchy({ "::", {} }));
+		names.push_back(NameHierarchy({ "::", { { "", "unrelated", "" } } }));
+		REQUIRE(writer.recordSymbols(names).empty());
+		REQUIRE(writer.getLastError() != "");
+		REQUIRE(storage->getAll<StorageNode>().size() == 92);
+		writer.clearLastError();
+
+		REQUIRE(writer.recordSymbol(names.back()) != 0);
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(storage->getAll<StorageNode>().size() == 93);
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter bulk loads")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		writer.beginTransaction();
+		REQUIRE(!writer.beginBulkLoad());
+		REQUIRE(writer.getLastError() != "");
+		writer.commitTransaction();
+		writer.clearLastError();
+
+		REQUIRE(writer.beginBulkLoad());
+		REQUIRE(!writer.beginBulkLoad());
+		writer.clearLastError();
+
+		writer.beginTransaction();
+		const int idFoo = writer.recordSymbol({ "::", { { "void", "foo", "()" } } });
+		const int idBar = writer.recordSymbol({ "::", { { "void", "bar", "()" } } });
+		const int idCall = writer.recordReference(idFoo, idBar, ReferenceKind::CALL);
+		REQUIRE(writer.recordSymbol({ "::", { { "void", "foo", "()" } } }) == idFoo);
+		REQUIRE(writer.recordReference(idFoo, idBar, ReferenceKind::CALL) == idCall);
+		writer.commitTransaction();
+		REQUIRE(writer.getLastError() == "");
+
+		REQUIRE(writer.endBulkLoad());
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(!writer.endBulkLoad());
+		writer.clearLastError();
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+
+		writer.open(databasePath);
+		REQUIRE(writer.beginBulkLoad());
+		REQUIRE(writer.recordSymbol({ "::", { { "void", "bar", "()" } } }) == idBar);
+		REQUIRE(writer.close());
+		REQUIRE(writer.getLastError() == "");
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+		REQUIRE(storage->getAll<StorageNode>().size() == 2);
+		REQUIRE(storage->getAll<StorageEdge>().size() == 1);
+
+		// references to missing elements are only detected once the bulk load ends
+		writer.open(databasePath);
+		REQUIRE(writer.beginBulkLoad());
+		REQUIRE(writer.recordReference(idFoo, idBar + 1000, ReferenceKind::CALL) != 0);
+		REQUIRE(!writer.endBulkLoad());
+		REQUIRE(writer.getLastError() != "");
+		writer.clearLastError();
+
+		writer.close();
+		REQUIRE(writer.getLastError() == "");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter commits automatically")
+	{
+		const std::string databasePath = "testing.db";
+
+		SourcetrailDBWriter writer;
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.getLastError() == "");
+
+		REQUIRE(writer.enableAutoCommit({ 3, 0, 0 }));
+		REQUIRE(!writer.beginTransaction());
+		REQUIRE(writer.getLastError() != "");
+		writer.clearLastError();
+
+		writer.recordFile("a.cpp");
+		writer.recordSymbol({ "::", { { "void", "foo", "()" } } });
+		REQUIRE(writer.getCommitStatistics().commitCount == 0);
+		writer.recordSymbol({ "::", { { "void", "bar", "()" } } });
+		REQUIRE(writer.getLastError() == "");
+		REQUIRE(writer.getCommitStatistics().commitCount == 1);
+		REQUIRE(writer.getCommitStatistics().committedRecords == 3);
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+		REQUIRE(storage->getAll<StorageNode>().size() == 3);
+
+		SECTION("savepoints revert the records of a single file")
+		{
+			REQUIRE(writer.beginSavepoint("b.cpp"));
+			writer.recordFile("b.cpp");
+			writer.recordSymbol({ "::", { { "void", "baz", "()" } } });
+			writer.recordSymbol({ "::", { { "void", "qux", "()" } } });
+			REQUIRE(writer.getCommitStatistics().commitCount == 1);
+			REQUIRE(writer.rollbackToSavepoint("b.cpp"));
+			REQUIRE(!writer.rollbackToSavepoint("b.cpp"));
+			REQUIRE(writer.getLastError() != "");
+			writer.clearLastError();
+
+			REQUIRE(writer.beginSavepoint("c.cpp"));
+			writer.recordFile("c.cpp");
+			REQUIRE(writer.releaseSavepoint("c.cpp"));
+			REQUIRE(writer.getCommitStatistics().commitCount == 1);
+
+			REQUIRE(writer.disableAutoCommit());
+			REQUIRE(writer.getLastError() == "");
+			REQUIRE(writer.getCommitStatistics().commitCount == 2);
+			REQUIRE(writer.getCommitStatistics().committedRecords == 4);
+
+			REQUIRE(storage->getAll<StorageNode>().size() == 4);
+			REQUIRE(storage->getAll<StorageFile>().size() == 2);
+		}
+
+		SECTION("closing commits pending records")
+		{
+			writer.recordSymbol({ "::", { { "void", "baz", "()" } } });
+			REQUIRE(writer.close());
+			REQUIRE(writer.getCommitStatistics().committedRecords == 4);
+			REQUIRE(storage->getAll<StorageNode>().size() == 4);
+		}
+
+		writer.close();
+		writer.clearLastError();
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter stages databases in memory")
+	{
+		const std::string databasePath = "testing_staged.db";
+		std::remove(databasePath.c_str());
+
+		SECTION("records reach the database file when persisted")
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openStaged(databasePath, { 0, 0 }));
+			REQUIRE(writer.isStaged());
+			const int symbolId = writer.recordSymbol({ "::", { { "", "staged", "" } } });
+			REQUIRE(symbolId != 0);
+
+			int copiedPages = 0;
+			int totalPages = 0;
+			REQUIRE(writer.persist([&](int copied, int total) {
+				copiedPages = copied;
+				totalPages = total;
+			}));
+			REQUIRE(totalPages > 0);
+			REQUIRE(copiedPages == totalPages);
+
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM node;") == 1);
+			database.close();
+
+			// closing persists the remaining changes
+			writer.recordSymbol({ "::", { { "", "closed", "" } } });
+			REQUIRE(writer.close());
+			REQUIRE(writer.getLastError() == "");
+
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM node;") == 2);
+			REQUIRE(std::string(database.execQuery("PRAGMA journal_mode;").getStringField(0, "")) == "delete");
+			database.close();
+
+			// an existing database is loaded into memory
+			REQUIRE(writer.openStaged(databasePath, { 0, 0 }));
+			REQUIRE(writer.recordSymbol({ "::", { { "", "staged", "" } } }) == symbolId);
+			REQUIRE(writer.close());
+		}
+
+		SECTION("databases stay open if they cannot be persisted on close")
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.openStaged(databasePath, { 0, 0 }));
+			REQUIRE(writer.recordSymbol({ "::", { { "", "staged", "" } } }) != 0);
+
+			// a directory in place of the database file cannot be written
+#ifdef _WIN32
+			REQUIRE(_mkdir(databasePath.c_str()) == 0);
+#else
+			REQUIRE(mkdir(databasePath.c_str(), 0755) == 0);
+#endif
+			REQUIRE(!writer.close());
+			REQUIRE(writer.getLastError() != "");
+			writer.clearLastError();
+			REQUIRE(writer.recordSymbol({ "::", { { "", "recorded", "" } } }) != 0);
+
+#ifdef _WIN32
+			REQUIRE(_rmdir(databasePath.c_str()) == 0);
+#else
+			REQUIRE(rmdir(databasePath.c_str()) == 0);
+#endif
+			REQUIRE(writer.close());
+			REQUIRE(!writer.close());
+
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM node;") == 2);
+			database.close();
+		}
+
+		SECTION("databases exceeding the memory budget are not staged")
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			writer.recordSymbol({ "::", { { "", "symbol", "" } } });
+			REQUIRE(writer.close());
+
+			REQUIRE(!writer.openStaged(databasePath, { 1024, 0 }));
+			REQUIRE(writer.getLastError() != "");
+			REQUIRE(!writer.persist());
+		}
+
+		std::remove(databasePath.c_str());
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter collects statistics")
+	{
+		const std::string databasePath = "testing_statistics.db";
+		std::remove(databasePath.c_str());
+
+		SourcetrailDBWriter writer;
+		REQUIRE(!writer.enableStatistics());
+		REQUIRE(writer.open(databasePath));
+		REQUIRE(writer.enableStatistics());
+
+		const int fileId = writer.recordFile("file.cpp");
+		const int symbolId = writer.recordSymbol({ "::", { { "", "foo", "" } } });
+		const int otherSymbolId = writer.recordSymbol({ "::", { { "", "bar", "" } } });
+		REQUIRE(writer.recordReference(symbolId, otherSymbolId, ReferenceKind::CALL) ==
+			writer.recordReference(symbolId, otherSymbolId, ReferenceKind::CALL));
+		REQUIRE(writer.recordSymbolLocation(symbolId, { fileId, 1, 1, 1, 3 }));
+		REQUIRE(writer.recordSymbolLocation(symbolId, { fileId, 1, 1, 1, 3 }));
+
+		StorageStatistics statistics = writer.getStatistics();
+		REQUIRE(statistics.files.calls == 1);
+		REQUIRE(statistics.files.rows == 1);
+		REQUIRE(statistics.edges.calls == 2);
+		REQUIRE(statistics.edges.rows == 1);
+		REQUIRE(statistics.edgeLookups.misses == 1);
+		REQUIRE(statistics.edgeLookups.cacheHits + statistics.edgeLookups.databaseHits == 1);
+		REQUIRE(statistics.sourceLocations.calls == 2);
+		REQUIRE(statistics.sourceLocations.rows == 1);
+		REQUIRE(statistics.sourceLocationLookups.cacheHits + statistics.sourceLocationLookups.databaseHits == 1);
+		REQUIRE(statistics.sqliteMilliseconds > 0.0);
+		REQUIRE(storageStatisticsToJson(statistics).find("\"edge_lookups\"") != std::string::npos);
+
+		REQUIRE(writer.resetStatistics());
+		REQUIRE(writer.disableStatistics());
+		writer.recordSymbol({ "::", { { "", "baz", "" } } });
+		statistics = writer.getStatistics();
+		REQUIRE(statistics.nodes.calls == 0);
+		REQUIRE(statistics.sqliteMilliseconds == 0.0);
+
+		REQUIRE(writer.close());
+		REQUIRE(writer.getStatistics().nodes.calls == 0);
+		std::remove(databasePath.c_str());
+	}
+
+	TEST_CASE("Testing SourcetrailDBReader reads symbols with their definition kinds")
+	{
+		const std::string databasePath = "testing_reader.db";
+		std::remove(databasePath.c_str());
+
+		int fooId = 0;
+		int bazId = 0;
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			fooId = writer.recordSymbol({ "::", { { "", "foo", "" } } });
+			writer.recordSymbolDefinitionKind(fooId, DefinitionKind::EXPLICIT);
+			bazId = writer.recordSymbol({ "::", { { "", "bar", "" }, { "", "it's_baz", "" } } });
+			writer.recordSymbolDefinitionKind(bazId, DefinitionKind::IMPLICIT);
+			writer.recordSymbolKind(bazId, SymbolKind::FUNCTION);
+			REQUIRE(writer.close());
+		}
+
+		SourcetrailDBReader reader;
+		REQUIRE(reader.open(databasePath));
+
+		const std::vector<SourcetrailDBReader::Symbol> symbols = reader.getAllSymbols();
+		const std::vector<SourcetrailDBReader::SymbolBrief> briefs = reader.getAllSymbolsBrief();
+		REQUIRE(symbols.size() == briefs.size());
+		for (size_t i = 0; i < symbols.size(); i++)
+		{
+			REQUIRE(symbols[i].id == briefs[i].id);
+			REQUIRE(symbols[i].definitionKind == briefs[i].definitionKind);
+		}
+
+		const SourcetrailDBReader::Symbol baz = reader.getSymbolById(bazId);
+		REQUIRE(baz.id == bazId);
+		REQUIRE(baz.definitionKind == DefinitionKind::IMPLICIT);
+		REQUIRE(baz.symbolKind == SymbolKind::FUNCTION);
+		REQUIRE(baz.nameHierarchy.nameElements.size() == 2);
+
+		REQUIRE(reader.findSymbolsByName("it's_baz", true).size() == 1);
+		REQUIRE(reader.findSymbolsByName("s_ba").size() == 1);
+		REQUIRE(reader.findSymbolsByQualifiedName("bar::it's_baz", true).front().id == bazId);
+		REQUIRE(reader.findSymbolsByName("foo", true).front().definitionKind == DefinitionKind::EXPLICIT);
+
+		const std::vector<SourcetrailDBReader::SymbolView> views = reader.getAllSymbolViews();
+		REQUIRE(views.size() == symbols.size());
+		for (size_t i = 0; i < views.size(); i++)
+		{
+			REQUIRE(views[i].id == symbols[i].id);
+			REQUIRE(views[i].symbolKind == symbols[i].symbolKind);
+			REQUIRE(views[i].definitionKind == symbols[i].definitionKind);
+			REQUIRE(
+				serializeNameHierarchyToDatabaseString(views[i].name.toNameHierarchy()) ==
+				serializeNameHierarchyToDatabaseString(symbols[i].nameHierarchy));
+		}
+
+		std::vector<SourcetrailDBReader::SymbolView> visitedViews;
+		REQUIRE(reader.forEachSymbolView([&](const SourcetrailDBReader::SymbolView& view) {
+			visitedViews.push_back(view);
+			return true;
+		}));
+		REQUIRE(visitedViews.size() == views.size());
+		REQUIRE(visitedViews.back().name.getQualifiedName() == "bar::it's_baz");
+		REQUIRE(reader.getLastError() == "");
+
+		REQUIRE(reader.close());
+		std::remove(databasePath.c_str());
+	}
+
+	TEST_CASE("Testing SourcetrailDBReader visits symbols and references")
+	{
+		const std::string databasePath = "testing_reader.db";
+		std::remove(databasePath.c_str());
+
+		std::vector<int> symbolIds;
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			for (int i = 0; i < 5; i++)
+			{
+				symbolIds.push_back(writer.recordSymbol({ "::", { { "", "symbol_" + std::to_string(i), "" } } }));
+				writer.recordSymbolDefinitionKind(symbolIds.back(), DefinitionKind::EXPLICIT);
+			}
+			for (int i = 1; i < 5; i++)
+			{
+				writer.recordReference(symbolIds[0], symbolIds[i], i % 2 ? ReferenceKind::CALL : ReferenceKind::USAGE);
+			}
+			REQUIRE(writer.close());
+		}
+
+		SourcetrailDBReader reader;
+		REQUIRE(reader.open(databasePath));
+
+		std::vector<int> visitedIds;
+		REQUIRE(reader.forEachSymbol([&](const SourcetrailDBReader::Symbol& symbol) {
+			visitedIds.push_back(symbol.id);
+			// the visitor may run other queries meanwhile
+			return reader.getSymbolById(symbol.id).nameHierarchy.nameElements.size() == 1;
+		}));
+		REQUIRE(visitedIds == symbolIds);
+
+		SECTION("pages are continued after the last visited id")
+		{
+			std::vector<int> pagedIds;
+			int afterId = 0;
+			size_t pageSize = 0;
+			do
+			{
+				pageSize = 0;
+				REQUIRE(reader.forEachSymbol(
+					[&](const SourcetrailDBReader::Symbol& symbol) {
+						pagedIds.push_back(symbol.id);
+						afterId = symbol.id;
+						pageSize++;
+						return true;
+					},
+					afterId,
+					2));
+			} while (pageSize == 2);
+			REQUIRE(pagedIds == symbolIds);
+		}
+
+		SECTION("visitor stops the iteration")
+		{
+			size_t visitCount = 0;
+			REQUIRE(reader.forEachEdge([&](const SourcetrailDBReader::Reference&) { return ++visitCount < 3; }));
+			REQUIRE(visitCount == 3);
+		}
+
+		SECTION("references match the materialized queries")
+		{
+			std::vector<int> edgeIds;
+			REQUIRE(reader.forEachEdgeOfType(EdgeKind::CALL, [&](const SourcetrailDBReader::Reference& reference) {
+				REQUIRE(reference.sourceSymbolId == symbolIds[0]);
+				edgeIds.push_back(reference.id);
+				return true;
+			}));
+			const std::vector<SourcetrailDBReader::Reference> references = reader.getReferencesByType(EdgeKind::CALL);
+			REQUIRE(edgeIds.size() == 2);
+			REQUIRE(references.size() == 2);
+			REQUIRE(references.front().id == edgeIds.front());
+			REQUIRE(reader.getAllReferences().size() == reader.getAllEdgesBrief().size());
+		}
+
+		REQUIRE(reader.getLastError() == "");
+		REQUIRE(reader.close());
+		REQUIRE(!reader.forEachEdge([](const SourcetrailDBReader::Reference&) { return true; }));
+		std::remove(databasePath.c_str());
+	}
+
+	TEST_CASE("Testing DatabaseStorage read helpers bind their parameters")
+	{
+		const std::string databasePath = "testing_reader.db";
+		std::remove(databasePath.c_str());
+
+		const NameHierarchy quotedName({ "::", { { "", "it's \"quoted\"", "" } } });
+		int quotedId = 0;
+		int otherId = 0;
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			quotedId = writer.recordSymbol(quotedName);
+			otherId = writer.recordSymbol({ "::", { { "", "other", "" } } });
+			writer.recordSymbolDefinitionKind(quotedId, DefinitionKind::EXPLICIT);
+			writer.recordReference(quotedId, otherId, ReferenceKind::CALL);
+			writer.recordReference(quotedId, otherId, ReferenceKind::USAGE);
+			writer.recordReference(otherId, quotedId, ReferenceKind::TYPE_USAGE);
+			REQUIRE(writer.close());
+		}
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+		const std::string serializedName = serializeNameHierarchyToDatabaseString(quotedName);
+
+		for (int i = 0; i < 2; i++) // the second round runs on the cached statements
+		{
+			REQUIRE(storage->getNodesBySerializedNameExact(serializedName).size() == 1);
+			REQUIRE(storage->getNodesBySerializedNameLike("%it's%").front().id == quotedId);
+			REQUIRE(storage->getNodeById(quotedId).serializedName == serializedName);
+			REQUIRE(storage->getNodeById(0).id == 0);
+
+			REQUIRE(storage->getEdgesFromNode(quotedId).size() == 2);
+			REQUIRE(storage->getEdgesToNode(quotedId).size() == 1);
+			REQUIRE(storage->getEdgesByType(edgeKindToInt(EdgeKind::CALL)).size() == 1);
+			REQUIRE(storage->getAllSymbolNodes().size() == 1);
+			REQUIRE(storage->getEdgesFromNodeOfKinds(quotedId, {}).empty());
+			REQUIRE(storage->getEdgesFromNodeOfKinds(quotedId, { edgeKindToInt(EdgeKind::USAGE) }).size() == 1);
+			REQUIRE(
+				storage->getEdgesFromNodeOfKinds(quotedId, { edgeKindToInt(EdgeKind::CALL), edgeKindToInt(EdgeKind::USAGE) }).size() == 2);
+		}
+
+		storage.reset();
+		std::remove(databasePath.c_str());
+	}
+
+	TEST_CASE("Testing SourcetrailDBReader finds symbols through the node_name table")
+	{
+		const std::string databasePath = "testing_reader.db";
+		const std::string mergedDatabasePath = "testing_merged.db";
+		std::remove(databasePath.c_str());
+		std::remove(mergedDatabasePath.c_str());
+
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			std::vector<int> symbolIds = writer.recordSymbols({
+				NameHierarchy({ "::", { { "", "ns", "" }, { "", "Widget", "" } } }),
+				NameHierarchy({ "::", { { "", "ns", "" }, { "", "widget_factory", "" } } }),
+			});
+			symbolIds.push_back(writer.recordSymbol({ "::", { { "", "other", "" }, { "", "Widget", "" }, { "void", "draw", "() const" } } }));
+			symbolIds.push_back(writer.recordSymbol({ "::", { { "", "other", "" }, { "", "Gadget", "" } } }));
+			for (int symbolId: symbolIds)
+			{
+				writer.recordSymbolDefinitionKind(symbolId, DefinitionKind::EXPLICIT);
+			}
+			REQUIRE(writer.close());
+		}
+
+		const auto requireLookups = [](const std::string& path, bool hasNodeNames) {
+			REQUIRE(DatabaseStorage::openDatabase(path)->hasNodeNames() == hasNodeNames);
+
+			SourcetrailDBReader reader;
+			REQUIRE(reader.open(path));
+			REQUIRE(reader.findSymbolsByName("Widget", true).size() == 1);
+			REQUIRE(reader.findSymbolsByName("draw", true).size() == 1);
+			REQUIRE(reader.findSymbolsByName("idge").size() == 2);
+			REQUIRE(reader.findSymbolsByQualifiedName("ns::Widget", true).size() == 1);
+			REQUIRE(reader.findSymbolsByQualifiedName("Widget::draw").size() == 1);
+			REQUIRE(reader.findSymbolsByQualifiedName("ns::draw").empty());
+			REQUIRE(reader.findSymbolsByNamePrefix("Wid").size() == 1);
+			REQUIRE(reader.findSymbolsByNamePrefix("wid", true).size() == 2);
+			REQUIRE(reader.findSymbolsByNamePrefix("").size() == 4);
+			REQUIRE(reader.getLastError() == "");
+		};
+
+		requireLookups(databasePath, true);
+
+		SECTION("nodes of merged databases get their names")
+		{
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(mergedDatabasePath));
+			REQUIRE(writer.mergeDatabase(databasePath));
+			REQUIRE(writer.close());
+			requireLookups(mergedDatabasePath, true);
+		}
+
+		SECTION("databases without node_name table are scanned until a writer adds the table")
+		{
+			{
+				CppSQLite3DB database;
+				database.open(databasePath.c_str());
+				database.execDML("DROP TABLE node_name;");
+				database.close();
+			}
+			requireLookups(databasePath, false);
+
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			REQUIRE(writer.close());
+			requireLookups(databasePath, true);
+		}
+
+		SECTION("nodes added by other writers are scanned until a writer adds their names")
+		{
+			{
+				CppSQLite3DB database;
+				database.open(databasePath.c_str());
+				database.execDML("INSERT INTO element(id) VALUES(1000);");
+				database.execDML("INSERT INTO node(id, type, serialized_name) VALUES(1000, 1, '::\tmlegacy\ts\tp');");
+				database.close();
+			}
+			REQUIRE(!DatabaseStorage::openDatabase(databasePath)->hasNodeNames());
+
+			SourcetrailDBWriter writer;
+			REQUIRE(writer.open(databasePath));
+			REQUIRE(writer.close());
+			requireLookups(databasePath, true);
+
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(database.execScalar("SELECT COUNT(*) FROM node_name WHERE id = 1000;") == 1);
+			database.close();
+		}
+
+		std::remove(databasePath.c_str());
+		std::remove(mergedDatabasePath.c_str());
+	}
+
+	TEST_CASE("Testing storage profiles")
+	{
+		const std::string databasePath = "testing.db";
+
+		REQUIRE(stringToStorageProfile(storageProfileToString(StorageProfile::BULK_INGEST)) == StorageProfile::BULK_INGEST);
+		REQUIRE(stringToStorageProfile(storageProfileToString(StorageProfile::READ_MOSTLY)) == StorageProfile::READ_MOSTLY);
+		REQUIRE(stringToStorageProfile("unknown") == StorageProfile::DEFAULT);
+
+		SourcetrailDBWriter writer;
+		REQUIRE(!writer.open(databasePath, getStorageOptions(StorageProfile::READ_MOSTLY)));
+		REQUIRE(writer.getLastError() != "");
+		writer.clearLastError();
+
+		REQUIRE(writer.open(databasePath, getStorageOptions(StorageProfile::BULK_INGEST)));
+		REQUIRE(writer.clear());
+		writer.beginTransaction();
+		const int symbolId = writer.recordSymbol({ "::", { { "void", "foo", "()" } } });
+		writer.recordSymbolDefinitionKind(symbolId, DefinitionKind::EXPLICIT);
+		writer.commitTransaction();
+		writer.beginTransaction();
+		writer.recordSymbol({ "::", { { "void", "bar", "()" } } });
+		writer.rollbackTransaction();
+		REQUIRE(writer.close());
+		REQUIRE(writer.getLastError() == "");
+
+		{
+			std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+			REQUIRE(storage->getLoadedStorageProfile() == "bulk-ingest");
+			REQUIRE(storage->getAll<StorageNode>().size() == 1);
+		}
+
+		{
+			// the write-ahead log is only used while the bulk ingesting writer is open
+			CppSQLite3DB database;
+			database.open(databasePath.c_str());
+			REQUIRE(std::string(database.execQuery("PRAGMA journal_mode;").getStringField(0, "")) == "delete");
+			database.close();
+		}
+
+		SourcetrailDBReader reader;
+		REQUIRE(reader.open(databasePath, getStorageOptions(StorageProfile::READ_MOSTLY)));
+		REQUIRE(reader.getSymbolById(symbolId).id == symbolId);
+		REQUIRE(reader.close());
+
+		REQUIRE(writer.open(databasePath));
+		REQUIRE(writer.close());
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+		REQUIRE(storage->getLoadedStorageProfile() == "default");
+	}
+
+	TEST_CASE("Testing SourcetrailDBWriter merges databases")
+	{
+		const std::string shardPathA = "testing_shard_a.db";
+		const std::string shardPathB = "testing_shard_b.db";
+		const std::string databasePath = "testing.db";
+
+		const NameHierarchy nameA({ "::", { { "", "ns", "" }, { "", "A", "" } } });
+		const NameHierarchy nameB({ "::", { { "", "ns", "" }, { "", "B", "" } } });
+		const NameHierarchy nameShared({ "::", { { "", "ns", "" }, { "", "Shared", "" } } });
+
+		SourcetrailDBWriter writer;
+		writer.open(shardPathA);
+		writer.clear();
+		{
+			const int fileId = writer.recordFile("/src/a.cpp");
+			const int idA = writer.recordSymbol(nameA);
+			writer.recordSymbolDefinitionKind(idA, DefinitionKind::EXPLICIT);
+			writer.recordSymbolLocation(idA, { fileId, 1, 7, 1, 7 });
+			const int idShared = writer.recordSymbol(nameShared);
+			writer.recordSymbolDefinitionKind(idShared, DefinitionKind::IMPLICIT);
+			const int referenceId = writer.recordReference(idA, idShared, ReferenceKind::TYPE_USAGE);
+			writer.recordReferenceLocation(referenceId, { fileId, 2, 3, 2, 8 });
+			writer.recordLocalSymbolLocation(writer.recordLocalSymbol("a.cpp<2:3>"), { fileId, 2, 3, 2, 8 });
+		}
+		REQUIRE(writer.close());
+
+		writer.open(shardPathB);
+		writer.clear();
+		{
+			const int fileId = writer.recordFile("/src/b.cpp");
+			writer.recordSymbol({ "::", { { "", "unrelated", "" } } }); // shifts the ids against shard A
+			const int idB = writer.recordSymbol(nameB);
+			writer.recordSymbolDefinitionKind(idB, DefinitionKind::EXPLICIT);
+			const int idShared = writer.recordSymbol(nameShared);
+			writer.recordSymbolDefinitionKind(idShared, DefinitionKind::EXPLICIT);
+			writer.recordSymbolKind(idShared, SymbolKind::CLASS);
+			writer.recordSymbolLocation(idShared, { fileId, 1, 7, 1, 12 });
+			const int idA = writer.recordSymbol(nameA);
+			writer.recordReference(idA, idShared, ReferenceKind::TYPE_USAGE);
+			writer.recordReferenceLocation(writer.recordReference(idB, idShared, ReferenceKind::TYPE_USAGE), { fileId, 3, 3, 3, 8 });
+		}
+		REQUIRE(writer.close());
+
+		writer.open(databasePath);
+		writer.clear();
+		REQUIRE(writer.mergeDatabase(shardPathA));
+		REQUIRE(writer.mergeDatabase(shardPathB));
+		REQUIRE(writer.getLastError() == "");
+
+		// merging the same data again does not add anything
+		REQUIRE(writer.mergeDatabase(shardPathA));
+
+		writer.beginTransaction();
+		REQUIRE(!writer.mergeDatabase(shardPathB));
+		writer.commitTransaction();
+		writer.clearLastError();
+
+		const int idShared = writer.recordSymbol(nameShared);
+		REQUIRE(writer.close());
+		REQUIRE(writer.getLastError() == "");
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+
+		const std::vector<StorageNode> nodes = storage->getAll<StorageNode>();
+		REQUIRE(nodes.size() == 7);
+		for (const StorageNode& node: nodes)
+		{
+			if (node.id == idShared)
+			{
+				REQUIRE(node.nodeKind == nodeKindToInt(symbolKindToNodeKind(SymbolKind::CLASS)));
+			}
+		}
+
+		const std::vector<StorageSymbol> symbols = storage->getAll<StorageSymbol>();
+		REQUIRE(symbols.size() == 3);
+		for (const StorageSymbol& symbol: symbols)
+		{
+			REQUIRE(symbol.definitionKind == definitionKindToInt(DefinitionKind::EXPLICIT));
+		}
+
+		// 3 member edges and 2 type usages
+		const std::vector<StorageEdge> edges = storage->getAll<StorageEdge>();
+		REQUIRE(edges.size() == 5);
+		for (const StorageEdge& edge: edges)
+		{
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.id == edge.sourceNodeId; }) == 1);
+			REQUIRE(std::count_if(nodes.begin(), nodes.end(), [&](const StorageNode& node) { return node.id == edge.targetNodeId; }) == 1);
+		}
+
+		REQUIRE(storage->getAll<StorageFile>().size() == 2);
+		REQUIRE(storage->getAll<StorageLocalSymbol>().size() == 1);
+		REQUIRE(storage->getAll<StorageSourceLocation>().size() == 5);
+		REQUIRE(storage->getAll<StorageOccurrence>().size() == 5);
+	}
+
+	TEST_CASE("Testing BoundedMpscQueue with multiple producers")
+	{
+		BoundedMpscQueue<int> queue(100);
+		REQUIRE(queue.getCapacity() == 128);
+
+		const int producerCount = 4;
+		const int valuesPerProducer = 10000;
+
+		std::vector<std::thread> producers;
+		for (int p = 0; p < producerCount; p++)
+		{
+			producers.emplace_back([&queue, p]() {
+				for (int i = 0; i < valuesPerProducer; i++)
+				{
+					int value = p * valuesPerProducer + i;
+					while (!queue.tryPush(value))
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+
+		std::vector<int> lastValueOfProducer(producerCount, -1);
+		bool inOrder = true;
+		int value = 0;
+		for (int popped = 0; popped < producerCount * valuesPerProducer;)
+		{
+			if (queue.tryPop(value))
+			{
+				const int producer = value / valuesPerProducer;
+				inOrder = inOrder && value > lastValueOfProducer[producer];
+				lastValueOfProducer[producer] = value;
+				popped++;
+			}
+		}
+
+		for (std::thread& producer: producers)
+		{
+			producer.join();
+		}
+
+		REQUIRE(inOrder);
+		REQUIRE(!queue.tryPop(value));
+		for (int p = 0; p < producerCount; p++)
+		{
+			REQUIRE(lastValueOfProducer[p] == (p + 1) * valuesPerProducer - 1);
+		}
+	}
+
+	TEST_CASE("Testing AsyncSourcetrailDBWriter records from multiple threads")
+	{
+		const std::string databasePath = "testing.db";
+
+		{
+			SourcetrailDBWriter writer;
+			writer.open(databasePath);
+			writer.clear();
+			writer.close();
+		}
+
+		AsyncSourcetrailDBWriter writer(64, 100);
+		REQUIRE(writer.recordSymbol({ "::", { { "", "closed", "" } } }).get() == 0);
+		REQUIRE(writer.getLastError() != "");
+		writer.clearLastError();
+
+		REQUIRE(writer.open(databasePath));
+
+		const int threadCount = 4;
+		const int symbolsPerThread = 200;
+		std::vector<std::vector<int>> symbolIds(threadCount);
+
+		std::vector<std::thread> threads;
+		for (int t = 0; t < threadCount; t++)
+		{
+			threads.emplace_back([&writer, &symbolIds, t]() {
+				const int fileId = writer.recordFile("/async/file_" + std::to_string(t) + ".cpp").get();
+				for (int i = 0; i < symbolsPerThread; i++)
+				{
+					// every thread records the same symbols
+					const int symbolId = writer.recordSymbol({ "::", { { "", "async", "" }, { "void", "f" + std::to_string(i), "()" } } }).get();
+					writer.recordSymbolKind(symbolId, SymbolKind::FUNCTION);
+					writer.recordSymbolLocation(symbolId, { fileId, i + 1, 1, i + 1, 5 });
+					symbolIds[t].push_back(symbolId);
+				}
+			});
+		}
+		for (std::thread& thread: threads)
+		{
+			thread.join();
+		}
+
+		REQUIRE(writer.flush());
+		REQUIRE(writer.getLastError() == "");
+
+		for (int t = 1; t < threadCount; t++)
+		{
+			REQUIRE(symbolIds[t] == symbolIds[0]);
+		}
+
+		// invalid ids are reported once the background thread has written them
+		writer.recordReferenceLocation(0, { 0, 1, 1, 1, 1 });
+		REQUIRE(!writer.flush());
+		REQUIRE(writer.getLastError() != "");
+		writer.clearLastError();
+
+		REQUIRE(writer.close());
+
+		std::shared_ptr<DatabaseStorage> storage = DatabaseStorage::openDatabase(databasePath);
+		REQUIRE(storage->getAll<StorageNode>().size() == 1 + symbolsPerThread + threadCount);
+		REQUIRE(storage->getAll<StorageSourceLocation>().size() == threadCount * symbolsPerThread);
+	}
 }
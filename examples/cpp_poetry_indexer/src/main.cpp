@@ -4,20 +4,23 @@
 #include <regex>
 
 #include "SourcetrailDBWriter.h"
-#include "NameHierarchy.h"
+#include "NameHierarchyBuilder.h"
 #include "SourceRange.h"
 
-sourcetrail::NameHierarchy toNameHierarchy(const std::vector<std::string>& strs)
+// one builder is reused for all symbols, so repeated author and poem names are stored only once
+sourcetrail::NameHierarchyBuilder nameBuilder(" - ");
+
+const sourcetrail::NameHierarchyBuilder& toNameHierarchy(const std::vector<std::string>& strs)
 {
-	sourcetrail::NameHierarchy name = { " - ", { } };
-	for (auto str : strs)
+	nameBuilder.clear();
+	for (const std::string& str : strs)
 	{
 		if (str.size())
 		{
-			name.nameElements.emplace_back( sourcetrail::NameElement({ "", str, "" }) );
+			nameBuilder.pushNameElement(str);
 		}
 	}
-	return name;
+	return nameBuilder;
 }
 
 int main(int argc, const char *argv[])
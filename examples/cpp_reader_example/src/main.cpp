@@ -42,7 +42,7 @@ void printReferenceInfo(const sourcetrail::SourcetrailDBReader::Reference& refer
     std::cout << "Reference ID: " << reference.id << std::endl;
     std::cout << "  From Symbol: " << reference.sourceSymbolId << std::endl;
     std::cout << "  To Symbol: " << reference.targetSymbolId << std::endl;
-    std::cout << "  Reference Kind: " << static_cast<int>(reference.referenceKind) << std::endl;
+    std::cout << "  Reference Kind: " << static_cast<int>(reference.edgeKind) << std::endl;
     std::cout << "  Locations: " << reference.locations.size() << std::endl;
     std::cout << std::endl;
 }
@@ -115,7 +115,7 @@ int main(int argc, const char* argv[])
                 for (const auto& ref : referencesToSymbol)
                 {
                     std::cout << "    From Symbol ID: " << ref.sourceSymbolId 
-                              << " (Kind: " << static_cast<int>(ref.referenceKind) << ")" << std::endl;
+                              << " (Kind: " << static_cast<int>(ref.edgeKind) << ")" << std::endl;
                 }
                 std::cout << std::endl;
             }
@@ -128,7 +128,7 @@ int main(int argc, const char* argv[])
                 for (const auto& ref : referencesFromSymbol)
                 {
                     std::cout << "    To Symbol ID: " << ref.targetSymbolId 
-                              << " (Kind: " << static_cast<int>(ref.referenceKind) << ")" << std::endl;
+                              << " (Kind: " << static_cast<int>(ref.edgeKind) << ")" << std::endl;
                 }
                 std::cout << std::endl;
             }
@@ -0,0 +1,98 @@
+#include <chrono>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "SourcetrailDBWriter.h"
+#include "StorageOptions.h"
+
+// Combines shard databases, e.g. written by several indexer processes working on disjoint sets of
+// files, into one Sourcetrail database.
+
+void printUsage()
+{
+	std::cout << "SourcetrailDB Database Merger" << std::endl;
+	std::cout << "=============================" << std::endl;
+	std::cout << std::endl;
+	std::cout << "Usage:" << std::endl;
+	std::cout << "  db_merger [--clear] <target_database_path> <shard_database_path>..." << std::endl;
+	std::cout << std::endl;
+	std::cout << "Description:" << std::endl;
+	std::cout << "  Merges all shard databases into the target database, which is created if it does not exist." << std::endl;
+	std::cout << "  Symbols, references and locations contained in several shards are stored only once." << std::endl;
+	std::cout << "  --clear removes all existing data from the target database first." << std::endl;
+}
+
+int main(int argc, const char* argv[])
+{
+	std::vector<std::string> arguments(argv + 1, argv + argc);
+
+	bool clearTarget = false;
+	if (!arguments.empty() && arguments.front() == "--clear")
+	{
+		clearTarget = true;
+		arguments.erase(arguments.begin());
+	}
+
+	if (arguments.size() < 2)
+	{
+		printUsage();
+		return 1;
+	}
+
+	const std::string targetPath = arguments.front();
+	const std::vector<std::string> shardPaths(arguments.begin() + 1, arguments.end());
+
+	// the id mapping tables of a merge can get as large as the shard, so they are kept on disk
+	sourcetrail::StorageOptions storageOptions = sourcetrail::getStorageOptions(sourcetrail::StorageProfile::BULK_INGEST);
+	storageOptions.tempStoreInMemory = false;
+
+	sourcetrail::SourcetrailDBWriter writer;
+	if (!writer.open(targetPath, storageOptions))
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	if (clearTarget && !writer.clear())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	if (!writer.beginBulkLoad())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	for (size_t i = 0; i < shardPaths.size(); i++)
+	{
+		std::cout << "[" << (i + 1) << "/" << shardPaths.size() << "] Merging " << shardPaths[i] << std::endl;
+		if (!writer.mergeDatabase(shardPaths[i]))
+		{
+			std::cerr << "error: " << writer.getLastError() << std::endl;
+			writer.close();
+			return 1;
+		}
+	}
+
+	std::cout << "Building indices..." << std::endl;
+	if (!writer.endBulkLoad())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		writer.close();
+		return 1;
+	}
+
+	if (!writer.close())
+	{
+		std::cerr << "error: " << writer.getLastError() << std::endl;
+		return 1;
+	}
+
+	std::cout << "Merged " << shardPaths.size() << " databases in "
+			  << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " seconds" << std::endl;
+	return 0;
+}
@@ -29,6 +29,13 @@ void printUsage()
 
 // Minimal helpers kept for logging in findtests
 
+// Name of an element of a symbol name, the view itself does not copy it
+std::string getNameElementName(const sourcetrail::NameHierarchyView& name, size_t index)
+{
+    const sourcetrail::NameHierarchyView::StringRef elementName = name.getNameElement(index).name;
+    return std::string(elementName.data, elementName.size);
+}
+
 // Get symbol kind name
 std::string getSymbolKindName(sourcetrail::SymbolKind kind)
 {
@@ -250,8 +257,10 @@ int main(int argc, const char* argv[])
                 std::cout << "  ID=" << s.id << "  FQN=" << fqn << "  Kind=" << (int)s.symbolKind << std::endl;
             }
 
-            // Load full symbols and compact edges into memory for fast traversal (avoid per-node lookups)
-            auto allSymbols = reader.getAllSymbols();
+            // Load symbols and compact edges into memory for fast traversal (avoid per-node lookups). Symbol names
+            // stay serialized in shared buffers instead of one NameHierarchy per symbol. Only the qualified name of
+            // every symbol is decoded below, because the FQN -> ids index needs all of them.
+            auto allSymbols = reader.getAllSymbolViews();
             auto briefEdges = reader.getAllEdgesBrief();
             if (!reader.getLastError().empty()) {
                 std::cerr << "Warning: reader reported: " << reader.getLastError() << std::endl;
@@ -263,11 +272,11 @@ int main(int argc, const char* argv[])
             }
             for (const auto& s : allSymbols) { if (s.id > maxId) maxId = s.id; }
             // Fast ID -> Symbol lookup table (id 0 means invalid)
-            std::vector<sourcetrail::SourcetrailDBReader::Symbol> symbolById(maxId + 1);
+            std::vector<sourcetrail::SourcetrailDBReader::SymbolView> symbolById(maxId + 1);
             for (const auto& s : allSymbols) {
                 if (s.id >= 0 && s.id <= maxId) symbolById[s.id] = s;
             }
-            auto getSymById = [&](int id) -> const sourcetrail::SourcetrailDBReader::Symbol* {
+            auto getSymById = [&](int id) -> const sourcetrail::SourcetrailDBReader::SymbolView* {
                 if (id >= 0 && id <= maxId) {
                     const auto& s = symbolById[id];
                     if (s.id != 0) return &s;
@@ -275,13 +284,8 @@ int main(int argc, const char* argv[])
                 return nullptr;
             };
             // Build FQN string for each symbol and an index FQN -> ids
-            auto buildFqnFromSymbol = [](const sourcetrail::SourcetrailDBReader::Symbol& s) {
-                std::string fqn;
-                for (size_t i=0;i<s.nameHierarchy.nameElements.size();++i) {
-                    if (i) fqn += s.nameHierarchy.nameDelimiter;
-                    fqn += s.nameHierarchy.nameElements[i].name;
-                }
-                return fqn;
+            auto buildFqnFromSymbol = [](const sourcetrail::SourcetrailDBReader::SymbolView& s) {
+                return s.name.getQualifiedName();
             };
             std::vector<std::string> fqnById(maxId + 1);
             std::unordered_map<std::string, std::vector<int>> fqnToIds;
@@ -324,12 +328,14 @@ int main(int argc, const char* argv[])
             queue.reserve(1024);
             for (auto& s : startSymbols) { queue.push_back({s.id,0,-1}); visited.insert(s.id); }
 
-            auto inNamespace = [&testNamespace](const sourcetrail::SourcetrailDBReader::Symbol& sym) -> bool {
+            auto inNamespace = [&testNamespace](const sourcetrail::SourcetrailDBReader::SymbolView& sym) -> bool {
                 // Check if symbol is within the test namespace (but not the namespace itself)
                 // Look for testNamespace as a parent element, not the final element
-                if (sym.nameHierarchy.nameElements.size() > 1) {
-                    for (size_t i = 0; i < sym.nameHierarchy.nameElements.size() - 1; ++i) {
-                        if (sym.nameHierarchy.nameElements[i].name == testNamespace) {
+                const size_t elementCount = sym.name.getNameElementCount();
+                if (elementCount > 1) {
+                    for (size_t i = 0; i < elementCount - 1; ++i) {
+                        const sourcetrail::NameHierarchyView::StringRef name = sym.name.getNameElement(i).name;
+                        if (testNamespace.compare(0, std::string::npos, name.data, name.size) == 0) {
                             return true;
                         }
                     }
@@ -349,27 +355,24 @@ int main(int argc, const char* argv[])
                 QueueItem item = queue[head++];
                 const auto* sym = getSymById(item.symbolId);
                 if (!sym) continue;
-                // Build FQN for logging
-                std::string fqnSym;
-                for (size_t i=0;i<sym->nameHierarchy.nameElements.size();++i) {
-                    if (i) fqnSym += sym->nameHierarchy.nameDelimiter;
-                    fqnSym += sym->nameHierarchy.nameElements[i].name;
-                }
+                // FQN for logging
+                const std::string& fqnSym = fqnById[sym->id];
+                const size_t elementCount = sym->name.getNameElementCount();
                 // If in ignore set, prune expansion (do not enqueue its incoming references)
                 if (!ignoreSet.empty())
                 {
                     auto eachNameElementIgnored = [&]() -> bool {
-                        for (const auto& nameEle : sym->nameHierarchy.nameElements) {
-                            if (ignoreSet.count(nameEle.name)) return true;
+                        for (size_t i = 0; i < elementCount; ++i) {
+                            if (ignoreSet.count(getNameElementName(sym->name, i))) return true;
                         }
                         return false;
                     };
                     bool isIgnored = false;
                     if ((!fqnSym.empty() && eachNameElementIgnored()) || ignoreSet.count(fqnSym))
                         isIgnored = true;
-                    else if (!sym->nameHierarchy.nameElements.empty())
+                    else if (elementCount)
                     {
-                        const std::string &simple = sym->nameHierarchy.nameElements.back().name;
+                        const std::string simple = getNameElementName(sym->name, elementCount - 1);
                         if (ignoreSet.count(simple)) isIgnored = true;
                     }
                     if (isIgnored)
@@ -449,25 +452,26 @@ int main(int argc, const char* argv[])
                         return false;
                     };
 
-                    if (!sym->nameHierarchy.nameElements.empty())
+                    if (elementCount)
                     {
-                        const std::string last = sym->nameHierarchy.nameElements.back().name;
+                        const std::string last = getNameElementName(sym->name, elementCount - 1);
                         // Direct class/struct detection
                         if ((sym->symbolKind == sourcetrail::SymbolKind::CLASS || sym->symbolKind == sourcetrail::SymbolKind::STRUCT) && isTestClassName(last))
                         {
                             ensureAddTestClass(sym->id, fqnSym);
                         }
                         // Method inside a test class: ascend to parent element
-                        else if (sym->symbolKind == sourcetrail::SymbolKind::METHOD && sym->nameHierarchy.nameElements.size() >= 2)
+                        else if (sym->symbolKind == sourcetrail::SymbolKind::METHOD && elementCount >= 2)
                         {
-                            const std::string parentName = sym->nameHierarchy.nameElements[sym->nameHierarchy.nameElements.size()-2].name;
+                            const std::string parentName = getNameElementName(sym->name, elementCount - 2);
                             if (isTestClassName(parentName))
                             {
                                 // Build parent FQN
+                                const sourcetrail::NameHierarchyView::StringRef delimiter = sym->name.getNameDelimiter();
                                 std::string parentFqn;
-                                for (size_t i=0;i<sym->nameHierarchy.nameElements.size()-1;++i) {
-                                    if (i) parentFqn += sym->nameHierarchy.nameDelimiter;
-                                    parentFqn += sym->nameHierarchy.nameElements[i].name;
+                                for (size_t i=0;i<elementCount-1;++i) {
+                                    if (i) parentFqn.append(delimiter.data, delimiter.size);
+                                    parentFqn += getNameElementName(sym->name, i);
                                 }
                                 if(!hasFqn(parentFqn)) {
                                     auto it = fqnToIds.find(parentFqn);
@@ -511,10 +515,7 @@ int main(int argc, const char* argv[])
                     // Build FQN of source symbol (caller / user)
                     std::string srcFqn;
                     if (srcSym && srcSym->id) {
-                        for (size_t i = 0; i < srcSym->nameHierarchy.nameElements.size(); ++i) {
-                            if (i) srcFqn += srcSym->nameHierarchy.nameDelimiter;
-                            srcFqn += srcSym->nameHierarchy.nameElements[i].name;
-                        }
+                        srcFqn = fqnById[srcSym->id];
                     }
                     std::cout << "[findtests]     Incoming ref: "
                               << (srcFqn.empty() ? std::string("<anon:"+std::to_string(nextId)+">") : srcFqn)
@@ -2,6 +2,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <stack>
 #include <queue>
 #include <thread>
 #include <mutex>
@@ -10,8 +11,8 @@
 #include <algorithm>
 // removed: unordered_set/deque/condition_variable (no longer needed for simplified class discovery)
 
+#include "AsyncSourcetrailDBWriter.h"
 #include "SourcetrailDBReader.h"
-#include "SourcetrailDBWriter.h"
 
 // Contract
 // Inputs: <source_db> <target_db> <test_namespace>
@@ -189,14 +190,12 @@ int main(int argc, const char* argv[]) {
     testMethodIds.erase(std::unique(testMethodIds.begin(), testMethodIds.end()), testMethodIds.end());
     std::cout << "Found " << testClassIds.size() << " test classes and " << testMethodIds.size() << " unique test methods" << std::endl;
 
-    // Prepare a single writer and mutex; workers will flush per method in small batches.
-    sourcetrail::SourcetrailDBWriter writer;
+    // Workers hand their mappings to the async writer, which writes them in batched transactions on its own thread.
+    sourcetrail::AsyncSourcetrailDBWriter writer;
     if (!writer.open(targetDb)) {
         std::cerr << "Failed to open target db: " << writer.getLastError() << std::endl;
         return 1;
     }
-    writer.beginTransaction();
-    std::mutex writerMutex;
 
     // Progress metrics
     const size_t totalMethods = testMethodIds.size();
@@ -219,7 +218,7 @@ int main(int argc, const char* argv[]) {
             std::cout << "[progress] methods " << processed << "/" << totalMethods
                       << ", nodes visited " << visited
                       << ", pairs discovered ~" << discovered
-                      << ", pairs recorded " << recorded << std::endl;
+                      << ", pairs queued " << recorded << std::endl;
             std::this_thread::sleep_for(std::chrono::seconds(5));
         }
     });
@@ -260,12 +259,10 @@ int main(int argc, const char* argv[]) {
                             batch.emplace_back(tgt, testMethodId);
                             pairsDiscovered.fetch_add(1, std::memory_order_relaxed);
                             if (batch.size() >= 512) {
-                                std::lock_guard<std::mutex> lock(writerMutex);
                                 for (const auto& p : batch) {
-                                    if (writer.recordTestMapping(p.first, p.second)) {
-                                        pairsRecorded.fetch_add(1, std::memory_order_relaxed);
-                                    }
+                                    writer.recordTestMapping(p.first, p.second);
                                 }
+                                pairsRecorded.fetch_add(batch.size(), std::memory_order_relaxed);
                                 batch.clear();
                             }
                         }
@@ -274,12 +271,10 @@ int main(int argc, const char* argv[]) {
 
                 // Flush any remaining batch for this method
                 if (!batch.empty()) {
-                    std::lock_guard<std::mutex> lock(writerMutex);
                     for (const auto& p : batch) {
-                        if (writer.recordTestMapping(p.first, p.second)) {
-                            pairsRecorded.fetch_add(1, std::memory_order_relaxed);
-                        }
+                        writer.recordTestMapping(p.first, p.second);
                     }
+                    pairsRecorded.fetch_add(batch.size(), std::memory_order_relaxed);
                     batch.clear();
                 }
                 methodsProcessed.fetch_add(1, std::memory_order_relaxed);
@@ -291,8 +286,10 @@ int main(int argc, const char* argv[]) {
     stopProgress.store(true, std::memory_order_relaxed);
     progressThread.join();
 
-    writer.commitTransaction();
+    if (!writer.close()) {
+        std::cerr << "Failed to record test mappings: " << writer.getLastError() << std::endl;
+        return 1;
+    }
     std::cout << "Recorded " << pairsRecorded.load() << " test mappings" << std::endl;
-    writer.close();
     return 0;
 }
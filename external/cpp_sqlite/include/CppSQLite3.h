@@ -248,8 +248,11 @@ public:
 
     void bind(int nParam, const char* szValue);
     void bind(int nParam, const int nValue);
+    void bind(int nParam, const sqlite_int64 nValue);
     void bind(int nParam, const double dwValue);
     void bind(int nParam, const unsigned char* blobValue, int nLen);
+    // binds text of known length without copying it, szValue needs to stay valid until the parameter is rebound
+    void bindStatic(int nParam, const char* szValue, int nLen);
     void bindNull(int nParam);
 
 	int bindParameterIndex(const char* szParam);
@@ -303,6 +306,13 @@ public:
 
     void setBusyTimeout(int nMillisecs);
 
+    // copies the main database of this connection to the main database of dest with the online backup API,
+    // nPagesPerStep pages at a time (-1 for all). xProgress is called after every step with the remaining and total page count.
+    void backup(CppSQLite3DB& dest, int nPagesPerStep, void (*xProgress)(int nRemaining, int nTotal, void* pArg), void* pArg);
+
+    // number of rows inserted, updated or deleted since the connection has been opened
+    int totalChanges();
+
     static const char* SQLiteVersion() { return SQLITE_VERSION; }
     static const char* SQLiteHeaderVersion() { return SQLITE_VERSION; }
     static const char* SQLiteLibraryVersion() { return sqlite3_libversion(); }
@@ -1005,6 +1005,20 @@ void CppSQLite3Statement::bind(int nParam, const char* szValue)
 }
 
 
+void CppSQLite3Statement::bindStatic(int nParam, const char* szValue, int nLen)
+{
+	checkVM();
+	int nRes = sqlite3_bind_text(mpVM, nParam, szValue, nLen, SQLITE_STATIC);
+
+	if (nRes != SQLITE_OK)
+	{
+		throw CppSQLite3Exception(nRes,
+								"Error binding string param",
+								DONT_DELETE_MSG);
+	}
+}
+
+
 void CppSQLite3Statement::bind(int nParam, const int nValue)
 {
 	checkVM();
@@ -1019,6 +1033,20 @@ void CppSQLite3Statement::bind(int nParam, const int nValue)
 }
 
 
+void CppSQLite3Statement::bind(int nParam, const sqlite_int64 nValue)
+{
+	checkVM();
+	int nRes = sqlite3_bind_int64(mpVM, nParam, nValue);
+
+	if (nRes != SQLITE_OK)
+	{
+		throw CppSQLite3Exception(nRes,
+								"Error binding int64 param",
+								DONT_DELETE_MSG);
+	}
+}
+
+
 void CppSQLite3Statement::bind(int nParam, const double dValue)
 {
 	checkVM();
@@ -1354,6 +1382,48 @@ void CppSQLite3DB::setBusyTimeout(int nMillisecs)
 }
 
 
+void CppSQLite3DB::backup(CppSQLite3DB& dest, int nPagesPerStep, void (*xProgress)(int nRemaining, int nTotal, void* pArg), void* pArg)
+{
+	checkDB();
+	dest.checkDB();
+
+	sqlite3_backup* pBackup = sqlite3_backup_init(dest.mpDB, "main", mpDB, "main");
+	if (!pBackup)
+	{
+		throw CppSQLite3Exception(sqlite3_errcode(dest.mpDB), (char*)sqlite3_errmsg(dest.mpDB), DONT_DELETE_MSG);
+	}
+
+	int nRet;
+	do
+	{
+		nRet = sqlite3_backup_step(pBackup, nPagesPerStep);
+		if (xProgress && (nRet == SQLITE_OK || nRet == SQLITE_DONE))
+		{
+			xProgress(sqlite3_backup_remaining(pBackup), sqlite3_backup_pagecount(pBackup), pArg);
+		}
+		if (nRet == SQLITE_BUSY || nRet == SQLITE_LOCKED)
+		{
+			sqlite3_sleep(10);
+		}
+	}
+	while (nRet == SQLITE_OK || nRet == SQLITE_BUSY || nRet == SQLITE_LOCKED);
+
+	sqlite3_backup_finish(pBackup);
+
+	if (nRet != SQLITE_DONE)
+	{
+		throw CppSQLite3Exception(nRet, (char*)sqlite3_errstr(nRet), DONT_DELETE_MSG);
+	}
+}
+
+
+int CppSQLite3DB::totalChanges()
+{
+	checkDB();
+	return sqlite3_total_changes(mpDB);
+}
+
+
 void CppSQLite3DB::checkDB()
 {
 	if (!mpDB)